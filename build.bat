@@ -9,16 +9,32 @@ cd build
 
 REM Compiler settings
 set CC=g++
-set CFLAGS=-std=c++17 -O3 -march=native -Wall -I../include
-set LDFLAGS=
+set CFLAGS=-std=c++17 -O3 -march=native -Wall -DNDEBUG -I../include
+set LDFLAGS=-pthread
+
+REM Set INSTRUMENT=1 to build with hot-path search counters
+if "%INSTRUMENT%"=="1" set CFLAGS=%CFLAGS% -DENGINE_INSTRUMENTATION
 
 REM Source directories
 set BOARD_SRC=../src/board
 set ENGINE_SRC=../src/engine
+set CLI_SRC=../src/cli
+set SELFPLAY_SRC=../src/selfplay
+set UTILS_SRC=../src/utils
 
 REM Object files
 set OBJS=
 
+REM Compile utility sources
+echo Compiling utility sources...
+%CC% %CFLAGS% -c %UTILS_SRC%/mapped_file.cpp -o mapped_file.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! mapped_file.o
+
+%CC% %CFLAGS% -c %UTILS_SRC%/thread_pool.cpp -o thread_pool.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! thread_pool.o
+
 REM Compile board sources
 echo Compiling board sources...
 %CC% %CFLAGS% -c %BOARD_SRC%/sparse_board.cpp -o sparse_board.o
@@ -39,18 +55,94 @@ set OBJS=!OBJS! move_generator.o
 if errorlevel 1 goto :error
 set OBJS=!OBJS! evaluator.o
 
+%CC% %CFLAGS% -c %ENGINE_SRC%/eval_weights.cpp -o eval_weights.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! eval_weights.o
+
+%CC% %CFLAGS% -c %ENGINE_SRC%/eval_cache.cpp -o eval_cache.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! eval_cache.o
+
+%CC% %CFLAGS% -c %ENGINE_SRC%/nnue.cpp -o nnue.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! nnue.o
+
 %CC% %CFLAGS% -c %ENGINE_SRC%/threat_solver.cpp -o threat_solver.o
 if errorlevel 1 goto :error
 set OBJS=!OBJS! threat_solver.o
 
+%CC% %CFLAGS% -c %ENGINE_SRC%/solver_cache.cpp -o solver_cache.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! solver_cache.o
+
 %CC% %CFLAGS% -c %ENGINE_SRC%/transposition_table.cpp -o transposition_table.o
 if errorlevel 1 goto :error
 set OBJS=!OBJS! transposition_table.o
 
+%CC% %CFLAGS% -c %ENGINE_SRC%/tt_snapshot.cpp -o tt_snapshot.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! tt_snapshot.o
+
 %CC% %CFLAGS% -c %ENGINE_SRC%/search_engine.cpp -o search_engine.o
 if errorlevel 1 goto :error
 set OBJS=!OBJS! search_engine.o
 
+%CC% %CFLAGS% -c %ENGINE_SRC%/opening_book.cpp -o opening_book.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! opening_book.o
+
+REM Compile CLI sources
+echo Compiling CLI sources...
+%CC% %CFLAGS% -c %CLI_SRC%/game_session.cpp -o game_session.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! game_session.o
+
+%CC% %CFLAGS% -c %CLI_SRC%/request_handler.cpp -o request_handler.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! request_handler.o
+
+%CC% %CFLAGS% -c %CLI_SRC%/json_reader.cpp -o json_reader.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! json_reader.o
+
+%CC% %CFLAGS% -c %CLI_SRC%/binary_protocol.cpp -o binary_protocol.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! binary_protocol.o
+
+%CC% %CFLAGS% -c %CLI_SRC%/batch_runner.cpp -o batch_runner.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! batch_runner.o
+
+%CC% %CFLAGS% -c %CLI_SRC%/serve_loop.cpp -o serve_loop.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! serve_loop.o
+
+REM Compile self-play sources
+echo Compiling self-play sources...
+%CC% %CFLAGS% -c %SELFPLAY_SRC%/game_record.cpp -o game_record.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! game_record.o
+
+%CC% %CFLAGS% -c %SELFPLAY_SRC%/sprt.cpp -o sprt.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! sprt.o
+
+%CC% %CFLAGS% -c %SELFPLAY_SRC%/match.cpp -o match.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! match.o
+
+%CC% %CFLAGS% -c %SELFPLAY_SRC%/book_builder.cpp -o book_builder_lib.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! book_builder_lib.o
+
+%CC% %CFLAGS% -c %SELFPLAY_SRC%/texel_tuner.cpp -o texel_tuner.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! texel_tuner.o
+
+%CC% %CFLAGS% -c %SELFPLAY_SRC%/nnue_trainer.cpp -o nnue_trainer_lib.o
+if errorlevel 1 goto :error
+set OBJS=!OBJS! nnue_trainer_lib.o
+
 REM Link main executable
 echo Linking main executable...
 %CC% %CFLAGS% ../src/main.cpp %OBJS% %LDFLAGS% -o tictactoe_engine.exe
@@ -61,12 +153,36 @@ echo Linking web CLI executable...
 %CC% %CFLAGS% ../src/web_cli.cpp %OBJS% %LDFLAGS% -o web_cli.exe
 if errorlevel 1 goto :error
 
+REM Link self-play match runner
+echo Linking self-play match runner...
+%CC% %CFLAGS% ../src/selfplay_match.cpp %OBJS% %LDFLAGS% -o selfplay_match.exe
+if errorlevel 1 goto :error
+
+REM Link opening book builder
+echo Linking opening book builder...
+%CC% %CFLAGS% ../src/book_builder.cpp %OBJS% %LDFLAGS% -o book_builder.exe
+if errorlevel 1 goto :error
+
+REM Link evaluation weight tuner
+echo Linking evaluation weight tuner...
+%CC% %CFLAGS% ../src/eval_tuner.cpp %OBJS% %LDFLAGS% -o eval_tuner.exe
+if errorlevel 1 goto :error
+
+REM Link evaluation network trainer
+echo Linking evaluation network trainer...
+%CC% %CFLAGS% ../src/nnue_trainer.cpp %OBJS% %LDFLAGS% -o nnue_trainer.exe
+if errorlevel 1 goto :error
+
 cd ..
 echo.
 echo === Build successful! ===
 echo Executable is in build/ directory:
 echo   - tictactoe_engine.exe
 echo   - web_cli.exe
+echo   - selfplay_match.exe
+echo   - book_builder.exe
+echo   - eval_tuner.exe
+echo   - nnue_trainer.exe
 echo.
 echo To build tests, run: build_tests.bat
 goto :end
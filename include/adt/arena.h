@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace adt {
+
+// Bump allocator for search temporaries. Memory is only reclaimed by
+// rewinding to a Mark, so everything allocated after a Mark must be dead
+// by the time it is released. Blocks are kept across rewinds, so once a
+// search has warmed up it no longer touches the general-purpose heap.
+//
+// Containers pick up the arena bound to the current thread when they are
+// constructed (see Arena::Binding) and keep drawing from it for their
+// whole lifetime; with no arena bound they fall back to new/delete.
+class Arena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    explicit Arena(size_t blockSize = DEFAULT_BLOCK_SIZE) : blockSize_(blockSize) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t align) {
+        for (;;) {
+            if (block_ < blocks_.size()) {
+                Block& block = blocks_[block_];
+                uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+                size_t start = (base + offset_ + align - 1) / align * align - base;
+                if (start + bytes <= block.size) {
+                    offset_ = start + bytes;
+                    return block.data.get() + start;
+                }
+                if (block_ + 1 < blocks_.size() && blocks_[block_ + 1].size >= bytes + align) {
+                    block_++;
+                    offset_ = 0;
+                    continue;
+                }
+            }
+            size_t size = bytes + align > blockSize_ ? bytes + align : blockSize_;
+            size_t next = block_ < blocks_.size() ? block_ + 1 : blocks_.size();
+            blocks_.insert(blocks_.begin() + next, Block{std::unique_ptr<char[]>(new char[size]), size});
+            block_ = next;
+            offset_ = 0;
+        }
+    }
+
+    template <typename T>
+    T* allocateArray(int count) {
+        T* items = static_cast<T*>(allocate(sizeof(T) * static_cast<size_t>(count), alignof(T)));
+        for (int i = 0; i < count; ++i) new (items + i) T();
+        return items;
+    }
+
+    Mark mark() const { return Mark{block_, offset_}; }
+
+    void release(const Mark& mark) {
+        block_ = mark.block;
+        offset_ = mark.offset;
+    }
+
+    size_t reservedBytes() const {
+        size_t total = 0;
+        for (const auto& block : blocks_) total += block.size;
+        return total;
+    }
+
+    static Arena* current() { return current_; }
+    
+    // Arena owned by the calling thread, for work that runs on pool
+    // threads outside any engine's own arena.
+    static Arena& forThread() {
+        static thread_local Arena arena;
+        return arena;
+    }
+
+    // Makes an arena the current thread's allocation source for a scope.
+    // Everything allocated from it inside the scope is released on exit.
+    // Binding nullptr sends the scope's allocations to the heap instead.
+    class Binding {
+    public:
+        explicit Binding(Arena& arena) : Binding(&arena) {}
+        explicit Binding(Arena* arena)
+            : arena_(arena), previous_(current_), mark_(arena ? arena->mark() : Mark{0, 0}) {
+            current_ = arena;
+        }
+        ~Binding() {
+            if (arena_) arena_->release(mark_);
+            current_ = previous_;
+        }
+
+        Binding(const Binding&) = delete;
+        Binding& operator=(const Binding&) = delete;
+
+    private:
+        Arena* arena_;
+        Arena* previous_;
+        Mark mark_;
+    };
+
+    // Releases whatever the current arena hands out inside a scope, e.g.
+    // one search ply. A no-op when no arena is bound.
+    class Scope {
+    public:
+        Scope() : arena_(current_), mark_(arena_ ? arena_->mark() : Mark{0, 0}) {}
+        ~Scope() {
+            if (arena_) arena_->release(mark_);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Arena* arena_;
+        Mark mark_;
+    };
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_;
+    size_t blockSize_;
+    size_t block_ = 0;
+    size_t offset_ = 0;
+
+    static inline thread_local Arena* current_ = nullptr;
+};
+
+// std allocator over the arena current at construction; heap otherwise.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept : arena_(Arena::current()) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+    T* allocate(size_t count) {
+        if (arena_) return static_cast<T*>(arena_->allocate(sizeof(T) * count, alignof(T)));
+        return static_cast<T*>(::operator new(sizeof(T) * count));
+    }
+
+    void deallocate(T* items, size_t) noexcept {
+        if (!arena_) ::operator delete(items);
+    }
+
+    Arena* arena() const noexcept { return arena_; }
+
+    // Copies follow the arena of the scope they are made in, not the source.
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena_ == other.arena(); }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena_ != other.arena(); }
+
+private:
+    Arena* arena_;
+};
+
+} // namespace adt
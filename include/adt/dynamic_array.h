@@ -3,23 +3,37 @@
 #include <algorithm>
 #include <functional>
 #include <stdexcept>
+#include <type_traits>
+#include "adt/arena.h"
 
 namespace adt {
 
 template <typename T>
 class DynamicArray {
 private:
+    // Arena storage is never destroyed element by element, so only
+    // trivially destructible element types may live there.
+    Arena *arena  = std::is_trivially_destructible<T>::value ? Arena::current() : nullptr;
     T  *data      = nullptr;
     int capacity  = 0;
     int size      = 0;
 
+    T *allocate(int count) {
+        if (arena) return arena->allocateArray<T>(count);
+        return new T[count];
+    }
+
+    void release(T *items) {
+        if (!arena) delete[] items;
+    }
+
     void reallocate(int new_capacity) {
         if (new_capacity < size) new_capacity = size;
         if (new_capacity == capacity) return;
 
-        T *tmp = new T[new_capacity];
+        T *tmp = allocate(new_capacity);
         for (int i = 0; i < size; ++i) tmp[i] = std::move(data[i]);
-        delete[] data;
+        release(data);
         data     = tmp;
         capacity = new_capacity;
     }
@@ -29,33 +43,54 @@ private:
     }
 
 public:
-    DynamicArray() : data(new T[1]), capacity(1), size(0) {}
+    DynamicArray() : data(allocate(1)), capacity(1), size(0) {}
 
     explicit DynamicArray(int initial_size)
         : capacity(initial_size > 0 ? initial_size : 1),
           size(initial_size)
     {
-        data = new T[capacity];
+        data = allocate(capacity);
         std::fill_n(data, size, T());
     }
 
     DynamicArray(const DynamicArray &other)
-        : data(new T[other.capacity]), capacity(other.capacity), size(other.size)
+        : data(allocate(other.capacity)), capacity(other.capacity), size(other.size)
     {
         std::copy(other.data, other.data + size, data);
     }
 
     DynamicArray &operator=(const DynamicArray &other) {
         if (this == &other) return *this;
-        delete[] data;
+        release(data);
         capacity = other.capacity;
         size     = other.size;
-        data     = new T[capacity];
+        data     = allocate(capacity);
         std::copy(other.data, other.data + size, data);
         return *this;
     }
 
-    ~DynamicArray() { delete[] data; }
+    DynamicArray(DynamicArray &&other) noexcept
+        : arena(other.arena), data(other.data), capacity(other.capacity), size(other.size)
+    {
+        other.data     = nullptr;
+        other.capacity = 0;
+        other.size     = 0;
+    }
+
+    DynamicArray &operator=(DynamicArray &&other) {
+        if (this == &other) return *this;
+        if (arena != other.arena) return *this = static_cast<const DynamicArray &>(other);
+        release(data);
+        data     = other.data;
+        capacity = other.capacity;
+        size     = other.size;
+        other.data     = nullptr;
+        other.capacity = 0;
+        other.size     = 0;
+        return *this;
+    }
+
+    ~DynamicArray() { release(data); }
 
     void Reserve(int new_capacity) { if (new_capacity > capacity) reallocate(new_capacity); }
 
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <initializer_list>
+#include <utility>
 #include "adt/linked_list.h"
 #include "adt/dynamic_array.h"
 
@@ -53,6 +54,13 @@ public:
         }
         return *this;
     }
+    
+    ArraySequence(ArraySequence &&other) noexcept : arr(std::move(other.arr)) {}
+    
+    ArraySequence& operator=(ArraySequence &&other) {
+        arr = std::move(other.arr);
+        return *this;
+    }
 
     T GetFirst() const override {
         if (!arr.GetSize()) throw std::out_of_range("Sequence is empty");
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "adt/arena.h"
+
+// Bounds checks in SmallArraySequence are compiled out of release builds
+// (-DNDEBUG); debug and test builds keep the throwing checks.
+#ifdef NDEBUG
+#define ADT_CHECK_INDEX(cond) do { } while (0)
+#else
+#define ADT_CHECK_INDEX(cond) do { if (!(cond)) throw std::out_of_range("Index out of range"); } while (0)
+#endif
+
+namespace adt {
+
+// Array sequence that keeps up to N elements inline and only spills to the
+// current arena (or the heap) beyond that. Restricted to trivially copyable
+// elements so that moves and growth are plain memcpy.
+template <typename T, int N>
+class SmallArraySequence {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallArraySequence needs trivially copyable elements");
+    static_assert(N > 0, "Inline capacity must be positive");
+
+private:
+    alignas(T) unsigned char storage[N * sizeof(T)];
+    T     *data     = reinterpret_cast<T *>(storage);
+    int    size     = 0;
+    int    capacity = N;
+    Arena *arena    = Arena::current();
+
+    bool isInline() const { return data == reinterpret_cast<const T *>(storage); }
+
+    void release() {
+        if (!isInline() && !arena) ::operator delete(data);
+        data     = reinterpret_cast<T *>(storage);
+        capacity = N;
+    }
+
+    void grow(int new_capacity) {
+        if (new_capacity <= capacity) return;
+        T *tmp = arena ? static_cast<T *>(arena->allocate(sizeof(T) * new_capacity, alignof(T)))
+                       : static_cast<T *>(::operator new(sizeof(T) * new_capacity));
+        std::memcpy(static_cast<void *>(tmp), data, sizeof(T) * size);
+        int keep = size;
+        release();
+        data     = tmp;
+        size     = keep;
+        capacity = new_capacity;
+    }
+
+    void assign(const T *items, int count) {
+        size = 0;
+        grow(count);
+        std::memcpy(static_cast<void *>(data), items, sizeof(T) * count);
+        size = count;
+    }
+
+    void steal(SmallArraySequence &other) {
+        if (other.isInline()) {
+            std::memcpy(static_cast<void *>(data), other.data, sizeof(T) * other.size);
+        } else {
+            data     = other.data;
+            capacity = other.capacity;
+            arena    = other.arena;
+        }
+        size = other.size;
+        other.data     = reinterpret_cast<T *>(other.storage);
+        other.size     = 0;
+        other.capacity = N;
+    }
+
+public:
+    SmallArraySequence() = default;
+
+    SmallArraySequence(const SmallArraySequence &other) { assign(other.data, other.size); }
+
+    SmallArraySequence(SmallArraySequence &&other) noexcept { steal(other); }
+
+    SmallArraySequence &operator=(const SmallArraySequence &other) {
+        if (this != &other) assign(other.data, other.size);
+        return *this;
+    }
+
+    SmallArraySequence &operator=(SmallArraySequence &&other) {
+        if (this == &other) return *this;
+        if (other.isInline() || other.arena != arena) {
+            assign(other.data, other.size);
+            other.size = 0;
+            return *this;
+        }
+        release();
+        steal(other);
+        return *this;
+    }
+
+    ~SmallArraySequence() { release(); }
+
+    T Get(int i) const {
+        ADT_CHECK_INDEX(i >= 0 && i < size);
+        return data[i];
+    }
+    T GetFirst() const {
+        if (!size) throw std::out_of_range("Sequence is empty");
+        return data[0];
+    }
+    T GetLast() const {
+        if (!size) throw std::out_of_range("Sequence is empty");
+        return data[size - 1];
+    }
+    int GetLength() const { return size; }
+    int Size() const { return size; }
+    bool Empty() const { return size == 0; }
+    static constexpr int InlineCapacity() { return N; }
+
+    T &operator[](int i) {
+        ADT_CHECK_INDEX(i >= 0 && i < size);
+        return data[i];
+    }
+    const T &operator[](int i) const {
+        ADT_CHECK_INDEX(i >= 0 && i < size);
+        return data[i];
+    }
+
+    T &Back() {
+        if (!size) throw std::out_of_range("Sequence is empty");
+        return data[size - 1];
+    }
+    const T &Back() const {
+        if (!size) throw std::out_of_range("Sequence is empty");
+        return data[size - 1];
+    }
+
+    void AppendInPlace(const T &item) {
+        if (size == capacity) grow(capacity * 2);
+        data[size++] = item;
+    }
+
+    template <typename... Args>
+    T &Emplace(Args &&...args) {
+        if (size == capacity) grow(capacity * 2);
+        T *slot = new (data + size) T(std::forward<Args>(args)...);
+        ++size;
+        return *slot;
+    }
+
+    void Set(int i, const T &value) {
+        ADT_CHECK_INDEX(i >= 0 && i < size);
+        data[i] = value;
+    }
+
+    void PopBack() {
+        if (!size) throw std::out_of_range("Sequence is empty");
+        --size;
+    }
+
+    void RemoveAt(int index) {
+        ADT_CHECK_INDEX(index >= 0 && index < size);
+        std::memmove(static_cast<void *>(data + index), data + index + 1, sizeof(T) * (size - index - 1));
+        --size;
+    }
+
+    void Reserve(int new_capacity) { grow(new_capacity); }
+
+    void Resize(int new_size) {
+        if (new_size < 0) throw std::invalid_argument("Size cannot be negative");
+        if (new_size > capacity) grow(new_size > capacity * 2 ? new_size : capacity * 2);
+        for (int i = size; i < new_size; ++i) new (data + i) T();
+        size = new_size;
+    }
+
+    void Clear() { size = 0; }
+
+    // Same exchange order as ArraySequence::SortInPlace, so results match
+    // element for element, but the comparator is inlined.
+    template <typename Compare>
+    void SortInPlace(Compare comp) {
+        for (int i = 0; i < size; ++i)
+            for (int j = 0; j < size - i - 1; ++j)
+                if (!comp(data[j], data[j + 1])) std::swap(data[j], data[j + 1]);
+    }
+
+    void SortInPlace() { SortInPlace([](const T &a, const T &b) { return a < b; }); }
+
+    T *begin() { return data; }
+    T *end() { return data + size; }
+    const T *begin() const { return data; }
+    const T *end() const { return data + size; }
+};
+
+} // namespace adt
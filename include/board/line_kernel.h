@@ -0,0 +1,55 @@
+#pragma once
+
+#include <type_traits>
+#include "board/sparse_board.h"
+
+namespace tictactoe {
+
+// Stone-run scans specialised on the win length. LineKernel<N> bounds
+// every scan by the compile-time N, so the loops get a constant trip
+// count the compiler can unroll; LineKernel<0> is the generic version
+// that reads the length at runtime.
+template <int WinLength>
+struct LineKernel {
+    static constexpr bool GENERIC = WinLength == 0;
+    
+    static int length(int winLength) { return GENERIC ? winLength : WinLength; }
+    
+    // Counts up to length() stones of player from cursor on, stepping by
+    // dir, and leaves cursor on the first cell that was not counted.
+    static int run(const SparseBoard& board, Position& cursor, const Position& dir,
+                   Player player, int winLength) {
+        const int limit = length(winLength);
+        int count = 0;
+        while (count < limit && board.at(cursor.x, cursor.y) == player) {
+            cursor = cursor + dir;
+            count++;
+        }
+        return count;
+    }
+    
+    // Length of the line through (x, y) in both directions, counting
+    // (x, y) itself as one of player's stones.
+    static int line(const SparseBoard& board, int x, int y, const Position& dir, Player player,
+                    int winLength, Position& forward, Position& backward) {
+        forward = Position(x, y) + dir;
+        backward = Position(x, y) - dir;
+        return 1 + run(board, forward, dir, player, winLength) +
+            run(board, backward, Position(-dir.x, -dir.y), player, winLength);
+    }
+};
+
+// Calls f with std::integral_constant<int, N> for the win lengths that
+// have a specialised kernel and with N = 0 for every other length.
+template <typename F>
+decltype(auto) dispatchWinLength(int winLength, F&& f) {
+    switch (winLength) {
+        case 3: return f(std::integral_constant<int, 3>());
+        case 4: return f(std::integral_constant<int, 4>());
+        case 5: return f(std::integral_constant<int, 5>());
+        case 6: return f(std::integral_constant<int, 6>());
+        default: return f(std::integral_constant<int, 0>());
+    }
+}
+
+} // namespace tictactoe
@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <algorithm>
 #include "adt/sequence.h"
+#include "adt/arena.h"
 
 namespace tictactoe {
 
@@ -88,6 +89,9 @@ public:
     
     BoundingBox getBoundingBox() const { return bbox_; }
     
+    // In the order the stones were played. The hash map's own order
+    // depends on how large it once grew, which would make searches on the
+    // same position differ.
     adt::ArraySequence<Position> getOccupiedPositions() const;
     
     uint64_t getZobristHash() const { return zobrist_hash_; }
@@ -101,7 +105,8 @@ public:
     
 private:
     int win_length_;
-    std::unordered_map<Position, Player, PositionHash> cells_;
+    std::unordered_map<Position, Player, PositionHash, std::equal_to<Position>,
+                       adt::ArenaAllocator<std::pair<const Position, Player>>> cells_;
     BoundingBox bbox_;
     uint64_t zobrist_hash_;
     adt::ArraySequence<Move> move_history_;
@@ -111,6 +116,7 @@ private:
     void updateZobristHash(int x, int y, Player player);
     
     int countInDirection(int x, int y, const Position& dir, Player player) const;
+    template <int WinLength>
     bool checkWinInDirection(int x, int y, const Position& dir, Player player) const;
 };
 
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "cli/request_handler.h"
+#include "engine/config.h"
+#include <iostream>
+#include <string>
+
+namespace tictactoe {
+
+struct BatchOptions {
+    int threads = 1;
+    int timeMs = Config::DEFAULT_TIME_MS;
+    int winLength = Config::WIN_LENGTH;
+    bool ordered = true;
+    const OpeningBook* book = nullptr;
+    const TTSnapshot* ttSnapshot = nullptr;
+};
+
+// Each input line is either a web_cli JSON request (optionally carrying an
+// "id") or a compact move list: "[#id] [w=N] [t=MS] x,y x,y ..." with
+// players alternating from X. Output is one JSON line per input line.
+// Jobs run on the shared ThreadPool; options.threads caps how many are in
+// flight at once.
+Request compactToRequest(const std::string& line, const BatchOptions& options);
+
+int runBatch(std::istream& in, std::ostream& out, const BatchOptions& options);
+
+} // namespace tictactoe
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "cli/request_handler.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace tictactoe {
+namespace binary {
+
+// Frames are a little-endian u32 payload length followed by the payload.
+// Integers inside a payload are LEB128 varints, signed ones zigzag-encoded.
+// Move lists are sent as deltas from the previous move with the player
+// folded into the low bits of dx, so a typical ply costs two bytes.
+// Session fields (game id, base ply, base hash) trail the request and may
+// be omitted entirely.
+constexpr uint8_t PROTOCOL_VERSION = 1;
+constexpr uint32_t MAX_FRAME_SIZE = 16 * 1024 * 1024;
+
+enum class Command : uint8_t {
+    MAKE_MOVE = 1,
+    AI_MOVE = 2,
+    GET_STATE = 3
+};
+
+enum ResponseFlags : uint8_t {
+    HAS_MOVE = 1,
+    HAS_STATS = 2,
+    GAME_OVER = 4,
+    IS_TERMINAL = 8,
+    HAS_POSITION = 16
+};
+
+enum ResponseStatus : uint8_t {
+    STATUS_OK = 0,
+    STATUS_ERROR = 1,
+    STATUS_RESYNC = 2
+};
+
+void writeVarint(std::string& out, uint64_t value);
+void writeSignedVarint(std::string& out, int64_t value);
+void writeFixed64(std::string& out, uint64_t value);
+
+class Decoder {
+public:
+    explicit Decoder(const std::string& payload);
+    
+    uint8_t readByte();
+    uint64_t readVarint();
+    int64_t readSignedVarint();
+    uint64_t readFixed64();
+    int readInt();
+    std::string readBytes();
+    bool atEnd() const { return pos_ >= size_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+void encodeRequest(const Request& request, std::string& out);
+Request decodeRequest(const std::string& payload);
+
+void encodeResponse(const Response& response, std::string& out);
+
+bool readFrame(std::istream& in, std::string& payload);
+void writeFrame(std::ostream& out, const std::string& payload);
+
+} // namespace binary
+} // namespace tictactoe
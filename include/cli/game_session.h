@@ -0,0 +1,59 @@
+#pragma once
+
+#include "board/sparse_board.h"
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tictactoe {
+
+// Board state of one game kept between requests, so a request only has to
+// carry the moves played since the ply the client last synced at.
+class GameSession {
+public:
+    explicit GameSession(int winLength);
+    
+    int getPly() const { return static_cast<int>(moves_.size()); }
+    uint64_t getHash() const { return hashes_.back(); }
+    uint64_t getHashAt(int ply) const { return hashes_[ply]; }
+    int getWinLength() const { return board_.getWinLength(); }
+    bool isTerminal() const { return winPly_ >= 0; }
+    
+    SparseBoard& getBoard() { return board_; }
+    
+    // Covers played stones only; the board's own box also grows with every
+    // cell the search has tried.
+    BoundingBox getBoundingBox() const { return bbox_; }
+    
+    bool play(int x, int y, Player player);
+    void rewind(int ply);
+
+private:
+    SparseBoard board_;
+    std::vector<SparseBoard::Move> moves_;
+    std::vector<uint64_t> hashes_;
+    BoundingBox bbox_;
+    int winPly_;
+};
+
+class SessionStore {
+public:
+    explicit SessionStore(size_t capacity = 1024);
+    
+    // Returns the session for gameId, starting a fresh one if it is unknown,
+    // was evicted, or was created with a different win length.
+    GameSession& acquire(const std::string& gameId, int winLength);
+    
+    size_t size() const { return sessions_.size(); }
+
+private:
+    using Entry = std::pair<std::string, GameSession>;
+    
+    size_t capacity_;
+    std::list<Entry> sessions_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+} // namespace tictactoe
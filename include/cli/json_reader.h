@@ -0,0 +1,40 @@
+#pragma once
+
+#include "cli/request_handler.h"
+#include <cstdint>
+#include <string>
+
+namespace tictactoe {
+
+// Single-pass tokenizer over a JSON document. Values are decoded in place
+// without building a DOM or copying substrings of the input.
+class JsonReader {
+public:
+    explicit JsonReader(const std::string& input);
+    
+    void skipWhitespace();
+    bool atEnd();
+    char peek();
+    void expect(char c);
+    bool consume(char c);
+    
+    std::string readString();
+    int64_t readInteger();
+    std::string readScalarText();
+    void skipValue();
+    
+    // Iterates object members: call after '{' (or ',') has been handled.
+    bool nextKey(std::string& key, bool& first);
+    bool nextElement(bool& first);
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t pos_;
+    
+    [[noreturn]] void fail(const std::string& what) const;
+};
+
+Request parseJsonRequest(const std::string& input);
+
+} // namespace tictactoe
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "board/sparse_board.h"
+#include "cli/game_session.h"
+#include "engine/search_engine.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+namespace tictactoe {
+
+class EngineCache {
+public:
+    explicit EngineCache(const OpeningBook* book = nullptr, const TTSnapshot* ttSnapshot = nullptr)
+        : book_(book), ttSnapshot_(ttSnapshot) {}
+    
+    SearchEngine& get(int winLength);
+
+private:
+    const OpeningBook* book_;
+    const TTSnapshot* ttSnapshot_;
+    std::unordered_map<int, std::unique_ptr<SearchEngine>> engines_;
+};
+
+struct Request {
+    std::string command;
+    std::string id;
+    int winLength = 0;
+    int timeMs = 0;
+    std::string currentPlayer;
+    std::vector<SparseBoard::Move> moves;
+    bool hasMove = false;
+    int moveX = 0;
+    int moveY = 0;
+    // Lines reported by the "analyze" command.
+    int multiPv = 1;
+    
+    // Session requests: moves are the delta played after basePly, and
+    // baseHash must match the hash the engine reported for that ply.
+    std::string gameId;
+    int basePly = 0;
+    uint64_t baseHash = 0;
+};
+
+struct Response {
+    bool success = false;
+    std::string error;
+    std::vector<SparseBoard::Move> cells;
+    BoundingBox bbox;
+    bool hasMove = false;
+    Move move;
+    Player movePlayer = Player::None;
+    bool hasStats = false;
+    SearchStats stats;
+    std::vector<AnalysisLine> analysis;
+    bool gameOver = false;
+    Player winner = Player::None;
+    bool isTerminal = false;
+    bool resync = false;
+    bool hasPosition = false;
+    int ply = 0;
+    uint64_t hash = 0;
+};
+
+std::string escapeJSON(const std::string& str);
+Player parsePlayer(const std::string& str);
+std::string playerToString(Player player);
+
+Response makeError(const std::string& error);
+// onInfo receives the progress of an "analyze" command while it runs.
+Response executeRequest(const Request& request, EngineCache& engines,
+                        const AnalysisCallback& onInfo = nullptr);
+Response executeRequest(const Request& request, EngineCache& engines, SessionStore& sessions,
+                        const AnalysisCallback& onInfo = nullptr);
+
+std::string formatHash(uint64_t hash);
+uint64_t parseHash(const std::string& text);
+
+void writeJsonResponse(const Response& response, std::string& out);
+// One-line object for a streamed analysis progress report.
+void writeJsonInfo(const AnalysisInfo& info, std::string& out);
+std::string compactJSON(const std::string& json);
+
+// Writes the response to out; an "analyze" request first writes one
+// {"info": {...}} line per completed depth.
+int handleRequest(const std::string& input, std::ostream& out, EngineCache& engines);
+
+} // namespace tictactoe
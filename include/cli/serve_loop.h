@@ -0,0 +1,18 @@
+#pragma once
+
+#include "engine/opening_book.h"
+#include "engine/tt_snapshot.h"
+#include <iostream>
+
+namespace tictactoe {
+
+// Long-lived worker mode: one JSON request per input line, one compact
+// response line {"id": ..., "result": {...}} per request, flushed at once.
+// Engines (and their transposition tables) persist between requests.
+// Requests carrying a "game_id" run against that game's GameSession.
+// {"command": "ping"} answers without touching the engines. An "analyze"
+// request streams {"id": ..., "info": {...}} lines before its result.
+int runServe(std::istream& in, std::ostream& out, const OpeningBook* book = nullptr,
+             const TTSnapshot* ttSnapshot = nullptr);
+
+} // namespace tictactoe
@@ -8,12 +8,43 @@ namespace Config {
     inline int TOP_K_CANDIDATES = 30;
     inline int MAX_DEPTH = 12;
     inline int TT_SIZE_MB = 128;
+    inline int SOLVER_CACHE_MB = 4;
+    inline int EVAL_CACHE_MB = 4;
     inline int DEFAULT_TIME_MS = 5000;
     inline int THREAT_SOLVER_MAX_DEPTH = 4;
     inline int FORK_BONUS = 5000;
     inline int STABLE_ITERATIONS_THRESHOLD = 2;
     inline int STABLE_SCORE_THRESHOLD = 50;
+    // A best move that kept its place and took this share of an
+    // iteration's nodes ends the search once 1/EASY_MOVE_TIME_DIVISOR of
+    // the time is used.
+    inline int EASY_MOVE_NODE_PERCENT = 85;
+    inline int EASY_MOVE_TIME_DIVISOR = 16;
+    inline int PARALLEL_SCORING_MIN_CELLS = 48;
 }
 
+struct SearchOptions {
+    int maxDepth = Config::MAX_DEPTH;
+    int topKCandidates = Config::TOP_K_CANDIDATES;
+    int candidateRadius = Config::CANDIDATE_RADIUS;
+    int threatSolverMaxDepth = Config::THREAT_SOLVER_MAX_DEPTH;
+    bool useThreatSolver = true;
+    bool useQuiescence = true;
+    bool useLateMoveReductions = true;
+    bool parallelRootScoring = true;
+    bool parallelThreatSolver = true;
+    // Evaluate with the installed network for the win length, if any,
+    // instead of the pattern evaluator.
+    bool useNnue = true;
+    // Young Brothers Wait splitting: once the eldest move of a node with at
+    // least splitMinDepth plies left is searched, its siblings are shared
+    // with the thread pool. reproducibleSplits keeps the split bookkeeping
+    // but searches the siblings in order on one thread, so node counts
+    // repeat exactly from run to run.
+    bool parallelSearch = false;
+    int splitMinDepth = 3;
+    bool reproducibleSplits = false;
+};
+
 } // namespace tictactoe
 
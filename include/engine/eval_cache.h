@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "board/sparse_board.h"
+#include "engine/config.h"
+
+namespace tictactoe {
+
+// Static evaluations keyed by Zobrist hash. Each slot is one 64-bit word
+// holding a 31-bit key check and the score from X's side, so reads and
+// writes are single atomic operations and need no locking. Colliding
+// positions simply overwrite each other.
+class EvalCache {
+public:
+    explicit EvalCache(size_t sizeMB = Config::EVAL_CACHE_MB);
+    ~EvalCache();
+    
+    EvalCache(const EvalCache&) = delete;
+    EvalCache& operator=(const EvalCache&) = delete;
+    
+    // Scores are relative to player; the evaluation is symmetric, so one
+    // entry serves both sides.
+    bool probe(uint64_t hash, Player player, int& score) const;
+    void store(uint64_t hash, Player player, int score);
+    void clear();
+    
+    size_t getSize() const { return size_; }
+
+private:
+    static constexpr uint64_t VALID = 1ULL << 32;
+    static constexpr uint64_t KEY_MASK = ~((1ULL << 33) - 1);
+    
+    size_t size_;
+    std::atomic<uint64_t>* table_;
+};
+
+} // namespace tictactoe
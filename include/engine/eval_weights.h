@@ -0,0 +1,47 @@
+#pragma once
+
+#include "engine/config.h"
+#include <array>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace tictactoe {
+
+// Pattern weights of the evaluator for one win length. The defaults are
+// the hand-set 10^k * 4^(N-k) ladder; tuned sets come from a weights file
+// loaded at startup, and evaluators built afterwards pick them up.
+struct EvalWeights {
+    static constexpr int MAX_LENGTH = 20;
+    
+    int winLength = Config::WIN_LENGTH;
+    // Indexed by run length, 1 .. winLength - 1.
+    std::array<int, MAX_LENGTH> open{};
+    std::array<int, MAX_LENGTH> closed{};
+    // Share of the full weight a pattern with a gap keeps.
+    int brokenPercent = 50;
+    int forkBonus = Config::FORK_BONUS;
+    
+    static EvalWeights defaults(int winLength);
+    
+    // The installed set for winLength, or the defaults.
+    static EvalWeights forWinLength(int winLength);
+    static void install(const EvalWeights& weights);
+    static void clearInstalled();
+    
+    // Text format, one block per win length:
+    //   win_length 5
+    //   open 2048 5120 ...        (lengths 1 .. win_length - 1)
+    //   closed 1024 2560 ...
+    //   broken_percent 50
+    //   fork_bonus 5000
+    // Lines starting with '#' are comments.
+    static bool read(std::istream& in, std::vector<EvalWeights>& sets);
+    static void write(std::ostream& out, const std::vector<EvalWeights>& sets);
+    
+    // Reads a weights file and installs every set in it.
+    static bool load(const std::string& path);
+    static bool save(const std::string& path, const std::vector<EvalWeights>& sets);
+};
+
+} // namespace tictactoe
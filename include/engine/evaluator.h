@@ -2,8 +2,11 @@
 
 #include "board/sparse_board.h"
 #include "engine/config.h"
+#include "engine/eval_weights.h"
 #include "adt/sequence.h"
+#include "adt/small_array.h"
 #include <array>
+#include <vector>
 
 namespace tictactoe {
 
@@ -27,21 +30,36 @@ private:
     int score_;
 };
 
+// At most one pattern per direction.
+using PatternList = adt::SmallArraySequence<Pattern, 4>;
+
 class Evaluator {
 public:
     explicit Evaluator(int win_length);
+    explicit Evaluator(const EvalWeights& weights);
     
     int evaluatePosition(const SparseBoard& board, Player player);
     int evaluateMove(const SparseBoard& board, int x, int y, Player player);
-    adt::ArraySequence<Pattern> detectPatterns(const SparseBoard& board, int x, int y, Player player);
+    PatternList detectPatterns(const SparseBoard& board, int x, int y, Player player);
     int getPatternScore(int length, bool isOpen) const;
     void initPatternWeights(int N);
+    void setWeights(const EvalWeights& weights);
+    const EvalWeights& getWeights() const { return weights_; }
     int getWinLength() const { return win_length_; }
     
+    // evaluatePosition as a linear function of the pattern weights:
+    // features[k] multiplies open[k] and features[MAX_LENGTH + k] closed[k],
+    // up to the rounding of broken patterns.
+    void patternFeatures(const SparseBoard& board, Player player, std::vector<double>& features);
+    
+    // Line scans look at most this many cells past the cell they start
+    // from, so a stone further away along every line cannot change its
+    // patterns.
+    static constexpr int LINE_REACH = 21;
+
 private:
     int win_length_;
-    std::array<int, 20> open_pattern_scores_;
-    std::array<int, 20> closed_pattern_scores_;
+    EvalWeights weights_;
     
     static const Position directions_[4];
     
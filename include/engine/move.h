@@ -0,0 +1,156 @@
+#pragma once
+
+#include "adt/small_array.h"
+#include <cstdint>
+#include <stdexcept>
+
+namespace tictactoe {
+
+struct Move {
+    int x, y;
+    int score;
+    
+    Move(int x = 0, int y = 0, int score = 0) : x(x), y(y), score(score) {}
+    
+    bool operator<(const Move& other) const {
+        return score > other.score;
+    }
+    
+    bool operator==(const Move& other) const {
+        return x == other.x && y == other.y;
+    }
+};
+
+// A move in 32 bits: two 14-bit signed coordinates relative to some origin
+// plus 4 flag bits. The all-zero value is "no move"; a stored move always
+// has VALID set, so (0, 0) relative stays distinguishable from it.
+class PackedMove {
+public:
+    static constexpr int COORD_BITS = 14;
+    static constexpr int COORD_MIN = -(1 << (COORD_BITS - 1));
+    static constexpr int COORD_MAX = (1 << (COORD_BITS - 1)) - 1;
+    
+    enum Flags : uint32_t {
+        VALID = 1
+    };
+    
+    PackedMove() : bits_(0) {}
+    PackedMove(int dx, int dy, uint32_t flags = VALID)
+        : bits_((static_cast<uint32_t>(dx) & COORD_MASK) |
+                ((static_cast<uint32_t>(dy) & COORD_MASK) << COORD_BITS) |
+                (flags << (2 * COORD_BITS))) {}
+    
+    static bool fits(int dx, int dy) {
+        return dx >= COORD_MIN && dx <= COORD_MAX && dy >= COORD_MIN && dy <= COORD_MAX;
+    }
+    
+    int dx() const { return signExtend(bits_ & COORD_MASK); }
+    int dy() const { return signExtend((bits_ >> COORD_BITS) & COORD_MASK); }
+    uint32_t flags() const { return bits_ >> (2 * COORD_BITS); }
+    bool isNull() const { return bits_ == 0; }
+    uint32_t raw() const { return bits_; }
+    static PackedMove fromRaw(uint32_t bits) {
+        PackedMove move;
+        move.bits_ = bits;
+        return move;
+    }
+    
+    // Absolute-origin encoding for storage outside a MoveList; moves that
+    // do not fit come back as the null move.
+    static PackedMove fromMove(const Move& move) {
+        return fits(move.x, move.y) ? PackedMove(move.x, move.y) : PackedMove();
+    }
+    Move toMove(int originX = 0, int originY = 0) const {
+        return Move(originX + dx(), originY + dy());
+    }
+
+private:
+    static constexpr uint32_t COORD_MASK = (1u << COORD_BITS) - 1;
+    
+    static int signExtend(uint32_t value) {
+        return static_cast<int>(value ^ (1u << (COORD_BITS - 1))) - (1 << (COORD_BITS - 1));
+    }
+    
+    uint32_t bits_;
+};
+
+static_assert(sizeof(PackedMove) == 4, "PackedMove must stay 32 bits");
+
+// Candidate list in structure-of-arrays form: packed coordinates relative
+// to the first move appended, and scores in their own array. Get() hands
+// back absolute Moves; sorting only shuffles 8 bytes per element.
+class MoveList {
+public:
+    int GetLength() const { return moves_.GetLength(); }
+    bool Empty() const { return moves_.Empty(); }
+    
+    Move Get(int i) const {
+        PackedMove packed = moves_[i];
+        return Move(originX_ + packed.dx(), originY_ + packed.dy(), scores_[i]);
+    }
+    int getScore(int i) const { return scores_[i]; }
+    const int* scores() const { return scores_.begin(); }
+    
+    void AppendInPlace(const Move& move) {
+        if (moves_.Empty()) {
+            originX_ = move.x;
+            originY_ = move.y;
+        }
+        moves_.AppendInPlace(pack(move.x, move.y));
+        scores_.AppendInPlace(move.score);
+    }
+    
+    void Set(int i, const Move& move) {
+        moves_.Set(i, pack(move.x, move.y));
+        scores_.Set(i, move.score);
+    }
+    
+    void Resize(int size) {
+        moves_.Resize(size);
+        scores_.Resize(size);
+    }
+    
+    void Clear() {
+        moves_.Clear();
+        scores_.Clear();
+    }
+    
+    // Stable sort by descending score over [from, length).
+    void SortInPlace(int from = 0) {
+        PackedMove* moves = moves_.begin();
+        int* scores = scores_.begin();
+        for (int i = from + 1; i < GetLength(); ++i) {
+            int score = scores[i];
+            PackedMove move = moves[i];
+            int j = i;
+            for (; j > from && scores[j - 1] < score; --j) {
+                scores[j] = scores[j - 1];
+                moves[j] = moves[j - 1];
+            }
+            scores[j] = score;
+            moves[j] = move;
+        }
+    }
+    
+    void Swap(int a, int b) {
+        std::swap(moves_[a], moves_[b]);
+        std::swap(scores_[a], scores_[b]);
+    }
+
+private:
+    adt::SmallArraySequence<PackedMove, 32> moves_;
+    adt::SmallArraySequence<int, 32> scores_;
+    int originX_ = 0;
+    int originY_ = 0;
+    
+    PackedMove pack(int x, int y) const {
+        int dx = x - originX_;
+        int dy = y - originY_;
+        if (!PackedMove::fits(dx, dy)) {
+            throw std::out_of_range("Move too far from the candidate origin");
+        }
+        return PackedMove(dx, dy);
+    }
+};
+
+} // namespace tictactoe
@@ -3,46 +3,102 @@
 #include "board/sparse_board.h"
 #include "engine/evaluator.h"
 #include "engine/config.h"
+#include "engine/move.h"
 #include "adt/sequence.h"
+#include "adt/arena.h"
+#include "utils/thread_pool.h"
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace tictactoe {
 
-struct Move {
-    int x, y;
-    int score;
-    
-    Move(int x = 0, int y = 0, int score = 0) : x(x), y(y), score(score) {}
-    
-    bool operator<(const Move& other) const {
-        return score > other.score;
-    }
-    
-    bool operator==(const Move& other) const {
-        return x == other.x && y == other.y;
-    }
+// Tactical classes of a cell, strongest first. Fours and threes are runs
+// of win length - 1 and - 2 through the cell once it is played; the
+// blocking classes are the same runs of the opponent.
+enum class ThreatClass {
+    WIN,
+    BLOCK_WIN,
+    OPEN_FOUR,
+    FOUR,
+    BLOCK_THREE,
+    OPEN_THREE,
+    NONE
 };
 
+using PositionSet = std::unordered_set<Position, PositionHash, std::equal_to<Position>,
+                                       adt::ArenaAllocator<Position>>;
+
 class MoveGenerator {
 public:
     explicit MoveGenerator(int win_length);
     
-    adt::ArraySequence<Move> generateCandidates(const SparseBoard& board, Player player);
+    // With parallel set, large candidate sets are scored on the scoring
+    // pool; the result is identical to the serial path.
+    MoveList generateCandidates(const SparseBoard& board, Player player, bool parallel = false);
     int scoreMove(const SparseBoard& board, int x, int y, Player player);
-    void sortAndPrune(adt::ArraySequence<Move>& moves, int topK);
+    void sortAndPrune(MoveList& moves, int topK);
     std::optional<Move> checkImmediateWin(const SparseBoard& board, Player player);
     std::optional<Move> checkImmediateBlock(const SparseBoard& board, Player player);
     std::optional<Move> checkDangerousThreat(const SparseBoard& board, Player player);
     
+    // Only the cells that make or block fours and open threes, ordered by
+    // class. Each move's score encodes its class (see threatClass).
+    MoveList generateTactical(const SparseBoard& board, Player player);
+    ThreatClass classifyThreat(const SparseBoard& board, int x, int y, Player player);
+    static ThreatClass threatClass(const Move& move) {
+        return static_cast<ThreatClass>(static_cast<int>(ThreatClass::NONE) - move.score);
+    }
+    void setCandidateLimits(int topK, int radius);
+    void setScoringPool(ThreadPool* pool) { pool_ = pool; }
+    
 private:
     Evaluator evaluator_;
     int win_length_;
+    int top_k_;
+    int radius_;
+    ThreadPool* pool_;
+    
+    static constexpr int PARALLEL_SCORING_GRAIN = 16;
+    // Beyond this many stones changed since the last call, or this many
+    // cached cells, the score cache starts over.
+    static constexpr int SCORE_CACHE_MAX_CHANGES = 8;
+    static constexpr size_t SCORE_CACHE_MAX_CELLS = 1 << 14;
+    
+    // Candidate scores of the position last seen, per player. A placed or
+    // removed stone only invalidates the cells on its four lines within
+    // Evaluator::LINE_REACH, so most scores carry over from node to node.
+    // One thread uses the cache at a time; the others score directly.
+    struct CachedScores {
+        int score[2];
+        bool known[2];
+    };
+    std::mutex scoreCacheMutex_;
+    std::unordered_map<Position, CachedScores, PositionHash> scoreCache_;
+    std::vector<SparseBoard::Move> scoredHistory_;
     
     adt::ArraySequence<Position> generateRadiusCandidates(
         const SparseBoard& board, int radius);
     void addNeighbors(int x, int y, int radius, 
-                     std::unordered_set<Position, PositionHash>& candidates,
+                     PositionSet& candidates,
                      const SparseBoard& board);
+    // Bodies of the public checks, specialised per win length (0 is the
+    // generic one) and picked by dispatchWinLength.
+    template <int WinLength>
+    std::optional<Move> findImmediateWin(const SparseBoard& board, Player player) const;
+    template <int WinLength>
+    std::optional<Move> findDangerousThreat(const SparseBoard& board, Player player) const;
+    template <int WinLength>
+    ThreatClass findThreatClass(const SparseBoard& board, int x, int y, Player player) const;
+    template <int WinLength>
+    MoveList findTactical(const SparseBoard& board, Player player) const;
+    void scoreInParallel(const SparseBoard& board, const adt::ArraySequence<Position>& positions,
+                         Player player, std::vector<int>& scores, const std::vector<char>& known);
+    void syncScoreCache(const SparseBoard& board);
+    void invalidateLines(int x, int y);
+    bool lookupScore(const Position& pos, Player player, int& score) const;
+    void storeScore(const Position& pos, Player player, int score);
 };
 
 } // namespace tictactoe
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "board/sparse_board.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tictactoe {
+
+class NnueNetwork;
+
+// First-layer sums of a network for one position, seen from each player.
+// A stone touches one column per side, so makeMove/undoMove are mirrored
+// by add/remove instead of recomputing the layer for every evaluation.
+// Features are stones inside a WINDOW x WINDOW crop centred on the origin;
+// stones outside it are ignored.
+class NnueAccumulator {
+public:
+    static constexpr int HIDDEN = 64;
+    
+    void refresh(const NnueNetwork& network, const SparseBoard& board, int originX, int originY);
+    void add(const NnueNetwork& network, int x, int y, Player player);
+    void remove(const NnueNetwork& network, int x, int y, Player player);
+    
+    int getOriginX() const { return originX_; }
+    int getOriginY() const { return originY_; }
+    const int16_t* values(Player perspective) const { return values_[perspective == Player::X ? 0 : 1]; }
+
+private:
+    alignas(32) int16_t values_[2][HIDDEN];
+    int originX_ = 0;
+    int originY_ = 0;
+};
+
+// Quantized two-layer network: 2 * WINDOW^2 inputs (own and opponent stone
+// per cell) into HIDDEN clipped-ReLU units, shared by both perspectives,
+// then one output weight per unit applied to the difference of the two
+// sides' activations. That keeps the score antisymmetric like the pattern
+// evaluator, so it shares the evaluation cache and needs no tempo term.
+//
+// Activations are int16 in [0, QA] and output weights int16 scaled by QB;
+// the output is 1/SCORE_SCALE logits of the X-wins probability, in the
+// same integer units the search uses everywhere else.
+class NnueNetwork {
+public:
+    static constexpr int WINDOW = 15;
+    static constexpr int RADIUS = WINDOW / 2;
+    static constexpr int CELLS = WINDOW * WINDOW;
+    static constexpr int FEATURES = 2 * CELLS;
+    static constexpr int HIDDEN = NnueAccumulator::HIDDEN;
+    static constexpr int QA = 127;
+    static constexpr int QB = 64;
+    static constexpr int SCORE_SCALE = 1000;
+    // Float weight ranges that keep every int16 sum in range.
+    static constexpr float MAX_INPUT_WEIGHT = 1.0f;
+    static constexpr float MAX_OUTPUT_WEIGHT = 32767.0f / QB;
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    
+    explicit NnueNetwork(int winLength = 5);
+    
+    // Quantizes float weights laid out as inputWeights[feature * HIDDEN + unit],
+    // inputBias[unit] and outputWeights[unit].
+    static NnueNetwork fromFloat(int winLength, const std::vector<float>& inputWeights,
+                                 const std::vector<float>& inputBias,
+                                 const std::vector<float>& outputWeights);
+    
+    int getWinLength() const { return winLength_; }
+    
+    // Input feature of a stone at (dx, dy) from the window origin, or -1
+    // outside the window.
+    static int featureIndex(int dx, int dy, bool own) {
+        if (dx < -RADIUS || dx > RADIUS || dy < -RADIUS || dy > RADIUS) {
+            return -1;
+        }
+        int cell = (dy + RADIUS) * WINDOW + (dx + RADIUS);
+        return own ? cell : CELLS + cell;
+    }
+    
+    // Score of the accumulated position for player.
+    int evaluate(const NnueAccumulator& accumulator, Player player) const;
+    
+    bool read(const std::string& path);
+    bool write(const std::string& path) const;
+    
+    // The network installed for winLength, or null; search engines built
+    // afterwards evaluate with it.
+    static std::shared_ptr<const NnueNetwork> forWinLength(int winLength);
+    static void install(std::shared_ptr<const NnueNetwork> network);
+    static void clearInstalled();
+    // Reads a network file and installs it.
+    static bool load(const std::string& path);
+
+private:
+    friend class NnueAccumulator;
+    
+    int winLength_;
+    std::vector<int16_t> inputWeights_;
+    std::vector<int16_t> inputBias_;
+    std::vector<int16_t> outputWeights_;
+    
+    const int16_t* column(int feature) const { return &inputWeights_[static_cast<size_t>(feature) * HIDDEN]; }
+};
+
+} // namespace tictactoe
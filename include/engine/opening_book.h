@@ -0,0 +1,70 @@
+#pragma once
+
+#include "board/sparse_board.h"
+#include "engine/move_generator.h"
+#include "utils/mapped_file.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tictactoe {
+
+// Key shared by every translation, rotation and reflection of a position
+// (with the same side to move). Book moves are stored in the canonical
+// frame and mapped back onto the actual board on lookup.
+class CanonicalPosition {
+public:
+    CanonicalPosition(const SparseBoard& board, Player toMove);
+    
+    uint64_t getKey() const { return key_; }
+    Position toCanonical(int x, int y) const;
+    Position fromCanonical(int x, int y) const;
+
+private:
+    uint64_t key_;
+    int transform_;
+    int offsetX_;
+    int offsetY_;
+};
+
+struct BookEntry {
+    uint64_t key;
+    int32_t x;
+    int32_t y;
+    int32_t score;
+    uint32_t weight;
+};
+
+static_assert(sizeof(BookEntry) == 24, "BookEntry is stored verbatim on disk");
+
+// File layout (little-endian): 32-byte header followed by BookEntry records
+// sorted by key, so a lookup is a binary search straight over the mapping.
+class OpeningBook {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    
+    bool open(const std::string& path);
+    void close();
+    
+    bool isOpen() const { return entries_ != nullptr; }
+    int getWinLength() const { return winLength_; }
+    int getMaxPly() const { return maxPly_; }
+    size_t size() const { return count_; }
+    
+    // Highest-weight book move for the side to move, in board coordinates,
+    // with the stored score in Move::score.
+    std::optional<Move> probe(const SparseBoard& board, Player toMove) const;
+    
+    static bool write(const std::string& path, int winLength, int maxPly,
+                      std::vector<BookEntry> entries);
+
+private:
+    MappedFile file_;
+    const BookEntry* entries_ = nullptr;
+    size_t count_ = 0;
+    int winLength_ = 0;
+    int maxPly_ = 0;
+};
+
+} // namespace tictactoe
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <array>
+
+// Build with -DENGINE_INSTRUMENTATION to collect hot-path counters.
+// Without it every ENGINE_STAT(...) and PhaseTimer compiles to nothing.
+#ifdef ENGINE_INSTRUMENTATION
+#define ENGINE_STAT(expr) do { expr; } while (0)
+#else
+#define ENGINE_STAT(expr) do { } while (0)
+#endif
+
+namespace tictactoe {
+
+#ifdef ENGINE_INSTRUMENTATION
+
+struct SearchCounters {
+    static constexpr int CUTOFF_BUCKETS = 8;
+    
+    uint64_t tt_probes = 0;
+    uint64_t tt_hits = 0;
+    uint64_t tt_cutoffs = 0;
+    uint64_t tt_collisions = 0;
+    uint64_t quiescence_nodes = 0;
+    uint64_t lmr_researches = 0;
+    uint64_t threat_solver_nodes = 0;
+    uint64_t candidate_lists = 0;
+    uint64_t candidate_moves = 0;
+    uint64_t candidate_max = 0;
+    std::array<uint64_t, CUTOFF_BUCKETS> beta_cutoff_index{};
+    
+    uint64_t immediate_checks_us = 0;
+    uint64_t has_threats_us = 0;
+    uint64_t threat_solver_us = 0;
+    uint64_t negamax_us = 0;
+    
+    void recordCandidates(int count) {
+        candidate_lists++;
+        candidate_moves += count;
+        if (static_cast<uint64_t>(count) > candidate_max) {
+            candidate_max = count;
+        }
+    }
+    
+    void recordCutoff(int moveIndex) {
+        int bucket = moveIndex < CUTOFF_BUCKETS - 1 ? moveIndex : CUTOFF_BUCKETS - 1;
+        beta_cutoff_index[bucket]++;
+    }
+    
+    // Folds in the node counters of another search thread.
+    void merge(const SearchCounters& other) {
+        tt_probes += other.tt_probes;
+        tt_hits += other.tt_hits;
+        tt_cutoffs += other.tt_cutoffs;
+        tt_collisions += other.tt_collisions;
+        quiescence_nodes += other.quiescence_nodes;
+        lmr_researches += other.lmr_researches;
+        candidate_lists += other.candidate_lists;
+        candidate_moves += other.candidate_moves;
+        if (other.candidate_max > candidate_max) {
+            candidate_max = other.candidate_max;
+        }
+        for (int i = 0; i < CUTOFF_BUCKETS; ++i) {
+            beta_cutoff_index[i] += other.beta_cutoff_index[i];
+        }
+    }
+};
+
+class PhaseTimer {
+public:
+    explicit PhaseTimer(uint64_t& sinkUs)
+        : sink_(sinkUs), start_(std::chrono::steady_clock::now()) {}
+    
+    ~PhaseTimer() {
+        sink_ += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+    }
+    
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    uint64_t& sink_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define ENGINE_PHASE_CONCAT_(a, b) a##b
+#define ENGINE_PHASE_NAME_(line) ENGINE_PHASE_CONCAT_(phase_timer_, line)
+#define ENGINE_PHASE(sink) ::tictactoe::PhaseTimer ENGINE_PHASE_NAME_(__LINE__)(sink)
+
+#else
+
+#define ENGINE_PHASE(sink) do { } while (0)
+
+#endif
+
+} // namespace tictactoe
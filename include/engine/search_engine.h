@@ -3,14 +3,25 @@
 #include "board/sparse_board.h"
 #include "engine/move_generator.h"
 #include "engine/evaluator.h"
+#include "engine/eval_cache.h"
+#include "engine/nnue.h"
 #include "engine/threat_solver.h"
 #include "engine/transposition_table.h"
+#include "engine/opening_book.h"
 #include "utils/timer.h"
+#include "utils/thread_pool.h"
 #include "engine/config.h"
+#include "engine/search_counters.h"
 #include "adt/sequence.h"
+#include "adt/arena.h"
 #include <optional>
 #include <cstdint>
 #include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace tictactoe {
 
@@ -19,13 +30,15 @@ enum class DecisionType {
     IMMEDIATE_BLOCK,
     DANGEROUS_THREAT,
     THREAT_SOLVER,
-    NEGAMAX_SEARCH
+    NEGAMAX_SEARCH,
+    OPENING_BOOK
 };
 
 class SearchStats {
 public:
     SearchStats() : nodes_searched_(0), depth_reached_(0), time_ms_(0), pv_length_(0),
-                    decision_type_(DecisionType::NEGAMAX_SEARCH), final_score_(0) {
+                    decision_type_(DecisionType::NEGAMAX_SEARCH), final_score_(0),
+                    eval_cache_hits_(0), eval_cache_misses_(0) {
         for (int i = 0; i < 20; ++i) {
             principal_variation_[i] = Move(0, 0);
         }
@@ -37,15 +50,20 @@ public:
     DecisionType getDecisionType() const { return decision_type_; }
     int getFinalScore() const { return final_score_; }
     int getPvLength() const { return pv_length_; }
+    uint64_t getEvalCacheHits() const { return eval_cache_hits_; }
+    uint64_t getEvalCacheMisses() const { return eval_cache_misses_; }
     Move getPrincipalVariation(int index) const {
         if (index >= 0 && index < 20) {
             return principal_variation_[index];
         }
         return Move(0, 0);
     }
-    
+#ifdef ENGINE_INSTRUMENTATION
+    const SearchCounters& getCounters() const { return counters_; }
+#endif
+
     friend class SearchEngine;
-    
+
 private:
     int nodes_searched_;
     int depth_reached_;
@@ -54,34 +72,198 @@ private:
     int pv_length_;
     DecisionType decision_type_;
     int final_score_;
+    uint64_t eval_cache_hits_;
+    uint64_t eval_cache_misses_;
+#ifdef ENGINE_INSTRUMENTATION
+    SearchCounters counters_;
+#endif
+};
+
+// One root move of an analysis with its score and principal variation
+// (starting with the move itself) from the deepest completed iteration.
+struct AnalysisLine {
+    Move move;
+    int score = 0;
+    int depth = 0;
+    std::vector<Move> pv;
 };
 
+// Progress report sent after every completed iteration of an analysis.
+struct AnalysisInfo {
+    int depth = 0;
+    int nodes = 0;
+    int timeMs = 0;
+    int nodesPerSecond = 0;
+    // Best first.
+    std::vector<AnalysisLine> lines;
+};
+
+using AnalysisCallback = std::function<void(const AnalysisInfo&)>;
+
 class SearchEngine {
 public:
     explicit SearchEngine(int win_length = Config::WIN_LENGTH);
+    SearchEngine(int win_length, const SearchOptions& options);
     
     Move findBestMove(SparseBoard& board, Player player, int timeMs = Config::DEFAULT_TIME_MS);
+    // Searches the best multiPv root moves by iterative deepening: each
+    // iteration searches the root once per line, excluding the moves
+    // already picked. Book, immediate-threat and solver shortcuts are
+    // skipped. onInfo, if set, is called on the searching thread after
+    // every completed iteration; an iteration cut off by the time limit
+    // is discarded. Fewer lines come back when the move generator prunes
+    // the root to forced moves (a win or a single block).
+    std::vector<AnalysisLine> analyze(SparseBoard& board, Player player, int multiPv,
+                                      int timeMs = Config::DEFAULT_TIME_MS,
+                                      const AnalysisCallback& onInfo = nullptr);
     SearchStats getStats() const { return stats_; }
-    void clearTT() { tt_.clear(); }
+    // Also drops the threat solver's proofs, which otherwise carry over
+    // from move to move.
+    void clearTT() {
+        tt_.clear();
+        threatSolver_.clearCache();
+    }
+    const SearchOptions& getOptions() const { return options_; }
+    void setOpeningBook(const OpeningBook* book) { book_ = book; }
+    // Pool for root scoring, threat solving and split points; the shared
+    // pool by default.
+    void setThreadPool(ThreadPool* pool);
     
+    // Snapshots saved for a different win length are ignored.
+    void setTranspositionSnapshot(const TTSnapshot* snapshot);
+    size_t warmStartTT(const TTSnapshot& snapshot, int minDepth = 0);
+    void exportTT(int minDepth, std::vector<TTSnapshotEntry>& out) const { tt_.exportEntries(minDepth, out); }
+
 private:
     MoveGenerator moveGen_;
     Evaluator evaluator_;
     ThreatSolver threatSolver_;
     TranspositionTable tt_;
+    EvalCache evalCache_;
+    // Installed network for the win length, unless options disable it.
+    std::shared_ptr<const NnueNetwork> network_;
+    int networkOriginX_;
+    int networkOriginY_;
+    bool networkOriginSet_;
     Timer timer_;
     SearchStats stats_;
+    SearchOptions options_;
+    const OpeningBook* book_;
+    adt::Arena arena_;
     int win_length_;
-    bool timeout_;
+    std::atomic<bool> timeout_;
+    int timeLimitMs_;
+    
+    ThreadPool* pool_;
+    std::atomic<int> helperNodes_;
+    std::mutex helperMutex_;
+    
+    static constexpr int TIME_CHECK_INTERVAL = 1024;
+    // Longest principal variation kept, as in SearchStats.
+    static constexpr int MAX_PLY = 20;
+    
+    // Line of the last completed iteration, read by nodes that follow it.
+    Move previousPv_[MAX_PLY];
+    int previousPvLength_;
+    // Stones this close to the edge of the network's window move it.
+    static constexpr int NETWORK_WINDOW_MARGIN = 2;
+    
+    struct SplitPoint;
+    
+    // Triangular principal variation table: row p holds the best line found
+    // from the node at ply p in moves[p][p .. length[p]). A node clears its
+    // row on entry and rebuilds it from its child's row whenever its best
+    // move improves, so sibling subtrees never overwrite each other's lines.
+    struct PvTable {
+        Move moves[MAX_PLY][MAX_PLY];
+        int length[MAX_PLY];
+        
+        void clear(int ply) {
+            if (ply < MAX_PLY) length[ply] = ply;
+        }
+        void set(int ply, const Move& move) {
+            if (ply >= MAX_PLY) return;
+            moves[ply][ply] = move;
+            length[ply] = ply + 1;
+        }
+        // Row ply becomes move followed by row ply + 1 of child.
+        void update(int ply, const Move& move, const PvTable& child) {
+            if (ply >= MAX_PLY) return;
+            moves[ply][ply] = move;
+            int end = ply + 1;
+            if (end < MAX_PLY) {
+                for (; end < child.length[ply + 1]; ++end) {
+                    moves[ply][end] = child.moves[ply + 1][end];
+                }
+            }
+            length[ply] = end;
+        }
+    };
+    
+    // A root move and what the last completed iteration learned about it.
+    // The list is generated once per search and re-sorted between
+    // iterations instead of regenerated at every root.
+    struct RootMove {
+        Move move;
+        int score = 0;
+        // The move raised alpha, so its score is exact rather than a bound.
+        bool exact = false;
+        // Nodes searched below the move.
+        int nodes = 0;
+    };
+    
+    // Per-thread search state. Split-point helpers start their own and fold
+    // it into the engine when they finish.
+    struct SearchContext {
+        int nodes = 0;
+        uint64_t evalHits = 0;
+        uint64_t evalMisses = 0;
+        const SplitPoint* split = nullptr;
+        PvTable pv;
+        // Set while the next node searched lies on the previous iteration's
+        // principal variation, whose move there is then ordered first.
+        bool followPv = false;
+        // Follows the moves this context plays when a network is in use.
+        NnueAccumulator nnue;
+#ifdef ENGINE_INSTRUMENTATION
+        SearchCounters counters;
+#endif
+    };
+    
+    void startSearch(int timeMs);
+    void startRoot(SearchContext& root, const SparseBoard& board);
+    void finishSearch(const SearchContext& root);
+    bool checkTimeout(const SearchContext& ctx);
+    bool isStopped(const SearchContext& ctx) const;
     
-    int negamax(SparseBoard& board, int depth, int alpha, int beta, 
-                Player player, Move* pv, int pvIndex);
-    int quiescence(SparseBoard& board, int alpha, int beta, Player player, int depth = 0);
-    void orderMoves(adt::ArraySequence<Move>& moves, const std::optional<Move>& pvMove);
+    // The line of the search is left in ctx.pv row ply.
+    int negamax(SearchContext& ctx, SparseBoard& board, int depth, int alpha, int beta, 
+                Player player, int ply);
+    std::vector<RootMove> makeRootMoves(SparseBoard& board, Player player);
+    int searchRoot(SearchContext& ctx, SparseBoard& board, int depth, Player player,
+                   std::vector<RootMove>& rootMoves, const std::vector<Move>& excluded);
+    static void sortRootMoves(std::vector<RootMove>& rootMoves);
+    int searchMove(SearchContext& ctx, SparseBoard& board, const Move& move, int moveIndex,
+                   int depth, int alpha, int beta, Player player, int ply);
+    bool canSplit(int depth, int remaining) const;
+    void searchSiblings(SearchContext& ctx, SplitPoint& split, SparseBoard& board,
+                        const MoveList& moves, int depth, Player player, int ply);
+    void splitSiblings(SearchContext& ctx, SplitPoint& split, SparseBoard& board,
+                       const MoveList& moves, int depth, Player player, int ply);
+    // Makes line the principal variation the next iteration follows.
+    void setPreviousPv(const Move* line, int length);
+    void mergeHelper(const SearchContext& helper);
+    int quiescence(SearchContext& ctx, SparseBoard& board, int alpha, int beta, Player player,
+                   int depth = 0);
+    void orderMoves(MoveList& moves, const std::optional<Move>& pvMove);
     std::optional<Move> checkImmediateWin(SparseBoard& board, Player player);
     std::optional<Move> checkImmediateBlock(SparseBoard& board, Player player);
     std::optional<Move> checkDangerousThreat(SparseBoard& board, Player player);
-    int evaluateTerminal(const SparseBoard& board, Player player);
+    void makeMove(SearchContext& ctx, SparseBoard& board, const Move& move, Player player);
+    void undoMove(SearchContext& ctx, SparseBoard& board, const Move& move, Player player);
+    void placeNetworkWindow(const SparseBoard& board);
+    int evaluate(SearchContext& ctx, const SparseBoard& board, Player player);
+    int evaluateTerminal(SearchContext& ctx, const SparseBoard& board, Player player);
     bool hasThreats(const SparseBoard& board, Player player);
 };
 
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include "board/sparse_board.h"
+#include "engine/config.h"
+#include "engine/move.h"
+
+namespace tictactoe {
+
+enum class SolverResult : uint8_t {
+    UNKNOWN,
+    WIN,
+    NO_WIN
+};
+
+// Threat-space search results keyed by position and attacker. A win proven
+// with some depth left also holds with more depth, and a refutation holds
+// with less, so one entry answers probes on either side of its depth.
+// Slots are lockless like the transposition table's, so parallel solver
+// branches share it directly.
+class SolverCache {
+public:
+    explicit SolverCache(size_t sizeMB = Config::SOLVER_CACHE_MB);
+    ~SolverCache();
+    
+    SolverCache(const SolverCache&) = delete;
+    SolverCache& operator=(const SolverCache&) = delete;
+    
+    class ProbeResult {
+    public:
+        SolverResult getResult() const { return result_; }
+        // Remaining depth the stored answer was searched with.
+        int getRemaining() const { return remaining_; }
+        bool hasThreat() const { return hasThreat_; }
+        Move getThreat() const { return threat_; }
+        
+        friend class SolverCache;
+    
+    private:
+        SolverResult result_ = SolverResult::UNKNOWN;
+        int remaining_ = 0;
+        bool hasThreat_ = false;
+        Move threat_;
+    };
+    
+    ProbeResult probe(uint64_t hash, Player attacker, int remaining) const;
+    void store(uint64_t hash, Player attacker, int remaining, bool win,
+               const std::optional<Move>& threat = std::nullopt);
+    void clear();
+    
+    size_t getSize() const { return size_; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+    
+    // data: threat (PackedMove, bits 0-31), remaining depth (32-39),
+    // result (40-41), has-threat flag (42).
+    static constexpr int REMAINING_SHIFT = 32;
+    static constexpr int RESULT_SHIFT = 40;
+    static constexpr uint64_t HAS_THREAT = 1ULL << 42;
+    
+    size_t size_;
+    Slot* table_;
+    
+    static uint64_t slotKey(uint64_t hash, Player attacker) {
+        return attacker == Player::X ? hash : hash ^ 0x9e3779b97f4a7c15ULL;
+    }
+    
+    bool load(uint64_t key, uint64_t& data) const;
+};
+
+} // namespace tictactoe
@@ -3,7 +3,11 @@
 #include "board/sparse_board.h"
 #include "engine/move_generator.h"
 #include "engine/config.h"
+#include "engine/search_counters.h"
+#include "engine/solver_cache.h"
 #include "adt/sequence.h"
+#include "utils/thread_pool.h"
+#include <atomic>
 #include <optional>
 
 namespace tictactoe {
@@ -14,14 +18,60 @@ public:
     
     std::optional<Move> findForcedWin(SparseBoard& board, Player player, int maxDepth);
     
+    // With a pool that has workers, root threats and the attacker's
+    // choices near the root are tried in parallel. The move returned is
+    // the same one the serial search finds.
+    void setThreadPool(ThreadPool* pool) { pool_ = pool; }
+    
+    // Proofs and refutations are kept across calls, so the positions a
+    // game revisits move after move are answered from the cache.
+    void clearCache() { cache_.clear(); }
+    const SolverCache& getCache() const { return cache_; }
+
+#ifdef ENGINE_INSTRUMENTATION
+    uint64_t getNodesSearched() const { return nodes_searched_; }
+#endif
+    
 private:
+    // Attacker choices this close to the root are shared with the pool.
+    static constexpr int PARALLEL_DEPTH = 2;
+    
+    // Stop flag of one parallel branch, chained to the branch it runs in.
+    struct Abort {
+        const Abort* parent = nullptr;
+        std::atomic<bool> flag{false};
+        
+        bool isSet() const {
+            for (const Abort* abort = this; abort != nullptr; abort = abort->parent) {
+                if (abort->flag.load(std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+    
     MoveGenerator moveGen_;
     int win_length_;
+    ThreadPool* pool_;
+    SolverCache cache_;
+#ifdef ENGINE_INSTRUMENTATION
+    std::atomic<uint64_t> nodes_searched_{0};
+#endif
+
+    bool isParallel() const { return pool_ != nullptr && pool_->getThreadCount() > 0; }
+    static bool isAborted(const Abort* abort) { return abort != nullptr && abort->isSet(); }
     
-    adt::ArraySequence<Move> generateThreats(const SparseBoard& board, Player player);
-    adt::ArraySequence<Move> findDefensiveMoves(const SparseBoard& board, Player player);
-    bool searchForcedWin(SparseBoard& board, Player player, int depth, int maxDepth);
-    bool isDirectThreat(const SparseBoard& board, int x, int y, Player player);
+    MoveList generateThreats(const SparseBoard& board, Player player);
+    MoveList findDefensiveMoves(const SparseBoard& board, Player player);
+    bool searchForcedWin(SparseBoard& board, Player player, int depth, int maxDepth,
+                         const Abort* abort = nullptr);
+    bool threatWins(SparseBoard& board, Player player, const Move& threat, int depth,
+                    int maxDepth, const Abort* abort);
+    int firstWinningThreat(const SparseBoard& board, Player player, const MoveList& threats,
+                           int depth, int maxDepth, bool anyWin, const Abort* abort);
+    template <int WinLength>
+    bool isDirectThreat(const SparseBoard& board, int x, int y, Player player) const;
 };
 
 } // namespace tictactoe
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <optional>
+#include <vector>
 #include "board/sparse_board.h"
 #include "engine/config.h"
 #include "engine/move_generator.h"
+#include "engine/search_counters.h"
+#include "engine/tt_snapshot.h"
 
 namespace tictactoe {
 
@@ -17,15 +21,29 @@ enum class TTFlag {
     UPPER_BOUND
 };
 
+// 16 bytes, so four entries share a cache line. Only the low bits of the
+// search age are kept; the move is packed relative to the board origin.
+// pv marks an exact score, i.e. a node on a principal variation.
 struct TTEntry {
     uint64_t zobristKey;
+    PackedMove bestMove;
     int16_t score;
     int8_t depth;
-    int8_t flag;
-    Move bestMove;
-    uint32_t age;
+    uint8_t flag : 2;
+    uint8_t pv : 1;
+    uint8_t age : 5;
     
-    TTEntry() : zobristKey(0), score(0), depth(0), flag(0), bestMove(0, 0), age(0) {}
+    TTEntry() : zobristKey(0), bestMove(), score(0), depth(0), flag(0), pv(0), age(0) {}
+};
+
+static_assert(sizeof(TTEntry) == 16, "TTEntry should stay 16 bytes");
+
+// Lockless storage for one TTEntry, shared by parallel searches: the key
+// word holds zobristKey ^ data, so a slot torn by two concurrent writers
+// no longer matches either key and simply reads as a miss.
+struct TTSlot {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
 };
 
 class TranspositionTable {
@@ -40,35 +58,62 @@ public:
         bool isFound() const { return found_; }
         int getScore() const { return score_; }
         Move getBestMove() const { return bestMove_; }
-        
+#ifdef ENGINE_INSTRUMENTATION
+        bool isKeyMatch() const { return keyMatch_; }
+        bool isCollision() const { return collision_; }
+#endif
+
         friend class TranspositionTable;
-        
+    
     private:
         bool found_;
         int score_;
         Move bestMove_;
+#ifdef ENGINE_INSTRUMENTATION
+        bool keyMatch_ = false;
+        bool collision_ = false;
+#endif
     };
     
     ProbeResult probe(uint64_t key, int depth, int alpha, int beta);
     
+    // Exact entries from this or the previous search age are PV nodes the
+    // next iteration orders by; only another exact entry or a store for the
+    // same position replaces them.
     void store(uint64_t key, int score, int depth, TTFlag flag, Move bestMove);
     
     void clear();
     
     std::optional<Move> getPVMove(uint64_t key);
     
-    friend class SearchEngine;
+    // Probes that miss the live table fall back to the snapshot, which is
+    // never written to. The snapshot must outlive the table.
+    void setSnapshot(const TTSnapshot* snapshot) { snapshot_ = snapshot; }
+    
+    void exportEntries(int minDepth, std::vector<TTSnapshotEntry>& out) const;
+    size_t warmStart(const TTSnapshot& snapshot, int minDepth = 0);
     
+    friend class SearchEngine;
+
 private:
     size_t size_;
-    size_t entries_;
-    TTEntry* table_;
+    std::atomic<size_t> entries_;
+    TTSlot* table_;
     uint32_t age_;
+    const TTSnapshot* snapshot_;
     
     size_t index(uint64_t key) const {
         return key % size_;
     }
     
+    static constexpr uint32_t AGE_MASK = 31;
+    
+    static bool resolveBound(int score, int8_t flag, int alpha, int beta);
+    bool isProtected(const TTEntry& entry) const;
+    
+    TTEntry load(size_t idx) const;
+    void save(size_t idx, const TTEntry& entry);
+    
     void replaceEntry(size_t idx, uint64_t key, int score, int depth, 
                      TTFlag flag, Move bestMove);
     
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "utils/mapped_file.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tictactoe {
+
+struct TTSnapshotEntry {
+    uint64_t key;
+    int32_t moveX;
+    int32_t moveY;
+    int16_t score;
+    int8_t depth;
+    int8_t flag;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(TTSnapshotEntry) == 24, "TTSnapshotEntry is stored verbatim on disk");
+
+// Read-only transposition table saved by an earlier run. Entries are sorted
+// by key and looked up by binary search straight over the mapping, so a
+// snapshot can be shared by every engine and process on the machine.
+class TTSnapshot {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    
+    bool open(const std::string& path);
+    void close();
+    
+    bool isOpen() const { return entries_ != nullptr; }
+    int getWinLength() const { return winLength_; }
+    size_t size() const { return count_; }
+    const TTSnapshotEntry* begin() const { return entries_; }
+    const TTSnapshotEntry* end() const { return entries_ + count_; }
+    
+    const TTSnapshotEntry* find(uint64_t key) const;
+    
+    // Keeps the deepest entry per key.
+    static bool write(const std::string& path, int winLength,
+                      std::vector<TTSnapshotEntry> entries);
+
+private:
+    MappedFile file_;
+    const TTSnapshotEntry* entries_ = nullptr;
+    size_t count_ = 0;
+    int winLength_ = 0;
+};
+
+} // namespace tictactoe
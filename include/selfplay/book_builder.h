@@ -0,0 +1,35 @@
+#pragma once
+
+#include "engine/config.h"
+#include "engine/opening_book.h"
+#include "engine/tt_snapshot.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace tictactoe {
+
+struct BookBuildOptions {
+    int winLength = Config::WIN_LENGTH;
+    int games = 64;
+    int bookPlies = 8;
+    int openingPlies = 2;
+    int openingRadius = 2;
+    int timeMs = 10000;
+    int threads = 1;
+    uint64_t seed = 1;
+    int minWeight = 1;
+    int ttMinDepth = 4;
+    SearchOptions search;
+};
+
+// Plays the engine against itself from short random openings (game i keeps
+// i % (openingPlies + 1) of its opening stones) and records the move chosen
+// in every position up to bookPlies. Positions are merged by canonical key:
+// a position is searched once, and each visit adds weight to its move.
+// When ttEntries is given, every worker's transposition table entries of
+// at least ttMinDepth are appended to it once its games are done.
+std::vector<BookEntry> buildOpeningBook(const BookBuildOptions& options, std::ostream& log,
+                                        std::vector<TTSnapshotEntry>* ttEntries = nullptr);
+
+} // namespace tictactoe
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "board/sparse_board.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace tictactoe {
+
+enum class GameResult {
+    X_WINS,
+    O_WINS,
+    DRAW
+};
+
+std::string resultToString(GameResult result);
+
+struct GameRecord {
+    std::vector<std::pair<std::string, std::string>> tags;
+    std::vector<SparseBoard::Move> moves;
+    GameResult result = GameResult::DRAW;
+    
+    std::string getTag(const std::string& name) const;
+    void setTag(const std::string& name, const std::string& value);
+};
+
+// PGN-like text: "[Name \"value\"]" tag lines, a blank line, then movetext
+// "1. x,y x,y 2. x,y ..." terminated by the result token (1-0, 0-1, 1/2-1/2).
+void writeGameRecord(std::ostream& out, const GameRecord& record);
+bool readGameRecord(std::istream& in, GameRecord& record);
+
+} // namespace tictactoe
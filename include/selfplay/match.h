@@ -0,0 +1,72 @@
+#pragma once
+
+#include "board/sparse_board.h"
+#include "engine/search_engine.h"
+#include "engine/config.h"
+#include "selfplay/game_record.h"
+#include "selfplay/sprt.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace tictactoe {
+
+struct EngineSpec {
+    std::string name;
+    SearchOptions options;
+    int timeMs = Config::DEFAULT_TIME_MS;
+};
+
+// "time=200,depth=8,topk=20,radius=2,solver=1,solver_depth=4,qsearch=1,lmr=1"
+EngineSpec parseEngineSpec(const std::string& name, const std::string& text);
+std::string describeEngineSpec(const EngineSpec& spec);
+
+std::vector<std::vector<Position>> generateOpenings(int count, int plies, int radius,
+                                                    uint64_t seed);
+
+GameRecord playGame(SearchEngine& xEngine, int xTimeMs,
+                    SearchEngine& oEngine, int oTimeMs,
+                    const std::vector<Position>& opening,
+                    int winLength, int maxMoves);
+
+struct MatchOptions {
+    int winLength = Config::WIN_LENGTH;
+    int concurrency = 1;
+    int maxGames = 1000;
+    int maxMoves = 150;
+    int openingPlies = 4;
+    int openingRadius = 3;
+    uint64_t seed = 1;
+    double elo0 = 0.0;
+    double elo1 = 10.0;
+    double alpha = 0.05;
+    double beta = 0.05;
+};
+
+struct MatchSummary {
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+    double llr = 0.0;
+    double elo = 0.0;
+    SprtStatus status = SprtStatus::CONTINUE;
+};
+
+// Plays the candidate against the baseline on all worker threads. Every
+// opening is played twice with colours swapped; results are scored from the
+// candidate's point of view and the match stops once the SPRT decides.
+class MatchRunner {
+public:
+    MatchRunner(const EngineSpec& candidate, const EngineSpec& baseline,
+                const MatchOptions& options);
+    
+    MatchSummary run(std::ostream* records, std::ostream& log);
+
+private:
+    EngineSpec candidate_;
+    EngineSpec baseline_;
+    MatchOptions options_;
+};
+
+} // namespace tictactoe
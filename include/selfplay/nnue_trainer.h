@@ -0,0 +1,80 @@
+#pragma once
+
+#include "engine/config.h"
+#include "engine/nnue.h"
+#include "selfplay/game_record.h"
+#include "utils/thread_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace tictactoe {
+
+struct NnueTrainerOptions {
+    int winLength = Config::WIN_LENGTH;
+    int epochs = 30;
+    int batchSize = 256;
+    // Adam step size.
+    double learningRate = 0.002;
+    // Positions this early carry little signal about the result.
+    int skipPlies = 4;
+    // Adds the seven rotations and reflections of every position.
+    bool augment = true;
+    uint64_t seed = 1;
+    int grain = 64;
+};
+
+// Trains an NnueNetwork on self-play games. Every position becomes a
+// sample labelled with the game result, cropped around the centre of its
+// stones the way the engine places its window, and the float network is
+// fitted by Adam on the logistic loss of sigmoid(output). Minibatch
+// gradients are summed on the pool in fixed chunks and reduced in order,
+// so training does not depend on the thread count.
+class NnueTrainer {
+public:
+    NnueTrainer(const NnueTrainerOptions& options, ThreadPool& pool);
+    
+    // Replays a game and adds its positions; false if the game is for a
+    // different win length or contains an illegal move.
+    bool addGame(const GameRecord& record);
+    size_t sampleCount() const { return results_.size(); }
+    
+    // Mean logistic loss of the float network over all samples.
+    double loss() const;
+    double train(std::ostream& log);
+    
+    NnueNetwork network() const;
+
+private:
+    static constexpr int HIDDEN = NnueNetwork::HIDDEN;
+    static constexpr int FEATURES = NnueNetwork::FEATURES;
+    
+    struct Gradient {
+        std::vector<float> inputWeights;
+        std::vector<float> inputBias;
+        std::vector<float> outputWeights;
+        double loss = 0.0;
+    };
+    
+    NnueTrainerOptions options_;
+    ThreadPool& pool_;
+    
+    // Active features of sample i from X's point of view are
+    // features_[offsets_[i] .. offsets_[i + 1]).
+    std::vector<int16_t> features_;
+    std::vector<size_t> offsets_;
+    // 1 for an X win, 0 for an O win, 0.5 for a draw.
+    std::vector<float> results_;
+    
+    std::vector<float> inputWeights_;
+    std::vector<float> inputBias_;
+    std::vector<float> outputWeights_;
+    
+    void addPosition(const SparseBoard& board, float result);
+    // Accumulates loss and gradient of one sample into gradient.
+    void backward(size_t sample, Gradient& gradient) const;
+    double forward(size_t sample, float* hiddenX, float* hiddenO) const;
+};
+
+} // namespace tictactoe
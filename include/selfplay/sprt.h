@@ -0,0 +1,43 @@
+#pragma once
+
+namespace tictactoe {
+
+enum class SprtStatus {
+    CONTINUE,
+    ACCEPT_H1,
+    ACCEPT_H0
+};
+
+// Sequential probability ratio test on the logistic Elo difference between
+// the candidate and the baseline, using the trinomial (win/draw/loss)
+// normal approximation of the log-likelihood ratio.
+class Sprt {
+public:
+    Sprt(double elo0, double elo1, double alpha = 0.05, double beta = 0.05);
+    
+    void addResult(double score);
+    
+    SprtStatus getStatus() const;
+    double getLLR() const;
+    double getLowerBound() const { return lower_bound_; }
+    double getUpperBound() const { return upper_bound_; }
+    double getEloEstimate() const;
+    
+    int getWins() const { return wins_; }
+    int getDraws() const { return draws_; }
+    int getLosses() const { return losses_; }
+    int getGames() const { return wins_ + draws_ + losses_; }
+
+private:
+    double elo0_;
+    double elo1_;
+    double lower_bound_;
+    double upper_bound_;
+    int wins_;
+    int draws_;
+    int losses_;
+    
+    static double eloToScore(double elo);
+};
+
+} // namespace tictactoe
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "engine/config.h"
+#include "engine/eval_weights.h"
+#include "selfplay/game_record.h"
+#include "utils/thread_pool.h"
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+namespace tictactoe {
+
+struct TunerOptions {
+    int winLength = Config::WIN_LENGTH;
+    int iterations = 300;
+    double learningRate = 0.5;
+    // Positions this early carry little signal about the result.
+    int skipPlies = 4;
+    int grain = 256;
+};
+
+// Texel-style tuning of the pattern weights. Every position of the games
+// becomes a sample labelled with the game result; the evaluation is mapped
+// to a win probability by sigmoid(K * score) and the weights are fitted by
+// gradient descent on the logistic loss. The evaluation is linear in the
+// weights, so a sample is stored as its pattern feature vector. Weights
+// are kept positive by descending on their logarithms. Loss and gradient
+// are summed over positions on the pool in fixed chunks, so the result
+// does not depend on the thread count.
+class TexelTuner {
+public:
+    TexelTuner(const TunerOptions& options, ThreadPool& pool);
+    
+    // Replays a game and adds its positions; false if the game is for a
+    // different win length or contains an illegal move.
+    bool addGame(const GameRecord& record, const EvalWeights& weights);
+    size_t sampleCount() const { return results_.size(); }
+    
+    // Scale K minimising the loss for the given weights.
+    double fitScale(const EvalWeights& weights) const;
+    double loss(const EvalWeights& weights, double scale) const;
+    
+    EvalWeights tune(const EvalWeights& start, std::ostream& log) const;
+
+private:
+    static constexpr int FEATURES = 2 * EvalWeights::MAX_LENGTH;
+    // Keeps sums of pattern scores well inside int range.
+    static constexpr int MAX_WEIGHT = 10000000;
+    
+    TunerOptions options_;
+    ThreadPool& pool_;
+    // FEATURES values per sample, from X's point of view.
+    std::vector<double> features_;
+    // 1 for an X win, 0 for an O win, 0.5 for a draw.
+    std::vector<double> results_;
+    
+    double score(size_t sample, const double* weights) const;
+    double evaluate(const double* weights, double scale, std::vector<double>* gradient) const;
+};
+
+} // namespace tictactoe
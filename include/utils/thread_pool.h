@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tictactoe {
+
+enum class TaskPriority {
+    HIGH,
+    NORMAL,
+    LOW
+};
+
+// Shared cancellation flag. Copies observe the same state, so a token can
+// be handed to every task of a group and cancelled from anywhere.
+class CancellationToken {
+public:
+    CancellationToken() : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+    
+    void cancel() { cancelled_->store(true, std::memory_order_release); }
+    bool isCancelled() const { return cancelled_->load(std::memory_order_acquire); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+// Work-stealing thread pool. Each worker owns one deque per priority: it
+// pops its own tasks from the back and steals from the front of the others
+// when it runs dry, always draining higher priorities first. Idle workers
+// spin for a while before parking, so bursts of small tasks do not pay for
+// a wake-up each. Threads that wait on a TaskGroup keep running queued
+// tasks instead of blocking, so nested parallel sections cannot deadlock.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+    
+    struct Options {
+        int threads = defaultThreadCount();
+        // Polls of the queues before an idle worker parks on the condition
+        // variable; 0 parks immediately.
+        int spinIterations = 2000;
+        // Pins worker i to CPU firstCpu + i (modulo the hardware threads).
+        bool pinThreads = false;
+        int firstCpu = 0;
+    };
+    
+    explicit ThreadPool(int threads = defaultThreadCount());
+    explicit ThreadPool(const Options& options);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    int getThreadCount() const { return static_cast<int>(workers_.size()); }
+    
+    // Index of the calling thread among this pool's workers, -1 for any
+    // other thread.
+    int workerIndex() const { return currentPool_ == this ? currentWorker_ : -1; }
+    
+    void submit(Task task, TaskPriority priority = TaskPriority::NORMAL);
+    
+    // Runs one queued task on the calling thread, if there is any.
+    bool runOne();
+    
+    // Calls body(begin, end) over [0, count) in chunks of at most grain
+    // items and returns once all of them finished. The caller runs chunks
+    // too; the first exception thrown by a chunk is rethrown here.
+    void parallelFor(int count, int grain, const std::function<void(int, int)>& body,
+                     TaskPriority priority = TaskPriority::NORMAL);
+    
+    // Process-wide pool with one worker per spare hardware thread. Search,
+    // solver and batch work all go through it so they share one budget.
+    static ThreadPool& shared();
+    static int defaultThreadCount();
+
+    // Options for the shared pool; only effective before its first use.
+    static void configureShared(const Options& options) { sharedOptions() = options; }
+
+private:
+    static constexpr int PRIORITIES = 3;
+    
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks[PRIORITIES];
+        std::thread thread;
+    };
+    
+    Options options_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<int> queued_;
+    std::atomic<int> sleeping_;
+    std::atomic<unsigned> nextQueue_;
+    bool stopping_;
+    
+    static inline thread_local const ThreadPool* currentPool_ = nullptr;
+    static inline thread_local int currentWorker_ = -1;
+    
+    static Options& sharedOptions() {
+        static Options options;
+        return options;
+    }
+    
+    void start();
+    void workerLoop(int index);
+    void pinCurrentThread(int index) const;
+};
+
+// Structured fork/join over a pool: tasks started through run() are all
+// finished once wait() returns, and the destructor waits as well. Tasks
+// not yet started when the token is cancelled are skipped.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool, CancellationToken token = CancellationToken());
+    ~TaskGroup();
+    
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    
+    void run(std::function<void()> task, TaskPriority priority = TaskPriority::NORMAL);
+    
+    // Waits, helping with queued work, until at most maxPending tasks of
+    // the group are unfinished. Rethrows the first exception of any task.
+    void waitFor(int maxPending);
+    void wait() { waitFor(0); }
+    
+    void cancel() { token_.cancel(); }
+    bool isCancelled() const { return token_.isCancelled(); }
+    const CancellationToken& getToken() const { return token_; }
+    int pending() const { return state_->pending.load(std::memory_order_acquire); }
+
+private:
+    struct State {
+        std::atomic<int> pending{0};
+        std::mutex mutex;
+        std::exception_ptr error;
+    };
+    
+    ThreadPool& pool_;
+    CancellationToken token_;
+    std::shared_ptr<State> state_;
+};
+
+} // namespace tictactoe
@@ -1,5 +1,6 @@
 #include "board/sparse_board.h"
 #include "board/zobrist.h"
+#include "board/line_kernel.h"
 #include <algorithm>
 #include <cmath>
 
@@ -69,10 +70,13 @@ void SparseBoard::undoMove(int x, int y) {
         
         updateZobristHash(x, y, player);
         
-        if (!move_history_.Empty() && 
-            move_history_.Back().x == x && 
-            move_history_.Back().y == y) {
-            move_history_.PopBack();
+        // Usually the last move; the history keeps exactly the stones on
+        // the board either way.
+        for (int i = move_history_.GetLength() - 1; i >= 0; --i) {
+            if (move_history_.Get(i).x == x && move_history_.Get(i).y == y) {
+                move_history_.RemoveAt(i);
+                break;
+            }
         }
     }
 }
@@ -111,45 +115,26 @@ int SparseBoard::countInDirection(int x, int y, const Position& dir, Player play
     return count;
 }
 
+template <int WinLength>
 bool SparseBoard::checkWinInDirection(int x, int y, const Position& dir, Player player) const {
-    Position pos(x, y);
-    if (cells_.find(pos) == cells_.end() || cells_.at(pos) != player) {
-        return false;
-    }
-    
-    int count = 1;
-    
-    Position current = pos + dir;
-    int maxIterations = 20;
-    int iterations = 0;
-    while (iterations < maxIterations && 
-           cells_.find(current) != cells_.end() && 
-           cells_.at(current) == player) {
-        count++;
-        current = current + dir;
-        iterations++;
-    }
-    
-    current = pos - dir;
-    iterations = 0;
-    while (iterations < maxIterations && 
-           cells_.find(current) != cells_.end() && 
-           cells_.at(current) == player) {
-        count++;
-        current = current - dir;
-        iterations++;
-    }
-    
-    return count >= win_length_;
+    Position forward;
+    Position backward;
+    return LineKernel<WinLength>::line(*this, x, y, dir, player, win_length_, forward, backward) >=
+        win_length_;
 }
 
 bool SparseBoard::isWin(int x, int y, Player player) const {
-    for (int i = 0; i < 4; ++i) {
-        if (checkWinInDirection(x, y, directions_[i], player)) {
-            return true;
-        }
+    if (at(x, y) != player) {
+        return false;
     }
-    return false;
+    return dispatchWinLength(win_length_, [&](auto kernel) {
+        for (int i = 0; i < 4; ++i) {
+            if (checkWinInDirection<decltype(kernel)::value>(x, y, directions_[i], player)) {
+                return true;
+            }
+        }
+        return false;
+    });
 }
 
 bool SparseBoard::isTerminal() const {
@@ -168,9 +153,10 @@ void SparseBoard::updateZobristHash(int x, int y, Player player) {
 
 adt::ArraySequence<Position> SparseBoard::getOccupiedPositions() const {
     adt::ArraySequence<Position> positions;
-    positions.Reserve(cells_.size());
-    for (const auto& [pos, player] : cells_) {
-        positions.AppendInPlace(pos);
+    positions.Reserve(move_history_.GetLength());
+    for (int i = 0; i < move_history_.GetLength(); ++i) {
+        const auto& move = move_history_.Get(i);
+        positions.AppendInPlace(Position(move.x, move.y));
     }
     return positions;
 }
@@ -1,50 +1,30 @@
 #include "board/zobrist.h"
-#include <algorithm>
 
 namespace tictactoe {
 
-ZobristHasher::ZobristHasher() {
-    initialize();
+ZobristHasher::ZobristHasher() : seed_(0) {
 }
 
 void ZobristHasher::initialize(uint64_t seed) {
-    if (seed == 0) {
-        std::random_device rd;
-        seed = rd();
-        seed = (seed << 32) | rd();
-    }
-    rng_.seed(seed);
-    keys_.clear();
+    seed_ = seed;
 }
 
 uint64_t ZobristHasher::generateKey(int x, int y, Player player) const {
     int index = coordToIndex(x, y);
     int playerIndex = static_cast<int>(player);
     
-    uint64_t combined = (static_cast<uint64_t>(index) << 2) | playerIndex;
-    
-    std::mt19937_64 local_rng(combined);
-    return local_rng();
+    uint64_t z = ((static_cast<uint64_t>(index) << 2) | playerIndex) ^ seed_;
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
 }
 
-uint64_t ZobristHasher::getKey(int x, int y, Player player) {
+uint64_t ZobristHasher::getKey(int x, int y, Player player) const {
     if (player == Player::None) {
         return 0;
     }
-    
-    int index = coordToIndex(x, y);
-    int playerIndex = static_cast<int>(player);
-    
-    uint64_t baseKey = generateKey(x, y, player);
-    
-    uint64_t cacheKey = (static_cast<uint64_t>(index) << 2) | playerIndex;
-    auto it = keys_.find(cacheKey);
-    if (it != keys_.end()) {
-        return it->second;
-    }
-    
-    keys_[cacheKey] = baseKey;
-    return baseKey;
+    return generateKey(x, y, player);
 }
 
 } // namespace tictactoe
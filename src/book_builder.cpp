@@ -0,0 +1,86 @@
+#include "selfplay/book_builder.h"
+#include "engine/config.h"
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace tictactoe;
+
+void printUsage() {
+    std::cerr << "Usage: book_builder --out FILE [options]\n"
+              << "Options:\n"
+              << "  --win-length N      win condition (default " << Config::WIN_LENGTH << ")\n"
+              << "  --games N           self-play games to harvest (default 64)\n"
+              << "  --plies N           deepest ply stored in the book (default 8)\n"
+              << "  --opening-plies N   random stones that seed the games (default 2)\n"
+              << "  --opening-radius N  random stones are placed within this radius\n"
+              << "  --time-ms N         search time per book position (default 10000)\n"
+              << "  --threads N         games played in parallel (default: all cores)\n"
+              << "  --seed N            opening seed\n"
+              << "  --min-weight N      drop moves chosen fewer than N times\n"
+              << "  --tt-mb N           transposition table size per engine\n"
+              << "  --tt-out FILE       also save the engines' transposition tables\n"
+              << "  --tt-min-depth N    only save entries searched this deep (default 4)\n";
+}
+
+int main(int argc, char* argv[]) {
+    BookBuildOptions options;
+    options.threads = static_cast<int>(std::thread::hardware_concurrency());
+    std::string outPath;
+    std::string ttOutPath;
+    
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            std::string value = argv[++i];
+            
+            if (arg == "--out") outPath = value;
+            else if (arg == "--win-length") options.winLength = std::stoi(value);
+            else if (arg == "--games") options.games = std::stoi(value);
+            else if (arg == "--plies") options.bookPlies = std::stoi(value);
+            else if (arg == "--opening-plies") options.openingPlies = std::stoi(value);
+            else if (arg == "--opening-radius") options.openingRadius = std::stoi(value);
+            else if (arg == "--time-ms") options.timeMs = std::stoi(value);
+            else if (arg == "--threads") options.threads = std::stoi(value);
+            else if (arg == "--seed") options.seed = std::stoull(value);
+            else if (arg == "--min-weight") options.minWeight = std::stoi(value);
+            else if (arg == "--tt-mb") Config::TT_SIZE_MB = std::stoi(value);
+            else if (arg == "--tt-out") ttOutPath = value;
+            else if (arg == "--tt-min-depth") options.ttMinDepth = std::stoi(value);
+            else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid option: " << e.what() << "\n";
+        return 1;
+    }
+    
+    if (outPath.empty()) {
+        printUsage();
+        return 1;
+    }
+    
+    std::vector<TTSnapshotEntry> ttEntries;
+    auto entries = buildOpeningBook(options, std::cerr, ttOutPath.empty() ? nullptr : &ttEntries);
+    if (!OpeningBook::write(outPath, options.winLength, options.bookPlies, entries)) {
+        std::cerr << "Cannot write opening book: " << outPath << "\n";
+        return 1;
+    }
+    
+    std::cout << "Wrote " << entries.size() << " book moves to " << outPath << "\n";
+    
+    if (!ttOutPath.empty()) {
+        if (!TTSnapshot::write(ttOutPath, options.winLength, ttEntries)) {
+            std::cerr << "Cannot write transposition table snapshot: " << ttOutPath << "\n";
+            return 1;
+        }
+        std::cout << "Wrote transposition table snapshot to " << ttOutPath << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include "cli/batch_runner.h"
+#include "cli/request_handler.h"
+#include "cli/json_reader.h"
+#include "utils/thread_pool.h"
+#include <sstream>
+#include <mutex>
+#include <map>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+namespace tictactoe {
+
+namespace {
+
+struct BatchJob {
+    long index;
+    std::string id;
+    Request request;
+    std::string error;
+};
+
+std::string formatResult(const BatchJob& job, const std::string& response) {
+    std::string line = "{\"index\": " + std::to_string(job.index);
+    if (!job.id.empty()) {
+        line += ", \"id\": \"" + escapeJSON(job.id) + "\"";
+    }
+    line += ", \"result\": " + response + "}";
+    return line;
+}
+
+class BatchPipeline {
+public:
+    BatchPipeline(std::ostream& out, const BatchOptions& options, ThreadPool& pool)
+        : out_(out), options_(options), engines_(pool.getThreadCount() + 1),
+          pool_(pool), nextToWrite_(0), failures_(0) {}
+    
+    void run(const BatchJob& job) {
+        Response response;
+        if (!job.error.empty()) {
+            response = makeError(job.error);
+        } else {
+            try {
+                response = executeRequest(job.request, engines());
+            } catch (const std::exception& e) {
+                response = makeError(std::string("Exception: ") + e.what());
+            }
+        }
+        if (!response.success) {
+            failures_++;
+        }
+            
+        std::string json;
+        writeJsonResponse(response, json);
+        emit(job, compactJSON(json));
+    }
+    
+    int getFailures() const { return failures_; }
+
+private:
+    std::ostream& out_;
+    BatchOptions options_;
+    // One cache per pool worker plus one for the submitting thread, which
+    // runs jobs while it waits; each slot is only touched by its thread.
+    std::vector<std::unique_ptr<EngineCache>> engines_;
+    ThreadPool& pool_;
+    
+    std::mutex outputMutex_;
+    std::map<long, std::string> pending_;
+    long nextToWrite_;
+    std::atomic<int> failures_;
+    
+    EngineCache& engines() {
+        auto& slot = engines_[pool_.workerIndex() + 1];
+        if (!slot) {
+            slot = std::make_unique<EngineCache>(options_.book, options_.ttSnapshot);
+        }
+        return *slot;
+    }
+    
+    void emit(const BatchJob& job, const std::string& response) {
+        std::lock_guard<std::mutex> lock(outputMutex_);
+        if (!options_.ordered) {
+            out_ << formatResult(job, response) << "\n";
+            out_.flush();
+            return;
+        }
+        
+        pending_[job.index] = formatResult(job, response);
+        while (!pending_.empty() && pending_.begin()->first == nextToWrite_) {
+            out_ << pending_.begin()->second << "\n";
+            pending_.erase(pending_.begin());
+            nextToWrite_++;
+        }
+        out_.flush();
+    }
+};
+
+} // namespace
+
+Request compactToRequest(const std::string& line, const BatchOptions& options) {
+    std::istringstream iss(line);
+    std::string token;
+    Request request;
+    request.command = "ai_move";
+    request.winLength = options.winLength;
+    request.timeMs = options.timeMs;
+    Player player = Player::X;
+    
+    while (iss >> token) {
+        if (token[0] == '#') {
+            request.id = token.substr(1);
+        } else if (token.rfind("w=", 0) == 0) {
+            request.winLength = std::stoi(token.substr(2));
+        } else if (token.rfind("t=", 0) == 0) {
+            request.timeMs = std::stoi(token.substr(2));
+        } else {
+            size_t comma = token.find(',');
+            if (comma == std::string::npos) {
+                throw std::invalid_argument("Invalid move token: " + token);
+            }
+            int x = std::stoi(token.substr(0, comma));
+            int y = std::stoi(token.substr(comma + 1));
+            request.moves.push_back({x, y, player});
+            player = (player == Player::X) ? Player::O : Player::X;
+        }
+    }
+    
+    request.currentPlayer = playerToString(player);
+    return request;
+}
+
+int runBatch(std::istream& in, std::ostream& out, const BatchOptions& options) {
+    BatchOptions effective = options;
+    if (effective.threads < 1) {
+        effective.threads = 1;
+    }
+    
+    ThreadPool& pool = ThreadPool::shared();
+    BatchPipeline pipeline(out, effective, pool);
+    TaskGroup jobs(pool);
+    
+    long index = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos) continue;
+        
+        BatchJob job;
+        job.index = index++;
+        try {
+            if (line[start] == '{') {
+                job.request = parseJsonRequest(line);
+                if (job.request.timeMs <= 0) {
+                    job.request.timeMs = effective.timeMs;
+                }
+            } else {
+                job.request = compactToRequest(line, effective);
+            }
+            job.id = job.request.id;
+        } catch (const std::exception& e) {
+            job.error = line[start] == '{' ? std::string("Exception: ") + e.what() : e.what();
+        }
+        // At most `threads` jobs in flight; the reader helps run them
+        // rather than blocking, so this works even without pool workers.
+        jobs.waitFor(effective.threads - 1);
+        jobs.run([&pipeline, job = std::move(job)] { pipeline.run(job); });
+    }
+    
+    jobs.wait();
+    
+    return pipeline.getFailures() == 0 ? 0 : 1;
+}
+
+} // namespace tictactoe
@@ -0,0 +1,319 @@
+#include "cli/binary_protocol.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace tictactoe {
+namespace binary {
+
+namespace {
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+uint8_t playerCode(Player player) {
+    return static_cast<uint8_t>(player);
+}
+
+Player playerFromCode(uint64_t code) {
+    if (code > 2) {
+        throw std::runtime_error("Invalid player code: " + std::to_string(code));
+    }
+    return static_cast<Player>(code);
+}
+
+void writeBytes(std::string& out, const std::string& bytes) {
+    writeVarint(out, bytes.size());
+    out += bytes;
+}
+
+void writeMoves(std::string& out, const std::vector<SparseBoard::Move>& moves) {
+    writeVarint(out, moves.size());
+    int prevX = 0;
+    int prevY = 0;
+    for (const auto& move : moves) {
+        writeVarint(out, (zigzag(static_cast<int64_t>(move.x) - prevX) << 2) | playerCode(move.player));
+        writeSignedVarint(out, static_cast<int64_t>(move.y) - prevY);
+        prevX = move.x;
+        prevY = move.y;
+    }
+}
+
+void readMoves(Decoder& decoder, std::vector<SparseBoard::Move>& moves) {
+    uint64_t count = decoder.readVarint();
+    if (count > MAX_FRAME_SIZE) {
+        throw std::runtime_error("Move count out of range");
+    }
+    moves.reserve(static_cast<size_t>(count));
+    int64_t x = 0;
+    int64_t y = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t packed = decoder.readVarint();
+        x += unzigzag(packed >> 2);
+        y += decoder.readSignedVarint();
+        moves.push_back({static_cast<int>(x), static_cast<int>(y), playerFromCode(packed & 3)});
+    }
+}
+
+Command commandFromName(const std::string& name) {
+    if (name == "make_move") return Command::MAKE_MOVE;
+    if (name == "ai_move") return Command::AI_MOVE;
+    if (name == "get_state") return Command::GET_STATE;
+    throw std::invalid_argument("Unknown command: " + name);
+}
+
+std::string commandName(uint8_t code) {
+    switch (static_cast<Command>(code)) {
+        case Command::MAKE_MOVE:
+            return "make_move";
+        case Command::AI_MOVE:
+            return "ai_move";
+        case Command::GET_STATE:
+            return "get_state";
+    }
+    throw std::runtime_error("Unknown command code: " + std::to_string(code));
+}
+
+void writeStats(std::string& out, const SearchStats& stats) {
+    writeVarint(out, static_cast<uint64_t>(std::max(0, stats.getTimeMs())));
+    out += static_cast<char>(stats.getDecisionType());
+    writeVarint(out, static_cast<uint64_t>(std::max(0, stats.getDepthReached())));
+    writeVarint(out, static_cast<uint64_t>(std::max(0, stats.getNodesSearched())));
+    writeSignedVarint(out, stats.getFinalScore());
+    
+    std::vector<Move> pv;
+    for (int i = 0; i < stats.getPvLength(); ++i) {
+        Move pvMove = stats.getPrincipalVariation(i);
+        if (pvMove.x != 0 || pvMove.y != 0) {
+            pv.push_back(pvMove);
+        }
+    }
+    writeVarint(out, pv.size());
+    int prevX = 0;
+    int prevY = 0;
+    for (const auto& pvMove : pv) {
+        writeSignedVarint(out, static_cast<int64_t>(pvMove.x) - prevX);
+        writeSignedVarint(out, static_cast<int64_t>(pvMove.y) - prevY);
+        prevX = pvMove.x;
+        prevY = pvMove.y;
+    }
+}
+
+} // namespace
+
+void writeVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void writeSignedVarint(std::string& out, int64_t value) {
+    writeVarint(out, zigzag(value));
+}
+
+void writeFixed64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+Decoder::Decoder(const std::string& payload)
+    : data_(reinterpret_cast<const uint8_t*>(payload.data())), size_(payload.size()), pos_(0) {
+}
+
+uint8_t Decoder::readByte() {
+    if (pos_ >= size_) {
+        throw std::runtime_error("Truncated binary payload");
+    }
+    return data_[pos_++];
+}
+
+uint64_t Decoder::readVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = readByte();
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Varint too long");
+}
+
+int64_t Decoder::readSignedVarint() {
+    return unzigzag(readVarint());
+}
+
+uint64_t Decoder::readFixed64() {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(readByte()) << (8 * i);
+    }
+    return value;
+}
+
+int Decoder::readInt() {
+    int64_t value = readSignedVarint();
+    if (value < INT32_MIN || value > INT32_MAX) {
+        throw std::runtime_error("Integer out of range");
+    }
+    return static_cast<int>(value);
+}
+
+std::string Decoder::readBytes() {
+    uint64_t length = readVarint();
+    if (length > size_ - pos_) {
+        throw std::runtime_error("Truncated binary payload");
+    }
+    std::string bytes(reinterpret_cast<const char*>(data_ + pos_), static_cast<size_t>(length));
+    pos_ += static_cast<size_t>(length);
+    return bytes;
+}
+
+void encodeRequest(const Request& request, std::string& out) {
+    out += static_cast<char>(PROTOCOL_VERSION);
+    out += static_cast<char>(commandFromName(request.command));
+    writeVarint(out, static_cast<uint64_t>(std::max(0, request.winLength)));
+    out += static_cast<char>(playerCode(parsePlayer(request.currentPlayer)));
+    writeVarint(out, static_cast<uint64_t>(std::max(0, request.timeMs)));
+    writeMoves(out, request.moves);
+    
+    out += static_cast<char>(request.hasMove ? 1 : 0);
+    if (request.hasMove) {
+        writeSignedVarint(out, request.moveX);
+        writeSignedVarint(out, request.moveY);
+    }
+    writeBytes(out, request.id);
+    
+    if (!request.gameId.empty()) {
+        writeBytes(out, request.gameId);
+        writeVarint(out, static_cast<uint64_t>(std::max(0, request.basePly)));
+        writeFixed64(out, request.baseHash);
+    }
+}
+
+Request decodeRequest(const std::string& payload) {
+    Decoder decoder(payload);
+    uint8_t version = decoder.readByte();
+    if (version != PROTOCOL_VERSION) {
+        throw std::runtime_error("Unsupported protocol version: " + std::to_string(version));
+    }
+    
+    Request request;
+    request.command = commandName(decoder.readByte());
+    request.winLength = static_cast<int>(std::min<uint64_t>(decoder.readVarint(), INT32_MAX));
+    Player current = playerFromCode(decoder.readByte());
+    if (current != Player::None) {
+        request.currentPlayer = playerToString(current);
+    }
+    request.timeMs = static_cast<int>(std::min<uint64_t>(decoder.readVarint(), INT32_MAX));
+    readMoves(decoder, request.moves);
+    
+    request.hasMove = decoder.readByte() != 0;
+    if (request.hasMove) {
+        request.moveX = decoder.readInt();
+        request.moveY = decoder.readInt();
+    }
+    request.id = decoder.readBytes();
+    
+    if (!decoder.atEnd()) {
+        request.gameId = decoder.readBytes();
+        request.basePly = static_cast<int>(std::min<uint64_t>(decoder.readVarint(), INT32_MAX));
+        request.baseHash = decoder.readFixed64();
+    }
+    return request;
+}
+
+void encodeResponse(const Response& response, std::string& out) {
+    out += static_cast<char>(PROTOCOL_VERSION);
+    if (!response.success) {
+        out += static_cast<char>(response.resync ? STATUS_RESYNC : STATUS_ERROR);
+        writeBytes(out, response.error);
+        if (response.resync) {
+            writeVarint(out, static_cast<uint64_t>(response.ply));
+        }
+        return;
+    }
+    out += static_cast<char>(STATUS_OK);
+    
+    uint8_t flags = 0;
+    if (response.hasMove) flags |= HAS_MOVE;
+    if (response.hasStats) flags |= HAS_STATS;
+    if (response.gameOver) flags |= GAME_OVER;
+    if (response.isTerminal) flags |= IS_TERMINAL;
+    if (response.hasPosition) flags |= HAS_POSITION;
+    out += static_cast<char>(flags);
+    out += static_cast<char>(playerCode(response.gameOver ? response.winner : Player::None));
+    
+    if (response.hasMove) {
+        writeSignedVarint(out, response.move.x);
+        writeSignedVarint(out, response.move.y);
+        Player player = response.movePlayer != Player::None ? response.movePlayer : Player::X;
+        out += static_cast<char>(playerCode(player));
+    }
+    if (response.hasStats) {
+        writeStats(out, response.stats);
+    }
+    
+    writeSignedVarint(out, response.bbox.getMinX());
+    writeSignedVarint(out, response.bbox.getMaxX());
+    writeSignedVarint(out, response.bbox.getMinY());
+    writeSignedVarint(out, response.bbox.getMaxY());
+    
+    std::vector<SparseBoard::Move> cells = response.cells;
+    std::sort(cells.begin(), cells.end(), [](const SparseBoard::Move& a, const SparseBoard::Move& b) {
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+    });
+    writeMoves(out, cells);
+    
+    if (response.hasPosition) {
+        writeVarint(out, static_cast<uint64_t>(response.ply));
+        writeFixed64(out, response.hash);
+    }
+}
+
+bool readFrame(std::istream& in, std::string& payload) {
+    unsigned char header[4];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        if (in.gcount() == 0) {
+            return false;
+        }
+        throw std::runtime_error("Truncated frame header");
+    }
+    
+    uint32_t length = static_cast<uint32_t>(header[0]) |
+                      (static_cast<uint32_t>(header[1]) << 8) |
+                      (static_cast<uint32_t>(header[2]) << 16) |
+                      (static_cast<uint32_t>(header[3]) << 24);
+    if (length > MAX_FRAME_SIZE) {
+        throw std::runtime_error("Frame too large: " + std::to_string(length));
+    }
+    
+    payload.resize(length);
+    if (length > 0 && !in.read(&payload[0], length)) {
+        throw std::runtime_error("Truncated frame payload");
+    }
+    return true;
+}
+
+void writeFrame(std::ostream& out, const std::string& payload) {
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    char header[4] = {
+        static_cast<char>(length & 0xFF),
+        static_cast<char>((length >> 8) & 0xFF),
+        static_cast<char>((length >> 16) & 0xFF),
+        static_cast<char>((length >> 24) & 0xFF)
+    };
+    out.write(header, sizeof(header));
+    out.write(payload.data(), payload.size());
+}
+
+} // namespace binary
+} // namespace tictactoe
@@ -0,0 +1,69 @@
+#include "cli/game_session.h"
+
+namespace tictactoe {
+
+GameSession::GameSession(int winLength)
+    : board_(winLength), winPly_(-1) {
+    hashes_.push_back(board_.getZobristHash());
+}
+
+bool GameSession::play(int x, int y, Player player) {
+    if (!board_.makeMove(x, y, player)) {
+        return false;
+    }
+    moves_.push_back({x, y, player});
+    hashes_.push_back(board_.getZobristHash());
+    bbox_.expand(x, y);
+    if (winPly_ < 0 && board_.isWin(x, y, player)) {
+        winPly_ = getPly();
+    }
+    return true;
+}
+
+void GameSession::rewind(int ply) {
+    if (ply >= getPly()) {
+        return;
+    }
+    
+    while (getPly() > ply) {
+        const auto& move = moves_.back();
+        board_.undoMove(move.x, move.y);
+        moves_.pop_back();
+        hashes_.pop_back();
+    }
+    
+    if (winPly_ > ply) {
+        winPly_ = -1;
+    }
+    
+    bbox_ = BoundingBox();
+    for (const auto& move : moves_) {
+        bbox_.expand(move.x, move.y);
+    }
+}
+
+SessionStore::SessionStore(size_t capacity)
+    : capacity_(capacity > 0 ? capacity : 1) {
+}
+
+GameSession& SessionStore::acquire(const std::string& gameId, int winLength) {
+    auto it = index_.find(gameId);
+    if (it != index_.end()) {
+        sessions_.splice(sessions_.begin(), sessions_, it->second);
+        GameSession& session = it->second->second;
+        if (session.getWinLength() != winLength) {
+            session = GameSession(winLength);
+        }
+        return session;
+    }
+    
+    if (sessions_.size() >= capacity_) {
+        index_.erase(sessions_.back().first);
+        sessions_.pop_back();
+    }
+    sessions_.emplace_front(gameId, GameSession(winLength));
+    index_[gameId] = sessions_.begin();
+    return sessions_.front().second;
+}
+
+} // namespace tictactoe
@@ -0,0 +1,225 @@
+#include "cli/json_reader.h"
+#include <stdexcept>
+
+namespace tictactoe {
+
+JsonReader::JsonReader(const std::string& input)
+    : data_(input.data()), size_(input.size()), pos_(0) {
+}
+
+void JsonReader::fail(const std::string& what) const {
+    throw std::runtime_error("Malformed JSON at offset " + std::to_string(pos_) + ": " + what);
+}
+
+void JsonReader::skipWhitespace() {
+    while (pos_ < size_) {
+        char c = data_[pos_];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        pos_++;
+    }
+}
+
+bool JsonReader::atEnd() {
+    skipWhitespace();
+    return pos_ >= size_;
+}
+
+char JsonReader::peek() {
+    skipWhitespace();
+    if (pos_ >= size_) fail("unexpected end of input");
+    return data_[pos_];
+}
+
+void JsonReader::expect(char c) {
+    if (peek() != c) fail(std::string("expected '") + c + "'");
+    pos_++;
+}
+
+bool JsonReader::consume(char c) {
+    if (atEnd() || data_[pos_] != c) return false;
+    pos_++;
+    return true;
+}
+
+std::string JsonReader::readString() {
+    expect('"');
+    std::string result;
+    while (pos_ < size_) {
+        char c = data_[pos_++];
+        if (c == '"') return result;
+        if (c != '\\') {
+            result += c;
+            continue;
+        }
+        if (pos_ >= size_) break;
+        char escaped = data_[pos_++];
+        switch (escaped) {
+            case 'n': result += '\n'; break;
+            case 'r': result += '\r'; break;
+            case 't': result += '\t'; break;
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'u':
+                if (pos_ + 4 > size_) fail("truncated unicode escape");
+                result += '?';
+                pos_ += 4;
+                break;
+            default: result += escaped; break;
+        }
+    }
+    fail("unterminated string");
+}
+
+int64_t JsonReader::readInteger() {
+    skipWhitespace();
+    bool negative = false;
+    if (pos_ < size_ && (data_[pos_] == '-' || data_[pos_] == '+')) {
+        negative = data_[pos_] == '-';
+        pos_++;
+    }
+    
+    size_t start = pos_;
+    int64_t value = 0;
+    while (pos_ < size_ && data_[pos_] >= '0' && data_[pos_] <= '9') {
+        value = value * 10 + (data_[pos_] - '0');
+        pos_++;
+    }
+    if (pos_ == start) fail("expected a number");
+    
+    if (pos_ < size_ && data_[pos_] == '.') {
+        pos_++;
+        while (pos_ < size_ && data_[pos_] >= '0' && data_[pos_] <= '9') pos_++;
+    }
+    if (pos_ < size_ && (data_[pos_] == 'e' || data_[pos_] == 'E')) {
+        fail("exponents are not supported");
+    }
+    
+    return negative ? -value : value;
+}
+
+std::string JsonReader::readScalarText() {
+    char c = peek();
+    if (c == '"') return readString();
+    
+    size_t start = pos_;
+    while (pos_ < size_ && data_[pos_] != ',' && data_[pos_] != '}' &&
+           data_[pos_] != ']' && data_[pos_] != ' ' && data_[pos_] != '\n') {
+        pos_++;
+    }
+    return std::string(data_ + start, pos_ - start);
+}
+
+void JsonReader::skipValue() {
+    char c = peek();
+    if (c == '"') {
+        readString();
+    } else if (c == '{') {
+        pos_++;
+        std::string key;
+        bool first = true;
+        while (nextKey(key, first)) skipValue();
+    } else if (c == '[') {
+        pos_++;
+        bool first = true;
+        while (nextElement(first)) skipValue();
+    } else {
+        readScalarText();
+    }
+}
+
+bool JsonReader::nextKey(std::string& key, bool& first) {
+    if (consume('}')) return false;
+    if (!first) expect(',');
+    first = false;
+    key = readString();
+    expect(':');
+    return true;
+}
+
+bool JsonReader::nextElement(bool& first) {
+    if (consume(']')) return false;
+    if (!first) expect(',');
+    first = false;
+    return true;
+}
+
+namespace {
+
+void readMoves(JsonReader& reader, Request& request) {
+    reader.expect('[');
+    bool firstMove = true;
+    while (reader.nextElement(firstMove)) {
+        reader.expect('{');
+        SparseBoard::Move move{0, 0, Player::X};
+        bool hasX = false;
+        bool hasY = false;
+        std::string key;
+        bool firstKey = true;
+        while (reader.nextKey(key, firstKey)) {
+            if (key == "x") {
+                move.x = static_cast<int>(reader.readInteger());
+                hasX = true;
+            } else if (key == "y") {
+                move.y = static_cast<int>(reader.readInteger());
+                hasY = true;
+            } else if (key == "player") {
+                move.player = parsePlayer(reader.readString());
+            } else {
+                reader.skipValue();
+            }
+        }
+        if (hasX && hasY) {
+            request.moves.push_back(move);
+        }
+    }
+}
+
+} // namespace
+
+Request parseJsonRequest(const std::string& input) {
+    Request request;
+    JsonReader reader(input);
+    
+    reader.expect('{');
+    std::string key;
+    bool first = true;
+    bool hasX = false;
+    bool hasY = false;
+    while (reader.nextKey(key, first)) {
+        if (key == "command") {
+            request.command = reader.readString();
+        } else if (key == "id") {
+            request.id = reader.readScalarText();
+        } else if (key == "win_length") {
+            request.winLength = static_cast<int>(reader.readInteger());
+        } else if (key == "time_ms") {
+            request.timeMs = static_cast<int>(reader.readInteger());
+        } else if (key == "current_player") {
+            request.currentPlayer = reader.readScalarText();
+            if (request.currentPlayer == "null") request.currentPlayer.clear();
+        } else if (key == "moves") {
+            readMoves(reader, request);
+        } else if (key == "multi_pv") {
+            request.multiPv = static_cast<int>(reader.readInteger());
+        } else if (key == "game_id") {
+            request.gameId = reader.readScalarText();
+        } else if (key == "base_ply") {
+            request.basePly = static_cast<int>(reader.readInteger());
+        } else if (key == "base_hash") {
+            request.baseHash = parseHash(reader.readString());
+        } else if (key == "x") {
+            request.moveX = static_cast<int>(reader.readInteger());
+            hasX = true;
+        } else if (key == "y") {
+            request.moveY = static_cast<int>(reader.readInteger());
+            hasY = true;
+        } else {
+            reader.skipValue();
+        }
+    }
+    request.hasMove = hasX && hasY;
+    
+    return request;
+}
+
+} // namespace tictactoe
@@ -0,0 +1,520 @@
+#include "cli/request_handler.h"
+#include "cli/json_reader.h"
+#include "engine/config.h"
+#include <iostream>
+#include <charconv>
+#include <algorithm>
+#include <stdexcept>
+
+namespace tictactoe {
+
+SearchEngine& EngineCache::get(int winLength) {
+    auto it = engines_.find(winLength);
+    if (it == engines_.end()) {
+        it = engines_.emplace(winLength, std::make_unique<SearchEngine>(winLength)).first;
+        it->second->setOpeningBook(book_);
+        it->second->setTranspositionSnapshot(ttSnapshot_);
+    }
+    return *it->second;
+}
+
+std::string escapeJSON(const std::string& str) {
+    std::string result;
+    for (char c : str) {
+        if (c == '"') result += "\\\"";
+        else if (c == '\\') result += "\\\\";
+        else if (c == '\n') result += "\\n";
+        else if (c == '\r') result += "\\r";
+        else if (c == '\t') result += "\\t";
+        else result += c;
+    }
+    return result;
+}
+
+Player parsePlayer(const std::string& str) {
+    if (str == "X" || str == "x") return Player::X;
+    if (str == "O" || str == "o") return Player::O;
+    return Player::None;
+}
+
+std::string playerToString(Player player) {
+    if (player == Player::X) return "X";
+    if (player == Player::O) return "O";
+    return "None";
+}
+
+namespace {
+
+template <typename T>
+void appendNumber(std::string& out, T value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+const char* decisionTypeName(DecisionType type) {
+    switch (type) {
+        case DecisionType::IMMEDIATE_WIN:
+            return "IMMEDIATE_WIN";
+        case DecisionType::IMMEDIATE_BLOCK:
+            return "IMMEDIATE_BLOCK";
+        case DecisionType::DANGEROUS_THREAT:
+            return "DANGEROUS_THREAT";
+        case DecisionType::THREAT_SOLVER:
+            return "THREAT_SOLVER";
+        case DecisionType::OPENING_BOOK:
+            return "OPENING_BOOK";
+        case DecisionType::NEGAMAX_SEARCH:
+            break;
+    }
+    return "NEGAMAX_SEARCH";
+}
+
+void writeBoard(const Response& response, std::string& out) {
+    out += "    \"cells\": [";
+    bool first = true;
+    for (const auto& cell : response.cells) {
+        if (!first) out += ", ";
+        out += "{\"x\": ";
+        appendNumber(out, cell.x);
+        out += ", \"y\": ";
+        appendNumber(out, cell.y);
+        out += ", \"player\": \"";
+        out += playerToString(cell.player);
+        out += "\"}";
+        first = false;
+    }
+    out += "],\n";
+    
+    out += "    \"bbox\": {\"min_x\": ";
+    appendNumber(out, response.bbox.getMinX());
+    out += ", \"max_x\": ";
+    appendNumber(out, response.bbox.getMaxX());
+    out += ", \"min_y\": ";
+    appendNumber(out, response.bbox.getMinY());
+    out += ", \"max_y\": ";
+    appendNumber(out, response.bbox.getMaxY());
+    out += "}\n";
+}
+
+#ifdef ENGINE_INSTRUMENTATION
+void writeCounter(std::string& out, const char* name, uint64_t value, bool last = false) {
+    out += "      \"";
+    out += name;
+    out += "\": ";
+    appendNumber(out, value);
+    out += last ? "\n" : ",\n";
+}
+
+void writeCounters(const SearchCounters& counters, std::string& out) {
+    out += "    \"counters\": {\n";
+    writeCounter(out, "tt_probes", counters.tt_probes);
+    writeCounter(out, "tt_hits", counters.tt_hits);
+    writeCounter(out, "tt_cutoffs", counters.tt_cutoffs);
+    writeCounter(out, "tt_collisions", counters.tt_collisions);
+    writeCounter(out, "quiescence_nodes", counters.quiescence_nodes);
+    writeCounter(out, "lmr_researches", counters.lmr_researches);
+    writeCounter(out, "threat_solver_nodes", counters.threat_solver_nodes);
+    writeCounter(out, "candidate_lists", counters.candidate_lists);
+    writeCounter(out, "candidate_moves", counters.candidate_moves);
+    writeCounter(out, "candidate_max", counters.candidate_max);
+    out += "      \"beta_cutoff_index\": [";
+    for (int i = 0; i < SearchCounters::CUTOFF_BUCKETS; ++i) {
+        if (i > 0) out += ", ";
+        appendNumber(out, counters.beta_cutoff_index[i]);
+    }
+    out += "],\n";
+    out += "      \"phase_us\": {\"immediate_checks\": ";
+    appendNumber(out, counters.immediate_checks_us);
+    out += ", \"has_threats\": ";
+    appendNumber(out, counters.has_threats_us);
+    out += ", \"threat_solver\": ";
+    appendNumber(out, counters.threat_solver_us);
+    out += ", \"negamax\": ";
+    appendNumber(out, counters.negamax_us);
+    out += "}\n";
+    out += "    }\n";
+}
+#endif
+
+void writeStats(const SearchStats& stats, std::string& out) {
+    out += "    \"time_ms\": ";
+    appendNumber(out, stats.getTimeMs());
+    out += ",\n    \"decision_type\": \"";
+    out += decisionTypeName(stats.getDecisionType());
+    out += "\",\n    \"depth_reached\": ";
+    appendNumber(out, stats.getDepthReached());
+    out += ",\n    \"nodes_searched\": ";
+    appendNumber(out, stats.getNodesSearched());
+    out += ",\n    \"final_score\": ";
+    appendNumber(out, stats.getFinalScore());
+    out += ",\n";
+    
+    out += "    \"principal_variation\": [";
+    bool first = true;
+    for (int i = 0; i < stats.getPvLength(); ++i) {
+        Move pvMove = stats.getPrincipalVariation(i);
+        if (pvMove.x != 0 || pvMove.y != 0) {
+            if (!first) out += ", ";
+            out += "{\"x\": ";
+            appendNumber(out, pvMove.x);
+            out += ", \"y\": ";
+            appendNumber(out, pvMove.y);
+            out += "}";
+            first = false;
+        }
+    }
+#ifdef ENGINE_INSTRUMENTATION
+    out += "],\n";
+    writeCounters(stats.getCounters(), out);
+#else
+    out += "]\n";
+#endif
+}
+
+void writeAnalysisLines(const std::vector<AnalysisLine>& lines, std::string& out) {
+    out += "[";
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const AnalysisLine& line = lines[i];
+        if (i > 0) out += ", ";
+        out += "{\"x\": ";
+        appendNumber(out, line.move.x);
+        out += ", \"y\": ";
+        appendNumber(out, line.move.y);
+        out += ", \"score\": ";
+        appendNumber(out, line.score);
+        out += ", \"depth\": ";
+        appendNumber(out, line.depth);
+        out += ", \"pv\": [";
+        for (size_t k = 0; k < line.pv.size(); ++k) {
+            if (k > 0) out += ", ";
+            out += "{\"x\": ";
+            appendNumber(out, line.pv[k].x);
+            out += ", \"y\": ";
+            appendNumber(out, line.pv[k].y);
+            out += "}";
+        }
+        out += "]}";
+    }
+    out += "]";
+}
+
+Response makeBoardResponse(const SparseBoard& board) {
+    Response response;
+    response.success = true;
+    response.bbox = board.getBoundingBox();
+    
+    auto occupied = board.getOccupiedPositions();
+    response.cells.reserve(occupied.GetLength());
+    for (int i = 0; i < occupied.GetLength(); ++i) {
+        const auto& pos = occupied.Get(i);
+        Player player = board.at(pos.x, pos.y);
+        if (player != Player::None) {
+            response.cells.push_back({pos.x, pos.y, player});
+        }
+    }
+    return response;
+}
+
+int normalizeWinLength(int winLength) {
+    if (winLength < 3) winLength = Config::WIN_LENGTH;
+    if (winLength > 20) winLength = 20;
+    return winLength;
+}
+
+Response invalidHistoryError(const SparseBoard::Move& move, size_t totalMoves) {
+    return makeError("Invalid move in history: (" + std::to_string(move.x) + ", " +
+                     std::to_string(move.y) + "), player: " + playerToString(move.player) +
+                     ", total moves: " + std::to_string(totalMoves));
+}
+
+bool playMove(SparseBoard& board, GameSession* session, int x, int y, Player player) {
+    return session != nullptr ? session->play(x, y, player) : board.makeMove(x, y, player);
+}
+
+Response finishResponse(const SparseBoard& board, GameSession* session) {
+    Response response = makeBoardResponse(board);
+    if (session != nullptr) {
+        response.bbox = session->getBoundingBox();
+        response.hasPosition = true;
+        response.ply = session->getPly();
+        response.hash = session->getHash();
+        response.isTerminal = session->isTerminal();
+    } else {
+        response.isTerminal = board.isTerminal();
+    }
+    return response;
+}
+
+Response runCommand(const Request& request, SparseBoard& board, EngineCache& engines,
+                    GameSession* session, const AnalysisCallback& onInfo) {
+    Player currentPlayer = parsePlayer(request.currentPlayer);
+    if (currentPlayer == Player::None && !request.currentPlayer.empty()) {
+        return makeError("Invalid current_player: " + request.currentPlayer);
+    }
+    
+    int timeMs = request.timeMs;
+    if (timeMs <= 0) timeMs = Config::DEFAULT_TIME_MS;
+    
+    if (request.command == "make_move") {
+        if (!playMove(board, session, request.moveX, request.moveY, currentPlayer)) {
+            return makeError("Invalid move: (" + std::to_string(request.moveX) + ", " +
+                             std::to_string(request.moveY) + ")");
+        }
+        
+        Response response = finishResponse(board, session);
+        response.gameOver = response.isTerminal;
+        if (response.gameOver && board.isWin(request.moveX, request.moveY, currentPlayer)) {
+            response.winner = currentPlayer;
+        }
+        response.hasMove = true;
+        response.move = Move(request.moveX, request.moveY);
+        response.movePlayer = currentPlayer;
+        return response;
+    
+    } else if (request.command == "ai_move") {
+        SearchEngine& engine = engines.get(board.getWinLength());
+        
+        Move aiMove = engine.findBestMove(board, currentPlayer, timeMs);
+        
+        if (!playMove(board, session, aiMove.x, aiMove.y, currentPlayer)) {
+            return makeError("AI generated invalid move: (" + std::to_string(aiMove.x) + ", " +
+                             std::to_string(aiMove.y) + ")");
+        }
+        
+        Response response = finishResponse(board, session);
+        response.gameOver = response.isTerminal;
+        if (response.gameOver && board.isWin(aiMove.x, aiMove.y, currentPlayer)) {
+            response.winner = currentPlayer;
+        }
+        response.hasMove = true;
+        response.move = aiMove;
+        response.movePlayer = currentPlayer;
+        response.hasStats = true;
+        response.stats = engine.getStats();
+        return response;
+    
+    } else if (request.command == "analyze") {
+        if (board.isTerminal()) {
+            return makeError("Cannot analyze a finished game");
+        }
+        SearchEngine& engine = engines.get(board.getWinLength());
+        
+        Response response = finishResponse(board, session);
+        response.analysis = engine.analyze(board, currentPlayer, request.multiPv, timeMs, onInfo);
+        response.hasStats = true;
+        response.stats = engine.getStats();
+        return response;
+    
+    } else if (request.command == "get_state") {
+        Response response = finishResponse(board, session);
+        response.gameOver = response.isTerminal;
+        return response;
+    }
+    
+    return makeError("Unknown command: " + request.command);
+}
+
+} // namespace
+
+std::string formatHash(uint64_t hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        text[i] = digits[hash & 0xF];
+        hash >>= 4;
+    }
+    return text;
+}
+
+uint64_t parseHash(const std::string& text) {
+    if (text.empty() || text.size() > 16) {
+        throw std::invalid_argument("Invalid position hash: " + text);
+    }
+    uint64_t hash = 0;
+    for (char c : text) {
+        int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        else throw std::invalid_argument("Invalid position hash: " + text);
+        hash = (hash << 4) | static_cast<uint64_t>(digit);
+    }
+    return hash;
+}
+
+Response makeError(const std::string& error) {
+    Response response;
+    response.success = false;
+    response.error = error;
+    return response;
+}
+
+void writeJsonResponse(const Response& response, std::string& out) {
+    if (!response.success) {
+        out += "{\n  \"success\": false,\n  \"error\": \"";
+        out += escapeJSON(response.error);
+        if (response.resync) {
+            out += "\",\n  \"resync\": true,\n  \"ply\": ";
+            appendNumber(out, response.ply);
+            out += "\n}\n";
+        } else {
+            out += "\"\n}\n";
+        }
+        return;
+    }
+    
+    out += "{\n  \"success\": true,\n  \"board\": {\n";
+    writeBoard(response, out);
+    out += "  },\n";
+    
+    if (response.hasMove) {
+        out += "  \"move\": {\"x\": ";
+        appendNumber(out, response.move.x);
+        out += ", \"y\": ";
+        appendNumber(out, response.move.y);
+        out += ", \"player\": \"";
+        out += response.movePlayer != Player::None ? playerToString(response.movePlayer) : "X";
+        out += "\"},\n";
+    }
+    
+    if (response.hasStats) {
+        out += "  \"stats\": {\n";
+        writeStats(response.stats, out);
+        out += "  },\n";
+    }
+    
+    if (!response.analysis.empty()) {
+        out += "  \"analysis\": ";
+        writeAnalysisLines(response.analysis, out);
+        out += ",\n";
+    }
+    
+    out += response.gameOver ? "  \"game_over\": true,\n" : "  \"game_over\": false,\n";
+    
+    if (response.gameOver && response.winner != Player::None) {
+        out += "  \"winner\": \"";
+        out += playerToString(response.winner);
+        out += "\",\n";
+    } else {
+        out += "  \"winner\": null,\n";
+    }
+    
+    out += response.isTerminal ? "  \"is_terminal\": true" : "  \"is_terminal\": false";
+    if (response.hasPosition) {
+        out += ",\n  \"ply\": ";
+        appendNumber(out, response.ply);
+        out += ",\n  \"hash\": \"";
+        out += formatHash(response.hash);
+        out += "\"";
+    }
+    out += "\n}\n";
+}
+
+void writeJsonInfo(const AnalysisInfo& info, std::string& out) {
+    out += "{\"depth\": ";
+    appendNumber(out, info.depth);
+    out += ", \"nodes\": ";
+    appendNumber(out, info.nodes);
+    out += ", \"time_ms\": ";
+    appendNumber(out, info.timeMs);
+    out += ", \"nps\": ";
+    appendNumber(out, info.nodesPerSecond);
+    out += ", \"lines\": ";
+    writeAnalysisLines(info.lines, out);
+    out += "}";
+}
+
+std::string compactJSON(const std::string& json) {
+    std::string result;
+    result.reserve(json.size());
+    bool skipIndent = false;
+    for (char c : json) {
+        if (c == '\n') {
+            skipIndent = true;
+            continue;
+        }
+        if (skipIndent && c == ' ') continue;
+        skipIndent = false;
+        result += c;
+    }
+    return result;
+}
+
+Response executeRequest(const Request& request, EngineCache& engines,
+                        const AnalysisCallback& onInfo) {
+    if (request.command.empty()) {
+        return makeError("Missing 'command' field");
+    }
+    
+    int winLength = normalizeWinLength(request.winLength);
+    SparseBoard board(winLength);
+    for (const auto& move : request.moves) {
+        if (!board.makeMove(move.x, move.y, move.player)) {
+            return invalidHistoryError(move, request.moves.size());
+        }
+    }
+    
+    return runCommand(request, board, engines, nullptr, onInfo);
+}
+
+Response executeRequest(const Request& request, EngineCache& engines, SessionStore& sessions,
+                        const AnalysisCallback& onInfo) {
+    if (request.gameId.empty()) {
+        return executeRequest(request, engines, onInfo);
+    }
+    if (request.command.empty()) {
+        return makeError("Missing 'command' field");
+    }
+    
+    GameSession& session = sessions.acquire(request.gameId, normalizeWinLength(request.winLength));
+    if (request.basePly < 0 || request.basePly > session.getPly() ||
+        session.getHashAt(request.basePly) != request.baseHash) {
+        Response response = makeError("Position mismatch for game " + request.gameId + " at ply " +
+                                      std::to_string(request.basePly) + ", engine is at ply " +
+                                      std::to_string(session.getPly()));
+        response.resync = true;
+        response.ply = session.getPly();
+        return response;
+    }
+    
+    session.rewind(request.basePly);
+    for (const auto& move : request.moves) {
+        if (!session.play(move.x, move.y, move.player)) {
+            session.rewind(request.basePly);
+            return invalidHistoryError(move, request.moves.size());
+        }
+    }
+    
+    return runCommand(request, session.getBoard(), engines, &session, onInfo);
+}
+
+int handleRequest(const std::string& input, std::ostream& out, EngineCache& engines) {
+    Response response;
+    try {
+        if (input.find_first_not_of(" \t\r\n") == std::string::npos) {
+            response = makeError("Empty input");
+        } else {
+            response = executeRequest(parseJsonRequest(input), engines, [&out](const AnalysisInfo& info) {
+                std::string line = "{\"info\": ";
+                writeJsonInfo(info, line);
+                line += "}\n";
+                out.write(line.data(), line.size());
+                out.flush();
+            });
+        }
+    } catch (const std::exception& e) {
+        response = makeError(std::string("Exception: ") + e.what());
+    } catch (...) {
+        response = makeError("Unknown exception occurred");
+    }
+    
+    std::string buffer;
+    buffer.reserve(256 + response.cells.size() * 40);
+    writeJsonResponse(response, buffer);
+    out.write(buffer.data(), buffer.size());
+    
+    return response.success ? 0 : 1;
+}
+
+} // namespace tictactoe
@@ -0,0 +1,59 @@
+#include "cli/serve_loop.h"
+#include "cli/request_handler.h"
+#include "cli/json_reader.h"
+#include <string>
+
+namespace tictactoe {
+
+namespace {
+
+void writeLine(std::ostream& out, const std::string& id, const char* kind, const std::string& body) {
+    std::string line = "{\"id\": \"";
+    line += escapeJSON(id);
+    line += "\", \"";
+    line += kind;
+    line += "\": ";
+    line += body;
+    line += "}\n";
+    out.write(line.data(), line.size());
+    out.flush();
+}
+
+} // namespace
+
+int runServe(std::istream& in, std::ostream& out, const OpeningBook* book,
+             const TTSnapshot* ttSnapshot) {
+    EngineCache engines(book, ttSnapshot);
+    SessionStore sessions;
+    std::string line;
+    std::string json;
+    
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        
+        Request request;
+        Response response;
+        try {
+            request = parseJsonRequest(line);
+            if (request.command == "ping") {
+                writeLine(out, request.id, "result", "{\"success\": true, \"pong\": true}");
+                continue;
+            }
+            response = executeRequest(request, engines, sessions, [&](const AnalysisInfo& info) {
+                std::string progress;
+                writeJsonInfo(info, progress);
+                writeLine(out, request.id, "info", progress);
+            });
+        } catch (const std::exception& e) {
+            response = makeError(std::string("Exception: ") + e.what());
+        }
+        
+        json.clear();
+        writeJsonResponse(response, json);
+        writeLine(out, request.id, "result", compactJSON(json));
+    }
+    
+    return 0;
+}
+
+} // namespace tictactoe
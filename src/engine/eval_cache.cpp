@@ -0,0 +1,47 @@
+#include "engine/eval_cache.h"
+
+namespace tictactoe {
+
+EvalCache::EvalCache(size_t sizeMB) {
+    size_t targetSize = (sizeMB * 1024 * 1024) / sizeof(std::atomic<uint64_t>);
+    
+    size_ = 1;
+    while (size_ < targetSize && size_ < (1ULL << 30)) {
+        size_ <<= 1;
+    }
+    if (size_ > 1) {
+        size_ >>= 1;
+    }
+    
+    table_ = new std::atomic<uint64_t>[size_];
+    clear();
+}
+
+EvalCache::~EvalCache() {
+    delete[] table_;
+}
+
+void EvalCache::clear() {
+    for (size_t i = 0; i < size_; ++i) {
+        table_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool EvalCache::probe(uint64_t hash, Player player, int& score) const {
+    uint64_t data = table_[hash & (size_ - 1)].load(std::memory_order_relaxed);
+    if ((data & VALID) == 0 || (data & KEY_MASK) != (hash & KEY_MASK)) {
+        return false;
+    }
+    
+    int stored = static_cast<int32_t>(static_cast<uint32_t>(data));
+    score = player == Player::X ? stored : -stored;
+    return true;
+}
+
+void EvalCache::store(uint64_t hash, Player player, int score) {
+    int stored = player == Player::X ? score : -score;
+    uint64_t data = (hash & KEY_MASK) | VALID | static_cast<uint32_t>(stored);
+    table_[hash & (size_ - 1)].store(data, std::memory_order_relaxed);
+}
+
+} // namespace tictactoe
@@ -0,0 +1,126 @@
+#include "engine/eval_weights.h"
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace tictactoe {
+
+namespace {
+    std::mutex g_installed_mutex;
+    std::map<int, EvalWeights> g_installed;
+}
+
+EvalWeights EvalWeights::defaults(int winLength) {
+    EvalWeights weights;
+    weights.winLength = winLength;
+    
+    for (int k = 1; k < winLength && k < MAX_LENGTH; ++k) {
+        double baseScore = std::pow(10.0, k);
+        double proximityBonus = std::pow(4.0, winLength - k);
+        weights.open[k] = static_cast<int>(baseScore * proximityBonus * 2.0);
+        weights.closed[k] = static_cast<int>(baseScore * proximityBonus);
+    }
+    
+    return weights;
+}
+
+EvalWeights EvalWeights::forWinLength(int winLength) {
+    std::lock_guard<std::mutex> lock(g_installed_mutex);
+    auto it = g_installed.find(winLength);
+    if (it != g_installed.end()) {
+        return it->second;
+    }
+    return defaults(winLength);
+}
+
+void EvalWeights::install(const EvalWeights& weights) {
+    std::lock_guard<std::mutex> lock(g_installed_mutex);
+    g_installed[weights.winLength] = weights;
+}
+
+void EvalWeights::clearInstalled() {
+    std::lock_guard<std::mutex> lock(g_installed_mutex);
+    g_installed.clear();
+}
+
+bool EvalWeights::read(std::istream& in, std::vector<EvalWeights>& sets) {
+    sets.clear();
+    
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        
+        if (key == "win_length") {
+            int winLength = 0;
+            if (!(fields >> winLength) || winLength < 2 || winLength > MAX_LENGTH) {
+                return false;
+            }
+            sets.push_back(defaults(winLength));
+            continue;
+        }
+        if (sets.empty()) {
+            return false;
+        }
+        
+        EvalWeights& weights = sets.back();
+        if (key == "open" || key == "closed") {
+            auto& values = key == "open" ? weights.open : weights.closed;
+            for (int k = 1; k < weights.winLength; ++k) {
+                if (!(fields >> values[k])) {
+                    return false;
+                }
+            }
+        } else if (key == "broken_percent") {
+            if (!(fields >> weights.brokenPercent)) return false;
+        } else if (key == "fork_bonus") {
+            if (!(fields >> weights.forkBonus)) return false;
+        } else {
+            return false;
+        }
+    }
+    
+    return !sets.empty();
+}
+
+void EvalWeights::write(std::ostream& out, const std::vector<EvalWeights>& sets) {
+    out << "# tictactoe evaluation weights\n";
+    for (const auto& weights : sets) {
+        out << "win_length " << weights.winLength << "\n";
+        out << "open";
+        for (int k = 1; k < weights.winLength; ++k) out << " " << weights.open[k];
+        out << "\nclosed";
+        for (int k = 1; k < weights.winLength; ++k) out << " " << weights.closed[k];
+        out << "\nbroken_percent " << weights.brokenPercent << "\n";
+        out << "fork_bonus " << weights.forkBonus << "\n";
+    }
+}
+
+bool EvalWeights::load(const std::string& path) {
+    std::ifstream in(path);
+    std::vector<EvalWeights> sets;
+    if (!in || !read(in, sets)) {
+        return false;
+    }
+    for (const auto& weights : sets) {
+        install(weights);
+    }
+    return true;
+}
+
+bool EvalWeights::save(const std::string& path, const std::vector<EvalWeights>& sets) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    write(out, sets);
+    return static_cast<bool>(out);
+}
+
+} // namespace tictactoe
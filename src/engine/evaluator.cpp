@@ -1,7 +1,6 @@
 #include "engine/evaluator.h"
 #include "board/sparse_board.h"
 #include "engine/config.h"
-#include <cmath>
 #include <algorithm>
 #include <limits>
 
@@ -18,20 +17,17 @@ Evaluator::Evaluator(int win_length) : win_length_(win_length) {
     initPatternWeights(win_length);
 }
 
-void Evaluator::initPatternWeights(int N) {
-    win_length_ = N;
-    
-    for (int i = 0; i < 20; ++i) {
-        open_pattern_scores_[i] = 0;
-        closed_pattern_scores_[i] = 0;
-    }
+Evaluator::Evaluator(const EvalWeights& weights) : win_length_(weights.winLength) {
+    setWeights(weights);
+}
     
-    for (int k = 1; k < N && k < 20; ++k) {
-        double baseScore = std::pow(10.0, k);
-        double proximityBonus = std::pow(4.0, N - k);
-        open_pattern_scores_[k] = static_cast<int>(baseScore * proximityBonus * 2.0);
-        closed_pattern_scores_[k] = static_cast<int>(baseScore * proximityBonus);
-    }
+void Evaluator::initPatternWeights(int N) {
+    setWeights(EvalWeights::forWinLength(N));
+}
+
+void Evaluator::setWeights(const EvalWeights& weights) {
+    win_length_ = weights.winLength;
+    weights_ = weights;
 }
 
 int Evaluator::getPatternScore(int length, bool isOpen) const {
@@ -40,16 +36,16 @@ int Evaluator::getPatternScore(int length, bool isOpen) const {
     }
     
     if (isOpen) {
-        return open_pattern_scores_[length];
+        return weights_.open[length];
     } else {
-        return closed_pattern_scores_[length];
+        return weights_.closed[length];
     }
 }
 
 int Evaluator::calculatePatternScore(int length, bool isOpen, bool isBroken) const {
     int baseScore = getPatternScore(length, isOpen);
     if (isBroken) {
-        return baseScore / 2;
+        return baseScore * weights_.brokenPercent / 100;
     }
     return baseScore;
 }
@@ -67,7 +63,9 @@ Evaluator::LineInfo Evaluator::analyzeLineInfo(
     }
     
     current = Position(x, y) + dir;
-    int maxIterations = 20;
+    // One less than LINE_REACH: a gap found on the last step peeks one
+    // cell further.
+    int maxIterations = LINE_REACH - 1;
     int iterations = 0;
     while (iterations < maxIterations) {
         iterations++;
@@ -131,10 +129,10 @@ Pattern Evaluator::analyzeLine(
     return pattern;
 }
 
-adt::ArraySequence<Pattern> Evaluator::detectPatterns(
+PatternList Evaluator::detectPatterns(
     const SparseBoard& board, int x, int y, Player player) {
     
-    adt::ArraySequence<Pattern> patterns;
+    PatternList patterns;
     
     for (int i = 0; i < 4; ++i) {
         Pattern p = analyzeLine(board, x, y, directions_[i], player);
@@ -161,7 +159,7 @@ int Evaluator::detectForks(const SparseBoard& board, int x, int y, Player player
     }
     
     if (threatCount >= 2) {
-        return totalScore + Config::FORK_BONUS;
+        return totalScore + weights_.forkBonus;
     }
     
     return totalScore;
@@ -215,5 +213,28 @@ int Evaluator::evaluatePosition(const SparseBoard& board, Player player) {
     return score;
 }
 
+void Evaluator::patternFeatures(
+    const SparseBoard& board, Player player, std::vector<double>& features) {
+    
+    features.assign(2 * EvalWeights::MAX_LENGTH, 0.0);
+    double broken = weights_.brokenPercent / 100.0;
+    auto occupied = board.getOccupiedPositions();
+    
+    for (int i = 0; i < occupied.GetLength(); ++i) {
+        const auto& pos = occupied.Get(i);
+        Player cellPlayer = board.at(pos.x, pos.y);
+        double sign = cellPlayer == player ? 1.0 : -1.0;
+        
+        for (int d = 0; d < 4; ++d) {
+            Pattern p = analyzeLine(board, pos.x, pos.y, directions_[d], cellPlayer);
+            if (p.getLength() <= 0 || p.getLength() >= win_length_) {
+                continue;
+            }
+            int index = p.isOpen() ? p.getLength() : EvalWeights::MAX_LENGTH + p.getLength();
+            features[index] += p.isBroken() ? sign * broken : sign;
+        }
+    }
+}
+
 } // namespace tictactoe
 
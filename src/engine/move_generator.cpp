@@ -1,28 +1,48 @@
 #include "engine/move_generator.h"
 #include "board/sparse_board.h"
+#include "board/line_kernel.h"
 #include "engine/config.h"
 #include <algorithm>
 #include <optional>
 #include <limits>
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 
 namespace tictactoe {
 
 MoveGenerator::MoveGenerator(int win_length) 
-    : evaluator_(win_length), win_length_(win_length) {
+    : evaluator_(win_length), win_length_(win_length),
+      top_k_(Config::TOP_K_CANDIDATES), radius_(Config::CANDIDATE_RADIUS), pool_(nullptr) {
+}
+
+void MoveGenerator::setCandidateLimits(int topK, int radius) {
+    top_k_ = std::max(1, topK);
+    radius_ = std::max(1, radius);
 }
 
 std::optional<Move> MoveGenerator::checkImmediateWin(
     const SparseBoard& board, Player player) {
     
+    return dispatchWinLength(win_length_, [&](auto kernel) {
+        return findImmediateWin<decltype(kernel)::value>(board, player);
+    });
+}
+
+template <int WinLength>
+std::optional<Move> MoveGenerator::findImmediateWin(
+    const SparseBoard& board, Player player) const {
+    
+    using Kernel = LineKernel<WinLength>;
+    const int winLength = Kernel::length(win_length_);
+    
     auto occupied = board.getOccupiedPositions();
     
     if (occupied.Empty()) {
         return std::nullopt;
     }
     
-    std::unordered_set<Position, PositionHash> candidateSet;
+    PositionSet candidateSet;
     
     const Position directions[4] = {
         Position(1, 0), Position(0, 1), Position(1, 1), Position(1, -1)
@@ -33,27 +53,12 @@ std::optional<Move> MoveGenerator::checkImmediateWin(
         if (board.at(pos.x, pos.y) != player) continue;
         
         for (int d = 0; d < 4; ++d) {
-            int count = 1;
-            Position current = pos;
-            
-            Position forward = current + directions[d];
-            int maxIter = win_length_;
-            int iter = 0;
-            while (iter < maxIter && board.at(forward.x, forward.y) == player) {
-                count++;
-                forward = forward + directions[d];
-                iter++;
-            }
+            Position forward;
+            Position backward;
+            int count = Kernel::line(board, pos.x, pos.y, directions[d], player, winLength,
+                                     forward, backward);
             
-            Position backward = current - directions[d];
-            iter = 0;
-            while (iter < maxIter && board.at(backward.x, backward.y) == player) {
-                count++;
-                backward = backward - directions[d];
-                iter++;
-            }
-            
-            if (count >= win_length_ - 1) {
+            if (count >= winLength - 1) {
                 if (board.isEmpty(forward.x, forward.y)) {
                     candidateSet.insert(forward);
                 }
@@ -66,23 +71,11 @@ std::optional<Move> MoveGenerator::checkImmediateWin(
     
     for (const auto& pos : candidateSet) {
         for (int d = 0; d < 4; ++d) {
-            int lineCount = 1;
-            Position forward = pos + directions[d];
-            int maxIter = win_length_;
-            int iter = 0;
-            while (iter < maxIter && board.at(forward.x, forward.y) == player) {
-                lineCount++;
-                forward = forward + directions[d];
-                iter++;
-            }
-            Position backward = pos - directions[d];
-            iter = 0;
-            while (iter < maxIter && board.at(backward.x, backward.y) == player) {
-                lineCount++;
-                backward = backward - directions[d];
-                iter++;
-            }
-            if (lineCount >= win_length_) {
+            Position forward;
+            Position backward;
+            int lineCount = Kernel::line(board, pos.x, pos.y, directions[d], player, winLength,
+                                         forward, backward);
+            if (lineCount >= winLength) {
                 return Move(pos.x, pos.y, std::numeric_limits<int>::max());
             }
         }
@@ -107,11 +100,23 @@ std::optional<Move> MoveGenerator::checkImmediateBlock(
 std::optional<Move> MoveGenerator::checkDangerousThreat(
     const SparseBoard& board, Player player) {
     
-    if (win_length_ < 4) {
+    return dispatchWinLength(win_length_, [&](auto kernel) {
+        return findDangerousThreat<decltype(kernel)::value>(board, player);
+    });
+}
+
+template <int WinLength>
+std::optional<Move> MoveGenerator::findDangerousThreat(
+    const SparseBoard& board, Player player) const {
+    
+    using Kernel = LineKernel<WinLength>;
+    const int winLength = Kernel::length(win_length_);
+    
+    if (winLength < 4) {
         return std::nullopt;
     }
     
-    int threatLength = win_length_ - 2;
+    int threatLength = winLength - 2;
     Player opponent = (player == Player::X) ? Player::O : Player::X;
     
     auto occupied = board.getOccupiedPositions();
@@ -119,7 +124,7 @@ std::optional<Move> MoveGenerator::checkDangerousThreat(
         return std::nullopt;
     }
     
-    std::unordered_set<Position, PositionHash> blockingMoves;
+    PositionSet blockingMoves;
     
     const Position directions[4] = {
         Position(1, 0), Position(0, 1), Position(1, 1), Position(1, -1)
@@ -130,25 +135,10 @@ std::optional<Move> MoveGenerator::checkDangerousThreat(
         if (board.at(pos.x, pos.y) != opponent) continue;
         
         for (int d = 0; d < 4; ++d) {
-            int count = 1;
-            Position current = pos;
-            
-            Position forward = current + directions[d];
-            int maxIter = win_length_;
-            int iter = 0;
-            while (iter < maxIter && board.at(forward.x, forward.y) == opponent) {
-                count++;
-                forward = forward + directions[d];
-                iter++;
-            }
-            
-            Position backward = current - directions[d];
-            iter = 0;
-            while (iter < maxIter && board.at(backward.x, backward.y) == opponent) {
-                count++;
-                backward = backward - directions[d];
-                iter++;
-            }
+            Position forward;
+            Position backward;
+            int count = Kernel::line(board, pos.x, pos.y, directions[d], opponent, winLength,
+                                     forward, backward);
             
             if (count == threatLength) {
                 bool leftOpen = board.isEmpty(backward.x, backward.y);
@@ -191,8 +181,107 @@ std::optional<Move> MoveGenerator::checkDangerousThreat(
     return std::nullopt;
 }
 
+ThreatClass MoveGenerator::classifyThreat(
+    const SparseBoard& board, int x, int y, Player player) {
+    
+    return dispatchWinLength(win_length_, [&](auto kernel) {
+        return findThreatClass<decltype(kernel)::value>(board, x, y, player);
+    });
+}
+
+template <int WinLength>
+ThreatClass MoveGenerator::findThreatClass(
+    const SparseBoard& board, int x, int y, Player player) const {
+    
+    using Kernel = LineKernel<WinLength>;
+    const int winLength = Kernel::length(win_length_);
+    // With three in a row to win, every stone would count as a three.
+    const bool threes = winLength >= 4;
+    Player opponent = (player == Player::X) ? Player::O : Player::X;
+    
+    const Position directions[4] = {
+        Position(1, 0), Position(0, 1), Position(1, 1), Position(1, -1)
+    };
+    
+    ThreatClass best = ThreatClass::NONE;
+    for (int d = 0; d < 4; ++d) {
+        Position forward;
+        Position backward;
+        int own = Kernel::line(board, x, y, directions[d], player, winLength, forward, backward);
+        bool ownOpen = board.isEmpty(forward.x, forward.y) && board.isEmpty(backward.x, backward.y);
+        if (own >= winLength) {
+            return ThreatClass::WIN;
+        }
+        
+        int theirs = Kernel::line(board, x, y, directions[d], opponent, winLength, forward, backward);
+        bool theirsOpen = board.isEmpty(forward.x, forward.y) && board.isEmpty(backward.x, backward.y);
+        
+        ThreatClass cls = ThreatClass::NONE;
+        if (theirs >= winLength) {
+            cls = ThreatClass::BLOCK_WIN;
+        } else if (own == winLength - 1) {
+            cls = ownOpen ? ThreatClass::OPEN_FOUR : ThreatClass::FOUR;
+        } else if (threes && theirs == winLength - 1 && theirsOpen) {
+            cls = ThreatClass::BLOCK_THREE;
+        } else if (threes && own == winLength - 2 && ownOpen) {
+            cls = ThreatClass::OPEN_THREE;
+        }
+        best = std::min(best, cls);
+    }
+    
+    return best;
+}
+
+MoveList MoveGenerator::generateTactical(const SparseBoard& board, Player player) {
+    return dispatchWinLength(win_length_, [&](auto kernel) {
+        return findTactical<decltype(kernel)::value>(board, player);
+    });
+}
+
+template <int WinLength>
+MoveList MoveGenerator::findTactical(const SparseBoard& board, Player player) const {
+    const int winLength = LineKernel<WinLength>::length(win_length_);
+    
+    const Position directions[4] = {
+        Position(1, 0), Position(0, 1), Position(1, 1), Position(1, -1)
+    };
+    
+    // A cell can only extend or cut a run if it is on a line with some
+    // stone, less than a win length away.
+    PositionSet cells;
+    auto occupied = board.getOccupiedPositions();
+    for (int i = 0; i < occupied.GetLength(); ++i) {
+        const auto& pos = occupied.Get(i);
+        for (int d = 0; d < 4; ++d) {
+            Position forward = pos;
+            Position backward = pos;
+            for (int step = 1; step < winLength; ++step) {
+                forward = forward + directions[d];
+                backward = backward - directions[d];
+                if (board.isEmpty(forward.x, forward.y)) {
+                    cells.insert(forward);
+                }
+                if (board.isEmpty(backward.x, backward.y)) {
+                    cells.insert(backward);
+                }
+            }
+        }
+    }
+    
+    MoveList moves;
+    for (const auto& cell : cells) {
+        ThreatClass cls = findThreatClass<WinLength>(board, cell.x, cell.y, player);
+        if (cls != ThreatClass::NONE) {
+            int score = static_cast<int>(ThreatClass::NONE) - static_cast<int>(cls);
+            moves.AppendInPlace(Move(cell.x, cell.y, score));
+        }
+    }
+    moves.SortInPlace();
+    return moves;
+}
+
 void MoveGenerator::addNeighbors(int x, int y, int radius,
-                                std::unordered_set<Position, PositionHash>& candidates,
+                                PositionSet& candidates,
                                 const SparseBoard& board) {
     for (int dx = -radius; dx <= radius; ++dx) {
         for (int dy = -radius; dy <= radius; ++dy) {
@@ -211,7 +300,7 @@ void MoveGenerator::addNeighbors(int x, int y, int radius,
 adt::ArraySequence<Position> MoveGenerator::generateRadiusCandidates(
     const SparseBoard& board, int radius) {
     
-    std::unordered_set<Position, PositionHash> candidateSet;
+    PositionSet candidateSet;
     auto occupied = board.getOccupiedPositions();
     
     if (occupied.Empty()) {
@@ -236,21 +325,103 @@ int MoveGenerator::scoreMove(const SparseBoard& board, int x, int y, Player play
     return evaluator_.evaluateMove(board, x, y, player);
 }
 
-void MoveGenerator::sortAndPrune(adt::ArraySequence<Move>& moves, int topK) {
+void MoveGenerator::sortAndPrune(MoveList& moves, int topK) {
     moves.SortInPlace();
     if (moves.GetLength() > topK) {
         moves.Resize(topK);
     }
 }
 
-adt::ArraySequence<Move> MoveGenerator::generateCandidates(
-    const SparseBoard& board, Player player) {
+void MoveGenerator::scoreInParallel(
+    const SparseBoard& board, const adt::ArraySequence<Position>& positions, Player player,
+    std::vector<int>& scores, const std::vector<char>& known) {
+    
+    // Workers only read the board; evaluateMove works on its own copy.
+    pool_->parallelFor(positions.GetLength(), PARALLEL_SCORING_GRAIN,
+        [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                if (!known[i]) {
+                    const auto& pos = positions.Get(i);
+                    scores[i] = scoreMove(board, pos.x, pos.y, player);
+                }
+            }
+        }, TaskPriority::HIGH);
+}
+
+// Brings the score cache from the position it was filled for to this one,
+// through the stones the two move histories do not share.
+void MoveGenerator::syncScoreCache(const SparseBoard& board) {
+    auto history = board.getMoveHistory();
+    int length = history.GetLength();
+    int cachedLength = static_cast<int>(scoredHistory_.size());
+    
+    int common = 0;
+    while (common < length && common < cachedLength) {
+        const auto& move = history.Get(common);
+        const auto& cached = scoredHistory_[common];
+        if (move.x != cached.x || move.y != cached.y || move.player != cached.player) {
+            break;
+        }
+        common++;
+    }
+    
+    int changes = (length - common) + (cachedLength - common);
+    if (changes > SCORE_CACHE_MAX_CHANGES || scoreCache_.size() > SCORE_CACHE_MAX_CELLS) {
+        scoreCache_.clear();
+    } else {
+        for (int i = common; i < cachedLength; ++i) {
+            invalidateLines(scoredHistory_[i].x, scoredHistory_[i].y);
+        }
+        for (int i = common; i < length; ++i) {
+            invalidateLines(history.Get(i).x, history.Get(i).y);
+        }
+    }
     
-    adt::ArraySequence<Move> candidates;
+    scoredHistory_.resize(common);
+    for (int i = common; i < length; ++i) {
+        scoredHistory_.push_back(history.Get(i));
+    }
+}
+
+void MoveGenerator::invalidateLines(int x, int y) {
+    const Position directions[4] = {
+        Position(1, 0), Position(0, 1), Position(1, 1), Position(1, -1)
+    };
+    
+    scoreCache_.erase(Position(x, y));
+    for (int d = 0; d < 4; ++d) {
+        for (int step = 1; step <= Evaluator::LINE_REACH; ++step) {
+            scoreCache_.erase(Position(x + step * directions[d].x, y + step * directions[d].y));
+            scoreCache_.erase(Position(x - step * directions[d].x, y - step * directions[d].y));
+        }
+    }
+}
+
+bool MoveGenerator::lookupScore(const Position& pos, Player player, int& score) const {
+    auto it = scoreCache_.find(pos);
+    int side = player == Player::X ? 0 : 1;
+    if (it == scoreCache_.end() || !it->second.known[side]) {
+        return false;
+    }
+    score = it->second.score[side];
+    return true;
+}
+
+void MoveGenerator::storeScore(const Position& pos, Player player, int score) {
+    auto& entry = scoreCache_.try_emplace(pos, CachedScores{{0, 0}, {false, false}}).first->second;
+    int side = player == Player::X ? 0 : 1;
+    entry.score[side] = score;
+    entry.known[side] = true;
+}
+
+MoveList MoveGenerator::generateCandidates(
+    const SparseBoard& board, Player player, bool parallel) {
+    
+    MoveList candidates;
     
     auto winMove = checkImmediateWin(board, player);
     if (winMove.has_value()) {
-        adt::ArraySequence<Move> result;
+        MoveList result;
         result.AppendInPlace(*winMove);
         return result;
     }
@@ -260,34 +431,66 @@ adt::ArraySequence<Move> MoveGenerator::generateCandidates(
         candidates.AppendInPlace(*blockMove);
     }
     
-    auto positions = generateRadiusCandidates(board, Config::CANDIDATE_RADIUS);
+    auto positions = generateRadiusCandidates(board, radius_);
     
     if (positions.GetLength() == 1 && positions.Get(0).x == 0 && positions.Get(0).y == 0) {
-        adt::ArraySequence<Move> result;
+        MoveList result;
         result.AppendInPlace(Move(0, 0, 0));
         return result;
     }
     
-    int scoreLimit = Config::TOP_K_CANDIDATES * 2;
+    std::unique_lock<std::mutex> cacheLock(scoreCacheMutex_, std::try_to_lock);
+    bool cached = cacheLock.owns_lock();
+    if (cached) {
+        syncScoreCache(board);
+    }
+    
+    // Scores everything up front, then replays the serial loop below on
+    // the results, so the early cut-off picks exactly the same candidates.
+    std::vector<int> scores;
+    if (parallel && pool_ != nullptr && pool_->getThreadCount() > 0 &&
+        positions.GetLength() >= Config::PARALLEL_SCORING_MIN_CELLS) {
+        scores.assign(positions.GetLength(), 0);
+        std::vector<char> known(positions.GetLength(), 0);
+        for (int i = 0; cached && i < positions.GetLength(); ++i) {
+            known[i] = lookupScore(positions.Get(i), player, scores[i]);
+        }
+        scoreInParallel(board, positions, player, scores, known);
+        for (int i = 0; cached && i < positions.GetLength(); ++i) {
+            if (!known[i]) {
+                storeScore(positions.Get(i), player, scores[i]);
+            }
+        }
+    }
+    
+    int scoreLimit = top_k_ * 2;
     int scored = 0;
     
     for (int i = 0; i < positions.GetLength(); ++i) {
         const auto& pos = positions.Get(i);
         if (board.isEmpty(pos.x, pos.y)) {
-            int score = scoreMove(board, pos.x, pos.y, player);
+            int score;
+            if (!scores.empty()) {
+                score = scores[i];
+            } else if (!cached) {
+                score = scoreMove(board, pos.x, pos.y, player);
+            } else if (!lookupScore(pos, player, score)) {
+                score = scoreMove(board, pos.x, pos.y, player);
+                storeScore(pos, player, score);
+            }
             candidates.AppendInPlace(Move(pos.x, pos.y, score));
             scored++;
             
-            if (scored >= scoreLimit && candidates.GetLength() >= Config::TOP_K_CANDIDATES) {
+            if (scored >= scoreLimit && candidates.GetLength() >= top_k_) {
                 candidates.SortInPlace();
-                if (candidates[Config::TOP_K_CANDIDATES - 1].score > 100) {
+                if (candidates.getScore(top_k_ - 1) > 100) {
                     break;
                 }
             }
         }
     }
     
-    sortAndPrune(candidates, Config::TOP_K_CANDIDATES);
+    sortAndPrune(candidates, top_k_);
     
     return candidates;
 }
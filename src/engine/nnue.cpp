@@ -0,0 +1,241 @@
+#include "engine/nnue.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace tictactoe {
+
+namespace {
+
+const char NNUE_MAGIC[8] = {'T', 'T', 'T', 'N', 'N', 'U', 'E', '\0'};
+
+struct NnueHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t winLength;
+    uint32_t window;
+    uint32_t hidden;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(NnueHeader) == 32, "NnueHeader is stored verbatim on disk");
+
+std::mutex g_installed_mutex;
+std::map<int, std::shared_ptr<const NnueNetwork>> g_installed;
+
+constexpr int HIDDEN = NnueAccumulator::HIDDEN;
+
+static_assert(HIDDEN % 16 == 0, "Kernels work on whole 256-bit vectors");
+
+void addColumn(int16_t* values, const int16_t* column) {
+#ifdef __AVX2__
+    for (int i = 0; i < HIDDEN; i += 16) {
+        __m256i sum = _mm256_add_epi16(
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values + i), sum);
+    }
+#else
+    for (int i = 0; i < HIDDEN; ++i) {
+        values[i] = static_cast<int16_t>(values[i] + column[i]);
+    }
+#endif
+}
+
+void subColumn(int16_t* values, const int16_t* column) {
+#ifdef __AVX2__
+    for (int i = 0; i < HIDDEN; i += 16) {
+        __m256i difference = _mm256_sub_epi16(
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values + i), difference);
+    }
+#else
+    for (int i = 0; i < HIDDEN; ++i) {
+        values[i] = static_cast<int16_t>(values[i] - column[i]);
+    }
+#endif
+}
+
+// sum_i weights[i] * (clamp(us[i]) - clamp(them[i])), activations clamped to [0, QA].
+int32_t outputDot(const int16_t* us, const int16_t* them, const int16_t* weights) {
+#ifdef __AVX2__
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ceiling = _mm256_set1_epi16(NnueNetwork::QA);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < HIDDEN; i += 16) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(us + i));
+        __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(them + i));
+        a = _mm256_min_epi16(_mm256_max_epi16(a, zero), ceiling);
+        b = _mm256_min_epi16(_mm256_max_epi16(b, zero), ceiling);
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_sub_epi16(a, b), w));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < HIDDEN; ++i) {
+        int a = std::min<int>(std::max<int>(us[i], 0), NnueNetwork::QA);
+        int b = std::min<int>(std::max<int>(them[i], 0), NnueNetwork::QA);
+        sum += (a - b) * weights[i];
+    }
+    return sum;
+#endif
+}
+
+int16_t quantize(float value, float scale, float limit) {
+    float clamped = std::min(std::max(value, -limit), limit);
+    return static_cast<int16_t>(std::lround(clamped * scale));
+}
+
+} // namespace
+
+void NnueAccumulator::refresh(const NnueNetwork& network, const SparseBoard& board,
+                              int originX, int originY) {
+    originX_ = originX;
+    originY_ = originY;
+    std::memcpy(values_[0], network.inputBias_.data(), sizeof(values_[0]));
+    std::memcpy(values_[1], network.inputBias_.data(), sizeof(values_[1]));
+    
+    auto occupied = board.getOccupiedPositions();
+    for (int i = 0; i < occupied.GetLength(); ++i) {
+        const auto& pos = occupied.Get(i);
+        add(network, pos.x, pos.y, board.at(pos.x, pos.y));
+    }
+}
+
+void NnueAccumulator::add(const NnueNetwork& network, int x, int y, Player player) {
+    int own = NnueNetwork::featureIndex(x - originX_, y - originY_, true);
+    if (own < 0) {
+        return;
+    }
+    int other = own + NnueNetwork::CELLS;
+    addColumn(values_[0], network.column(player == Player::X ? own : other));
+    addColumn(values_[1], network.column(player == Player::O ? own : other));
+}
+
+void NnueAccumulator::remove(const NnueNetwork& network, int x, int y, Player player) {
+    int own = NnueNetwork::featureIndex(x - originX_, y - originY_, true);
+    if (own < 0) {
+        return;
+    }
+    int other = own + NnueNetwork::CELLS;
+    subColumn(values_[0], network.column(player == Player::X ? own : other));
+    subColumn(values_[1], network.column(player == Player::O ? own : other));
+}
+
+NnueNetwork::NnueNetwork(int winLength)
+    : winLength_(winLength),
+      inputWeights_(static_cast<size_t>(FEATURES) * HIDDEN, 0),
+      inputBias_(HIDDEN, 0),
+      outputWeights_(HIDDEN, 0) {
+}
+
+NnueNetwork NnueNetwork::fromFloat(int winLength, const std::vector<float>& inputWeights,
+                                   const std::vector<float>& inputBias,
+                                   const std::vector<float>& outputWeights) {
+    NnueNetwork network(winLength);
+    for (size_t i = 0; i < network.inputWeights_.size() && i < inputWeights.size(); ++i) {
+        network.inputWeights_[i] = quantize(inputWeights[i], QA, MAX_INPUT_WEIGHT);
+    }
+    for (int i = 0; i < HIDDEN && i < static_cast<int>(inputBias.size()); ++i) {
+        network.inputBias_[i] = quantize(inputBias[i], QA, MAX_INPUT_WEIGHT);
+    }
+    for (int i = 0; i < HIDDEN && i < static_cast<int>(outputWeights.size()); ++i) {
+        network.outputWeights_[i] = quantize(outputWeights[i], QB, MAX_OUTPUT_WEIGHT);
+    }
+    return network;
+}
+
+int NnueNetwork::evaluate(const NnueAccumulator& accumulator, Player player) const {
+    Player opponent = (player == Player::X) ? Player::O : Player::X;
+    int64_t dot = outputDot(accumulator.values(player), accumulator.values(opponent),
+                            outputWeights_.data());
+    return static_cast<int>(dot * SCORE_SCALE / (QA * QB));
+}
+
+bool NnueNetwork::read(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    NnueHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    if (std::memcmp(header.magic, NNUE_MAGIC, sizeof(NNUE_MAGIC)) != 0 ||
+        header.version != FORMAT_VERSION || header.window != WINDOW || header.hidden != HIDDEN) {
+        return false;
+    }
+    
+    NnueNetwork network(static_cast<int>(header.winLength));
+    in.read(reinterpret_cast<char*>(network.inputWeights_.data()),
+            static_cast<std::streamsize>(network.inputWeights_.size() * sizeof(int16_t)));
+    in.read(reinterpret_cast<char*>(network.inputBias_.data()),
+            static_cast<std::streamsize>(network.inputBias_.size() * sizeof(int16_t)));
+    in.read(reinterpret_cast<char*>(network.outputWeights_.data()),
+            static_cast<std::streamsize>(network.outputWeights_.size() * sizeof(int16_t)));
+    if (!in) {
+        return false;
+    }
+    *this = std::move(network);
+    return true;
+}
+
+bool NnueNetwork::write(const std::string& path) const {
+    NnueHeader header;
+    std::memcpy(header.magic, NNUE_MAGIC, sizeof(NNUE_MAGIC));
+    header.version = FORMAT_VERSION;
+    header.winLength = static_cast<uint32_t>(winLength_);
+    header.window = WINDOW;
+    header.hidden = HIDDEN;
+    header.reserved = 0;
+    
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(inputWeights_.data()),
+              static_cast<std::streamsize>(inputWeights_.size() * sizeof(int16_t)));
+    out.write(reinterpret_cast<const char*>(inputBias_.data()),
+              static_cast<std::streamsize>(inputBias_.size() * sizeof(int16_t)));
+    out.write(reinterpret_cast<const char*>(outputWeights_.data()),
+              static_cast<std::streamsize>(outputWeights_.size() * sizeof(int16_t)));
+    return static_cast<bool>(out);
+}
+
+std::shared_ptr<const NnueNetwork> NnueNetwork::forWinLength(int winLength) {
+    std::lock_guard<std::mutex> lock(g_installed_mutex);
+    auto it = g_installed.find(winLength);
+    return it != g_installed.end() ? it->second : nullptr;
+}
+
+void NnueNetwork::install(std::shared_ptr<const NnueNetwork> network) {
+    std::lock_guard<std::mutex> lock(g_installed_mutex);
+    int winLength = network->getWinLength();
+    g_installed[winLength] = std::move(network);
+}
+
+void NnueNetwork::clearInstalled() {
+    std::lock_guard<std::mutex> lock(g_installed_mutex);
+    g_installed.clear();
+}
+
+bool NnueNetwork::load(const std::string& path) {
+    auto network = std::make_shared<NnueNetwork>();
+    if (!network->read(path)) {
+        return false;
+    }
+    install(std::move(network));
+    return true;
+}
+
+} // namespace tictactoe
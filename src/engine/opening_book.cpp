@@ -0,0 +1,193 @@
+#include "engine/opening_book.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace tictactoe {
+
+namespace {
+
+const char BOOK_MAGIC[8] = {'T', 'T', 'T', 'B', 'O', 'O', 'K', '\0'};
+
+struct BookHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t winLength;
+    uint32_t maxPly;
+    uint32_t reserved;
+    uint64_t entryCount;
+};
+
+static_assert(sizeof(BookHeader) == 32, "BookHeader is stored verbatim on disk");
+
+const uint64_t O_TO_MOVE = 0x6A09E667F3BCC909ULL;
+
+uint64_t mixStone(int x, int y, Player player) {
+    uint64_t z = (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 34) |
+                 (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 2) |
+                 static_cast<uint64_t>(player);
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Transforms 0-3 rotate by 90 degrees each; 4-7 additionally mirror x.
+Position applyTransform(int transform, int x, int y) {
+    int tx = x;
+    int ty = y;
+    switch (transform & 3) {
+        case 1: tx = -y; ty = x; break;
+        case 2: tx = -x; ty = -y; break;
+        case 3: tx = y; ty = -x; break;
+        default: break;
+    }
+    if (transform & 4) {
+        tx = -tx;
+    }
+    return Position(tx, ty);
+}
+
+Position invertTransform(int transform, int x, int y) {
+    if (transform & 4) {
+        x = -x;
+    }
+    switch (transform & 3) {
+        case 1: return Position(y, -x);
+        case 2: return Position(-x, -y);
+        case 3: return Position(-y, x);
+        default: return Position(x, y);
+    }
+}
+
+} // namespace
+
+CanonicalPosition::CanonicalPosition(const SparseBoard& board, Player toMove)
+    : key_(std::numeric_limits<uint64_t>::max()), transform_(0), offsetX_(0), offsetY_(0) {
+    auto history = board.getMoveHistory();
+    uint64_t sideKey = (toMove == Player::O) ? O_TO_MOVE : 0;
+    if (history.Empty()) {
+        key_ = sideKey;
+        return;
+    }
+    
+    for (int transform = 0; transform < 8; ++transform) {
+        int minX = std::numeric_limits<int>::max();
+        int minY = std::numeric_limits<int>::max();
+        for (int i = 0; i < history.GetLength(); ++i) {
+            const auto& move = history.Get(i);
+            Position p = applyTransform(transform, move.x, move.y);
+            minX = std::min(minX, p.x);
+            minY = std::min(minY, p.y);
+        }
+        
+        uint64_t key = sideKey;
+        for (int i = 0; i < history.GetLength(); ++i) {
+            const auto& move = history.Get(i);
+            Position p = applyTransform(transform, move.x, move.y);
+            key ^= mixStone(p.x - minX, p.y - minY, move.player);
+        }
+        
+        if (key < key_) {
+            key_ = key;
+            transform_ = transform;
+            offsetX_ = minX;
+            offsetY_ = minY;
+        }
+    }
+}
+
+Position CanonicalPosition::toCanonical(int x, int y) const {
+    Position p = applyTransform(transform_, x, y);
+    return Position(p.x - offsetX_, p.y - offsetY_);
+}
+
+Position CanonicalPosition::fromCanonical(int x, int y) const {
+    return invertTransform(transform_, x + offsetX_, y + offsetY_);
+}
+
+bool OpeningBook::open(const std::string& path) {
+    close();
+    if (!file_.open(path) || file_.size() < sizeof(BookHeader)) {
+        file_.close();
+        return false;
+    }
+    
+    BookHeader header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    uint64_t available = (file_.size() - sizeof(BookHeader)) / sizeof(BookEntry);
+    if (std::memcmp(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0 ||
+        header.version != FORMAT_VERSION || header.entryCount > available) {
+        file_.close();
+        return false;
+    }
+    
+    entries_ = reinterpret_cast<const BookEntry*>(file_.data() + sizeof(BookHeader));
+    count_ = static_cast<size_t>(header.entryCount);
+    winLength_ = static_cast<int>(header.winLength);
+    maxPly_ = static_cast<int>(header.maxPly);
+    return true;
+}
+
+void OpeningBook::close() {
+    file_.close();
+    entries_ = nullptr;
+    count_ = 0;
+    winLength_ = 0;
+    maxPly_ = 0;
+}
+
+std::optional<Move> OpeningBook::probe(const SparseBoard& board, Player toMove) const {
+    if (!isOpen() || board.getWinLength() != winLength_) {
+        return std::nullopt;
+    }
+    
+    CanonicalPosition canonical(board, toMove);
+    uint64_t key = canonical.getKey();
+    const BookEntry* end = entries_ + count_;
+    const BookEntry* it = std::lower_bound(entries_, end, key,
+        [](const BookEntry& entry, uint64_t k) { return entry.key < k; });
+    
+    std::optional<Move> best;
+    uint32_t bestWeight = 0;
+    for (; it != end && it->key == key; ++it) {
+        Position p = canonical.fromCanonical(it->x, it->y);
+        if (!board.isEmpty(p.x, p.y)) {
+            continue;
+        }
+        if (!best.has_value() || it->weight > bestWeight ||
+            (it->weight == bestWeight && it->score > best->score)) {
+            best = Move(p.x, p.y, it->score);
+            bestWeight = it->weight;
+        }
+    }
+    return best;
+}
+
+bool OpeningBook::write(const std::string& path, int winLength, int maxPly,
+                        std::vector<BookEntry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) {
+        if (a.key != b.key) return a.key < b.key;
+        return a.weight > b.weight;
+    });
+    
+    BookHeader header;
+    std::memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.version = FORMAT_VERSION;
+    header.winLength = static_cast<uint32_t>(winLength);
+    header.maxPly = static_cast<uint32_t>(maxPly);
+    header.reserved = 0;
+    header.entryCount = entries.size();
+    
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(BookEntry)));
+    return static_cast<bool>(out);
+}
+
+} // namespace tictactoe
@@ -6,9 +6,39 @@
 namespace tictactoe {
 
 SearchEngine::SearchEngine(int win_length)
+    : SearchEngine(win_length, SearchOptions()) {
+}
+
+SearchEngine::SearchEngine(int win_length, const SearchOptions& options)
     : moveGen_(win_length), evaluator_(win_length), 
-      threatSolver_(win_length), tt_(Config::TT_SIZE_MB),
-      win_length_(win_length), timeout_(false) {
+      threatSolver_(win_length), tt_(Config::TT_SIZE_MB), evalCache_(Config::EVAL_CACHE_MB),
+      network_(options.useNnue ? NnueNetwork::forWinLength(win_length) : nullptr),
+      networkOriginX_(0), networkOriginY_(0), networkOriginSet_(false),
+      options_(options), book_(nullptr),
+      win_length_(win_length), timeout_(false), timeLimitMs_(Config::DEFAULT_TIME_MS),
+      pool_(nullptr), helperNodes_(0), previousPvLength_(0) {
+    moveGen_.setCandidateLimits(options_.topKCandidates, options_.candidateRadius);
+    setThreadPool(&ThreadPool::shared());
+}
+
+void SearchEngine::setThreadPool(ThreadPool* pool) {
+    if (options_.parallelRootScoring) {
+        moveGen_.setScoringPool(pool);
+    }
+    if (options_.parallelThreatSolver) {
+        threatSolver_.setThreadPool(pool);
+    }
+    if (options_.parallelSearch) {
+        pool_ = pool;
+    }
+}
+
+bool SearchEngine::checkTimeout(const SearchContext& ctx) {
+    if (!timeout_.load(std::memory_order_relaxed) && (ctx.nodes % TIME_CHECK_INTERVAL) == 0 &&
+        timer_.isTimeout(timeLimitMs_)) {
+        timeout_ = true;
+    }
+    return isStopped(ctx);
 }
 
 std::optional<Move> SearchEngine::checkImmediateWin(
@@ -26,7 +56,71 @@ std::optional<Move> SearchEngine::checkDangerousThreat(
     return moveGen_.checkDangerousThreat(board, player);
 }
 
-int SearchEngine::evaluateTerminal(const SparseBoard& board, Player player) {
+void SearchEngine::makeMove(SearchContext& ctx, SparseBoard& board, const Move& move, Player player) {
+    board.makeMove(move.x, move.y, player);
+    if (network_) {
+        ctx.nnue.add(*network_, move.x, move.y, player);
+    }
+}
+
+void SearchEngine::undoMove(SearchContext& ctx, SparseBoard& board, const Move& move, Player player) {
+    board.undoMove(move.x, move.y);
+    if (network_) {
+        ctx.nnue.remove(*network_, move.x, move.y, player);
+    }
+}
+
+// The network sees a fixed crop of the board, so its window only moves
+// when the stones come close to its edge; evaluations cached for the old
+// window are dropped then.
+void SearchEngine::placeNetworkWindow(const SparseBoard& board) {
+    auto occupied = board.getOccupiedPositions();
+    if (occupied.Empty()) {
+        return;
+    }
+    
+    int minX = occupied.Get(0).x, maxX = minX;
+    int minY = occupied.Get(0).y, maxY = minY;
+    for (int i = 1; i < occupied.GetLength(); ++i) {
+        const auto& pos = occupied.Get(i);
+        minX = std::min(minX, pos.x);
+        maxX = std::max(maxX, pos.x);
+        minY = std::min(minY, pos.y);
+        maxY = std::max(maxY, pos.y);
+    }
+    
+    int reach = NnueNetwork::RADIUS - NETWORK_WINDOW_MARGIN;
+    if (networkOriginSet_ &&
+        minX >= networkOriginX_ - reach && maxX <= networkOriginX_ + reach &&
+        minY >= networkOriginY_ - reach && maxY <= networkOriginY_ + reach) {
+        return;
+    }
+    
+    int originX = minX + (maxX - minX) / 2;
+    int originY = minY + (maxY - minY) / 2;
+    if (!networkOriginSet_ || originX != networkOriginX_ || originY != networkOriginY_) {
+        evalCache_.clear();
+    }
+    networkOriginX_ = originX;
+    networkOriginY_ = originY;
+    networkOriginSet_ = true;
+}
+
+int SearchEngine::evaluate(SearchContext& ctx, const SparseBoard& board, Player player) {
+    uint64_t hash = board.getZobristHash();
+    int score;
+    if (evalCache_.probe(hash, player, score)) {
+        ctx.evalHits++;
+        return score;
+    }
+    ctx.evalMisses++;
+    score = network_ ? network_->evaluate(ctx.nnue, player)
+                     : evaluator_.evaluatePosition(board, player);
+    evalCache_.store(hash, player, score);
+    return score;
+}
+
+int SearchEngine::evaluateTerminal(SearchContext& ctx, const SparseBoard& board, Player player) {
     auto history = board.getMoveHistory();
     if (!history.Empty()) {
         const auto& lastMove = history.Back();
@@ -38,7 +132,7 @@ int SearchEngine::evaluateTerminal(const SparseBoard& board, Player player) {
             }
         }
     }
-    return evaluator_.evaluatePosition(board, player);
+    return evaluate(ctx, board, player);
 }
 
 bool SearchEngine::hasThreats(const SparseBoard& board, Player player) {
@@ -72,7 +166,7 @@ bool SearchEngine::hasThreats(const SparseBoard& board, Player player) {
     return false;
 }
 
-void SearchEngine::orderMoves(adt::ArraySequence<Move>& moves, 
+void SearchEngine::orderMoves(MoveList& moves, 
                                const std::optional<Move>& pvMove) {
     if (pvMove.has_value()) {
         int pvIndex = -1;
@@ -82,65 +176,64 @@ void SearchEngine::orderMoves(adt::ArraySequence<Move>& moves,
                 break;
             }
         }
-        if (pvIndex >= 0 && pvIndex > 0) {
-            Move temp = moves.Get(0);
-            moves.Set(0, moves.Get(pvIndex));
-            moves.Set(pvIndex, temp);
-        }
-    }
-    
-    if (pvMove.has_value() && moves.GetLength() > 1) {
-        adt::ArraySequence<Move> rest;
-        for (int i = 1; i < moves.GetLength(); ++i) {
-            rest.AppendInPlace(moves.Get(i));
+        if (pvIndex > 0) {
+            moves.Swap(0, pvIndex);
         }
-        rest.SortInPlace();
-        for (int i = 1; i < moves.GetLength(); ++i) {
-            moves.Set(i, rest.Get(i - 1));
+        if (pvIndex >= 0) {
+            // The PV move stays in front; everything behind it is ordered by score.
+            moves.SortInPlace(moves.GetLength() > 1 ? 1 : 0);
+            return;
         }
-    } else {
-        moves.SortInPlace();
     }
+    
+    moves.SortInPlace(0);
 }
 
-int SearchEngine::quiescence(SparseBoard& board, int alpha, int beta, 
+int SearchEngine::quiescence(SearchContext& ctx, SparseBoard& board, int alpha, int beta, 
                              Player player, int depth) {
-    stats_.nodes_searched_++;
+    adt::Arena::Scope scope;
+    ctx.nodes++;
+    ENGINE_STAT(ctx.counters.quiescence_nodes++);
     
-    if (timeout_ || depth > 4) {
-        return evaluator_.evaluatePosition(board, player);
+    if (checkTimeout(ctx) || depth > 4) {
+        return evaluate(ctx, board, player);
     }
     
     if (board.isTerminal()) {
-        return evaluateTerminal(board, player);
+        return evaluateTerminal(ctx, board, player);
     }
     
-    int standPat = evaluator_.evaluatePosition(board, player);
-    
-    if (standPat >= beta) {
-        return beta;
-    }
-    
-    if (standPat > alpha) {
-        alpha = standPat;
-    }
+    auto tacticalMoves = moveGen_.generateTactical(board, player);
+    
+    // Facing a win threat there is no standing pat: only the blocks are
+    // searched, and like check evasions they do not use up depth.
+    bool forced = !tacticalMoves.Empty() &&
+        MoveGenerator::threatClass(tacticalMoves.Get(0)) == ThreatClass::BLOCK_WIN;
+    if (forced) {
+        int blocks = 1;
+        while (blocks < tacticalMoves.GetLength() &&
+               MoveGenerator::threatClass(tacticalMoves.Get(blocks)) == ThreatClass::BLOCK_WIN) {
+            blocks++;
+        }
+        tacticalMoves.Resize(blocks);
+    } else {
+        int standPat = evaluate(ctx, board, player);
     
-    auto candidates = moveGen_.generateCandidates(board, player);
+        if (standPat >= beta) {
+            return beta;
+        }
     
-    adt::ArraySequence<Move> tacticalMoves;
-    for (int i = 0; i < candidates.GetLength(); ++i) {
-        const auto& move = candidates.Get(i);
-        if (std::abs(move.score) > 1000) {
-            tacticalMoves.AppendInPlace(move);
+        if (standPat > alpha) {
+            alpha = standPat;
         }
     }
     
     for (int i = 0; i < tacticalMoves.GetLength(); ++i) {
         const auto& move = tacticalMoves.Get(i);
-        board.makeMove(move.x, move.y, player);
+        makeMove(ctx, board, move, player);
         Player opponent = (player == Player::X) ? Player::O : Player::X;
-        int score = -quiescence(board, -beta, -alpha, opponent, depth + 1);
-        board.undoMove(move.x, move.y);
+        int score = -quiescence(ctx, board, -beta, -alpha, opponent, forced ? depth : depth + 1);
+        undoMove(ctx, board, move, player);
         
         if (score >= beta) {
             return beta;
@@ -153,35 +246,224 @@ int SearchEngine::quiescence(SparseBoard& board, int alpha, int beta,
     return alpha;
 }
 
-int SearchEngine::negamax(SparseBoard& board, int depth, int alpha, int beta,
-                         Player player, Move* pv, int pvIndex) {
-    stats_.nodes_searched_++;
+// Young Brothers Wait split point: the siblings after the eldest move,
+// searched by whichever threads claim them, sharing one alpha window.
+struct SearchEngine::SplitPoint {
+    const SplitPoint* parent;
+    int beta;
+    std::atomic<int> next;
+    std::atomic<bool> cutoff;
+    
+    std::mutex mutex;
+    int alpha;
+    int bestScore;
+    Move bestMove;
+    bool moveFound;
+    // The owner's table; an improving sibling's line goes into its row.
+    SearchEngine::PvTable& pv;
+    
+    SplitPoint(const SplitPoint* parent, int first, int alpha, int beta, int bestScore,
+               SearchEngine::PvTable& pv)
+        : parent(parent), beta(beta), next(first), cutoff(false), alpha(alpha),
+          bestScore(bestScore), bestMove(0, 0), moveFound(false), pv(pv) {}
+    
+    // A cutoff anywhere up the chain makes this subtree irrelevant.
+    bool isAborted() const {
+        for (const SplitPoint* split = this; split != nullptr; split = split->parent) {
+            if (split->cutoff.load(std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+bool SearchEngine::isStopped(const SearchContext& ctx) const {
+    return timeout_.load(std::memory_order_relaxed) ||
+           (ctx.split != nullptr && ctx.split->isAborted());
+}
+
+bool SearchEngine::canSplit(int depth, int remaining) const {
+    if (!options_.parallelSearch || depth < options_.splitMinDepth || remaining < 2) {
+        return false;
+    }
+    return options_.reproducibleSplits || (pool_ != nullptr && pool_->getThreadCount() > 0);
+}
+
+int SearchEngine::searchMove(SearchContext& ctx, SparseBoard& board, const Move& move,
+                             int moveIndex, int depth, int alpha, int beta, Player player,
+                             int ply) {
+    makeMove(ctx, board, move, player);
+    Player opponent = (player == Player::X) ? Player::O : Player::X;
     
-    if (timeout_) {
+    int reduction = 0;
+    if (options_.useLateMoveReductions && depth > 2) {
+        if (moveIndex > 3) reduction = 1;
+        if (moveIndex > 6 && depth > 4) reduction = 2;
+        if (moveIndex > 10 && depth > 6) reduction = 3;
+        
+        if (move.score < -1000) {
+            reduction += 1;
+        }
+        
+        reduction = std::min(reduction, depth - 1);
+    }
+    
+    int score = -negamax(ctx, board, depth - 1 - reduction, -beta, -alpha, 
+                        opponent, ply + 1);
+    
+    if (reduction > 0 && score > alpha) {
+        ENGINE_STAT(ctx.counters.lmr_researches++);
+        score = -negamax(ctx, board, depth - 1, -beta, -alpha, 
+                        opponent, ply + 1);
+    }
+    
+    undoMove(ctx, board, move, player);
+    return score;
+}
+
+void SearchEngine::searchSiblings(SearchContext& ctx, SplitPoint& split, SparseBoard& board,
+                                  const MoveList& moves, int depth, Player player, int ply) {
+    const SplitPoint* outer = ctx.split;
+    ctx.split = &split;
+    
+    for (;;) {
+        if (isStopped(ctx)) {
+            break;
+        }
+        int i = split.next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= moves.GetLength()) {
+            break;
+        }
+        
+        Move move = moves.Get(i);
+        if (!board.isEmpty(move.x, move.y)) {
+            continue;
+        }
+        
+        int alpha;
+        {
+            std::lock_guard<std::mutex> lock(split.mutex);
+            split.moveFound = true;
+            alpha = split.alpha;
+        }
+        
+        // Each sibling builds its line in this thread's table; only an
+        // improving one is copied out.
+        int score = searchMove(ctx, board, move, i, depth, alpha, split.beta, player, ply);
+        if (isStopped(ctx)) {
+            break;
+        }
+        
+        std::lock_guard<std::mutex> lock(split.mutex);
+        if (score > split.bestScore) {
+            split.bestScore = score;
+            split.bestMove = move;
+            split.pv.update(ply, move, ctx.pv);
+        }
+        split.alpha = std::max(split.alpha, score);
+        if (split.alpha >= split.beta) {
+            ENGINE_STAT(ctx.counters.recordCutoff(i));
+            split.cutoff.store(true, std::memory_order_relaxed);
+            break;
+        }
+    }
+    
+    ctx.split = outer;
+}
+
+void SearchEngine::mergeHelper(const SearchContext& helper) {
+    helperNodes_.fetch_add(helper.nodes, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(helperMutex_);
+    stats_.eval_cache_hits_ += helper.evalHits;
+    stats_.eval_cache_misses_ += helper.evalMisses;
+#ifdef ENGINE_INSTRUMENTATION
+    stats_.counters_.merge(helper.counters);
+#endif
+}
+
+void SearchEngine::splitSiblings(SearchContext& ctx, SplitPoint& split, SparseBoard& board,
+                                 const MoveList& moves, int depth, Player player, int ply) {
+    if (options_.reproducibleSplits) {
+        searchSiblings(ctx, split, board, moves, depth, player, ply);
+        return;
+    }
+    
+    // Helpers copy this snapshot, and the matching network accumulator,
+    // instead of the board the owner keeps playing moves on; it lives on
+    // the heap like the caller's board.
+    std::optional<SparseBoard> snapshot;
+    {
+        adt::Arena::Binding heap(nullptr);
+        snapshot.emplace(board);
+    }
+    const SparseBoard& shared = *snapshot;
+    const NnueAccumulator sharedNnue = ctx.nnue;
+    
+    TaskGroup helpers(*pool_);
+    int remaining = moves.GetLength() - split.next.load(std::memory_order_relaxed);
+    int helperCount = std::min(pool_->getThreadCount(), remaining - 1);
+    for (int h = 0; h < helperCount; ++h) {
+        helpers.run([this, &split, &shared, &sharedNnue, &moves, depth, player, ply] {
+            SearchContext helper;
+            helper.nnue = sharedNnue;
+            {
+                adt::Arena::Binding heap(nullptr);
+                SparseBoard local = shared;
+                adt::Arena::Binding arenaBinding(adt::Arena::forThread());
+                searchSiblings(helper, split, local, moves, depth, player, ply);
+            }
+            mergeHelper(helper);
+        }, TaskPriority::HIGH);
+    }
+    
+    searchSiblings(ctx, split, board, moves, depth, player, ply);
+    helpers.wait();
+}
+
+int SearchEngine::negamax(SearchContext& ctx, SparseBoard& board, int depth, int alpha, int beta, 
+                         Player player, int ply) {
+    adt::Arena::Scope scope;
+    ctx.nodes++;
+    ctx.pv.clear(ply);
+    bool followPv = ctx.followPv && ply < previousPvLength_;
+    ctx.followPv = false;
+    
+    if (checkTimeout(ctx)) {
         return 0;
     }
     
     uint64_t hash = board.getZobristHash();
     
     auto ttResult = tt_.probe(hash, depth, alpha, beta);
+    ENGINE_STAT(ctx.counters.tt_probes++);
+    ENGINE_STAT(ctx.counters.tt_hits += ttResult.isKeyMatch());
+    ENGINE_STAT(ctx.counters.tt_collisions += ttResult.isCollision());
     if (ttResult.isFound()) {
-        if (pv && pvIndex < 20) {
-            pv[pvIndex] = ttResult.getBestMove();
+        ENGINE_STAT(ctx.counters.tt_cutoffs++);
+        // The line ends in the stored move; what follows it is not known.
+        Move ttMove = ttResult.getBestMove();
+        if ((ttMove.x != 0 || ttMove.y != 0) && board.isEmpty(ttMove.x, ttMove.y)) {
+            ctx.pv.set(ply, ttMove);
         }
         return ttResult.getScore();
     }
     
     if (board.isTerminal() || depth == 0) {
-        int score = quiescence(board, alpha, beta, player);
+        if (!options_.useQuiescence) {
+            return evaluateTerminal(ctx, board, player);
+        }
+        int score = quiescence(ctx, board, alpha, beta, player);
         return score;
     }
     
-    auto moves = moveGen_.generateCandidates(board, player);
+    auto moves = moveGen_.generateCandidates(board, player, ply == 0);
+    ENGINE_STAT(ctx.counters.recordCandidates(moves.GetLength()));
     if (moves.Empty()) {
-        return evaluator_.evaluatePosition(board, player);
+        return evaluate(ctx, board, player);
     }
     
-    auto pvMove = tt_.getPVMove(hash);
+    auto pvMove = followPv ? std::optional<Move>(previousPv_[ply]) : tt_.getPVMove(hash);
     orderMoves(moves, pvMove);
     
     Move bestMove(0, 0);
@@ -189,7 +471,13 @@ int SearchEngine::negamax(SparseBoard& board, int depth, int alpha, int beta,
     TTFlag flag = TTFlag::UPPER_BOUND;
     bool moveFound = false;
     
-    for (int i = 0; i < moves.GetLength(); ++i) {
+    int i = 0;
+    for (; i < moves.GetLength(); ++i) {
+        // The eldest brother is searched alone; the rest may be split.
+        if (moveFound && canSplit(depth, moves.GetLength() - i)) {
+            break;
+        }
+        
         const auto& move = moves.Get(i);
         
         if (!board.isEmpty(move.x, move.y)) {
@@ -197,50 +485,40 @@ int SearchEngine::negamax(SparseBoard& board, int depth, int alpha, int beta,
         }
         
         moveFound = true;
-        board.makeMove(move.x, move.y, player);
-        Player opponent = (player == Player::X) ? Player::O : Player::X;
-        
-        int reduction = 0;
-        if (depth > 2) {
-            if (i > 3) reduction = 1;
-            if (i > 6 && depth > 4) reduction = 2;
-            if (i > 10 && depth > 6) reduction = 3;
-            
-            if (move.score < -1000) {
-                reduction += 1;
-            }
-            
-            reduction = std::min(reduction, depth - 1);
-        }
-        
-        int score = -negamax(board, depth - 1 - reduction, -beta, -alpha, 
-                            opponent, pv, pvIndex + 1);
-        
-        if (reduction > 0 && score > alpha) {
-            score = -negamax(board, depth - 1, -beta, -alpha, 
-                            opponent, pv, pvIndex + 1);
-        }
-        
-        board.undoMove(move.x, move.y);
+        ctx.followPv = followPv && move == previousPv_[ply];
+        int score = searchMove(ctx, board, move, i, depth, alpha, beta, player, ply);
+        ctx.followPv = false;
         
         if (score > bestScore) {
             bestScore = score;
             bestMove = move;
-            
-            if (pv && pvIndex < 20) {
-                pv[pvIndex] = move;
-            }
+            ctx.pv.update(ply, move, ctx.pv);
         }
         
         alpha = std::max(alpha, score);
         if (alpha >= beta) {
+            ENGINE_STAT(ctx.counters.recordCutoff(i));
             flag = TTFlag::LOWER_BOUND;
             break;
         }
     }
     
+    if (i < moves.GetLength() && alpha < beta && !isStopped(ctx)) {
+        SplitPoint split(ctx.split, i, alpha, beta, bestScore, ctx.pv);
+        splitSiblings(ctx, split, board, moves, depth, player, ply);
+        if (split.moveFound && split.bestScore > bestScore) {
+            bestScore = split.bestScore;
+            bestMove = split.bestMove;
+        }
+        alpha = std::max(alpha, split.alpha);
+    }
+    
+    if (isStopped(ctx)) {
+        return 0;
+    }
+    
     if (!moveFound) {
-        return evaluator_.evaluatePosition(board, player);
+        return evaluate(ctx, board, player);
     }
     
     if (bestScore <= alpha) {
@@ -256,15 +534,73 @@ int SearchEngine::negamax(SparseBoard& board, int depth, int alpha, int beta,
     return bestScore;
 }
 
-Move SearchEngine::findBestMove(SparseBoard& board, Player player, int timeMs) {
+void SearchEngine::setTranspositionSnapshot(const TTSnapshot* snapshot) {
+    if (snapshot != nullptr && snapshot->getWinLength() != win_length_) {
+        snapshot = nullptr;
+    }
+    tt_.setSnapshot(snapshot);
+}
+
+size_t SearchEngine::warmStartTT(const TTSnapshot& snapshot, int minDepth) {
+    if (snapshot.getWinLength() != win_length_) {
+        return 0;
+    }
+    return tt_.warmStart(snapshot, minDepth);
+}
+
+void SearchEngine::startSearch(int timeMs) {
     stats_ = SearchStats();
     timeout_ = false;
+    helperNodes_ = 0;
+    timeLimitMs_ = timeMs;
     timer_.reset();
+}
+
+void SearchEngine::startRoot(SearchContext& root, const SparseBoard& board) {
+    if (network_) {
+        placeNetworkWindow(board);
+        root.nnue.refresh(*network_, board, networkOriginX_, networkOriginY_);
+    }
+}
+
+void SearchEngine::finishSearch(const SearchContext& root) {
+    ENGINE_STAT(stats_.counters_.merge(root.counters));
+    stats_.eval_cache_hits_ += root.evalHits;
+    stats_.eval_cache_misses_ += root.evalMisses;
+    stats_.time_ms_ = timer_.elapsedMs();
+}
+
+Move SearchEngine::findBestMove(SparseBoard& board, Player player, int timeMs) {
+    adt::Arena::Binding arenaBinding(arena_);
+    startSearch(timeMs);
     
     auto history = board.getMoveHistory();
     int movesMade = history.GetLength();
     
-    auto winMove = checkImmediateWin(board, player);
+    if (book_ != nullptr && movesMade <= book_->getMaxPly()) {
+        auto bookMove = book_->probe(board, player);
+        if (bookMove.has_value()) {
+            stats_.time_ms_ = timer_.elapsedMs();
+            stats_.decision_type_ = DecisionType::OPENING_BOOK;
+            stats_.final_score_ = bookMove->score;
+            return *bookMove;
+        }
+    }
+    
+    std::optional<Move> winMove;
+    std::optional<Move> blockMove;
+    std::optional<Move> dangerousThreat;
+    {
+        ENGINE_PHASE(stats_.counters_.immediate_checks_us);
+        winMove = checkImmediateWin(board, player);
+        if (!winMove.has_value()) {
+            blockMove = checkImmediateBlock(board, player);
+        }
+        if (!winMove.has_value() && !blockMove.has_value()) {
+            dangerousThreat = checkDangerousThreat(board, player);
+        }
+    }
+    
     if (winMove.has_value()) {
         stats_.time_ms_ = timer_.elapsedMs();
         stats_.decision_type_ = DecisionType::IMMEDIATE_WIN;
@@ -272,7 +608,6 @@ Move SearchEngine::findBestMove(SparseBoard& board, Player player, int timeMs) {
         return *winMove;
     }
     
-    auto blockMove = checkImmediateBlock(board, player);
     if (blockMove.has_value()) {
         stats_.time_ms_ = timer_.elapsedMs();
         stats_.decision_type_ = DecisionType::IMMEDIATE_BLOCK;
@@ -280,7 +615,6 @@ Move SearchEngine::findBestMove(SparseBoard& board, Player player, int timeMs) {
         return *blockMove;
     }
     
-    auto dangerousThreat = checkDangerousThreat(board, player);
     if (dangerousThreat.has_value()) {
         stats_.time_ms_ = timer_.elapsedMs();
         stats_.decision_type_ = DecisionType::DANGEROUS_THREAT;
@@ -288,8 +622,19 @@ Move SearchEngine::findBestMove(SparseBoard& board, Player player, int timeMs) {
         return *dangerousThreat;
     }
     
-    if (movesMade >= 4 && hasThreats(board, player)) {
-        auto forcedMove = threatSolver_.findForcedWin(board, player, Config::THREAT_SOLVER_MAX_DEPTH);
+    bool threatsPresent = false;
+    if (options_.useThreatSolver && movesMade >= 4) {
+        ENGINE_PHASE(stats_.counters_.has_threats_us);
+        threatsPresent = hasThreats(board, player);
+    }
+    
+    if (threatsPresent) {
+        std::optional<Move> forcedMove;
+        {
+            ENGINE_PHASE(stats_.counters_.threat_solver_us);
+            forcedMove = threatSolver_.findForcedWin(board, player, options_.threatSolverMaxDepth);
+        }
+        ENGINE_STAT(stats_.counters_.threat_solver_nodes = threatSolver_.getNodesSearched());
         if (forcedMove.has_value()) {
             stats_.time_ms_ = timer_.elapsedMs();
             stats_.decision_type_ = DecisionType::THREAT_SOLVER;
@@ -306,7 +651,12 @@ Move SearchEngine::findBestMove(SparseBoard& board, Player player, int timeMs) {
     int stableIterations = 0;
     bool bestMoveSet = false;
     
-    int maxDepth = Config::MAX_DEPTH;
+    SearchContext root;
+    startRoot(root, board);
+    setPreviousPv(nullptr, 0);
+    auto rootMoves = makeRootMoves(board, player);
+    
+    int maxDepth = options_.maxDepth;
     if (movesMade < 6) {
         maxDepth = std::min(maxDepth, 6);
     } else if (movesMade < 12) {
@@ -319,26 +669,46 @@ Move SearchEngine::findBestMove(SparseBoard& board, Player player, int timeMs) {
             break;
         }
         
-        Move pv[20];
-        for (int i = 0; i < 20; ++i) {
-            pv[i] = Move(0, 0);
+        for (auto& rootMove : rootMoves) {
+            rootMove.exact = false;
+            rootMove.nodes = 0;
         }
+        int iterationStart = root.nodes + helperNodes_.load(std::memory_order_relaxed);
         
-        int bestScore = negamax(board, depth, 
-                std::numeric_limits<int>::min(),
-                std::numeric_limits<int>::max(),
-                player, pv, 0);
+        int bestScore;
+        {
+            ENGINE_PHASE(stats_.counters_.negamax_us);
+            root.followPv = true;
+            bestScore = searchRoot(root, board, depth, player, rootMoves, {});
+        }
+        stats_.nodes_searched_ = root.nodes + helperNodes_.load(std::memory_order_relaxed);
         
-        if (!timeout_ && board.isEmpty(pv[0].x, pv[0].y)) {
-            bestMove = pv[0];
+        if (!timeout_ && root.pv.length[0] > 0) {
+            const Move* line = root.pv.moves[0];
+            bestMove = line[0];
             bestMoveSet = true;
             stats_.depth_reached_ = depth;
             
-            stats_.pv_length_ = 0;
-            for (int i = 0; i < depth && i < 20; ++i) {
-                if (pv[i].x == 0 && pv[i].y == 0) break;
-                stats_.principal_variation_[i] = pv[i];
-                stats_.pv_length_++;
+            stats_.pv_length_ = root.pv.length[0];
+            for (int i = 0; i < stats_.pv_length_; ++i) {
+                stats_.principal_variation_[i] = line[i];
+            }
+            setPreviousPv(line, root.pv.length[0]);
+            sortRootMoves(rootMoves);
+            
+            if (rootMoves.size() == 1) {
+                break;
+            }
+            
+            // Every other move was refuted cheaply while the best one kept
+            // its place: little is left to find, so the time is better saved.
+            int iterationNodes = stats_.nodes_searched_ - iterationStart;
+            bool easyMove = depth >= 3 && bestMove == previousBestMove &&
+                static_cast<int64_t>(rootMoves[0].nodes) * 100 >=
+                    static_cast<int64_t>(iterationNodes) * Config::EASY_MOVE_NODE_PERCENT;
+            if (easyMove &&
+                static_cast<int64_t>(timer_.elapsedMs()) * Config::EASY_MOVE_TIME_DIVISOR >= timeMs) {
+                break;
             }
             
             if (depth >= 3) {
@@ -361,7 +731,7 @@ Move SearchEngine::findBestMove(SparseBoard& board, Player player, int timeMs) {
         tt_.incrementAge();
     }
     
-    stats_.time_ms_ = timer_.elapsedMs();
+    finishSearch(root);
     stats_.final_score_ = previousBestScore;
     
     if (bestMoveSet && board.isEmpty(bestMove.x, bestMove.y)) {
@@ -398,5 +768,191 @@ Move SearchEngine::findBestMove(SparseBoard& board, Player player, int timeMs) {
     return Move(0, 0, 0);
 }
 
+std::vector<SearchEngine::RootMove> SearchEngine::makeRootMoves(SparseBoard& board, Player player) {
+    adt::Arena::Scope scope;
+    auto moves = moveGen_.generateCandidates(board, player, true);
+    orderMoves(moves, tt_.getPVMove(board.getZobristHash()));
+    
+    std::vector<RootMove> rootMoves;
+    rootMoves.reserve(moves.GetLength());
+    for (int i = 0; i < moves.GetLength(); ++i) {
+        const auto& move = moves.Get(i);
+        if (board.isEmpty(move.x, move.y)) {
+            RootMove rootMove;
+            rootMove.move = move;
+            rootMoves.push_back(rootMove);
+        }
+    }
+    return rootMoves;
+}
+
+// Exact scores first, best first; they include the best move. A move
+// that failed low only has a bound, so the rest keep the generator's
+// order, which also decides the root reductions, and among equal
+// candidates the one that took more nodes to refute goes first.
+void SearchEngine::sortRootMoves(std::vector<RootMove>& rootMoves) {
+    std::stable_sort(rootMoves.begin(), rootMoves.end(), [](const RootMove& a, const RootMove& b) {
+        if (a.exact != b.exact) {
+            return a.exact;
+        }
+        if (a.exact) {
+            return a.score > b.score;
+        }
+        if (a.move.score != b.move.score) {
+            return a.move.score > b.move.score;
+        }
+        return a.nodes > b.nodes;
+    });
+}
+
+// One pass over the root moves with a full window: the best move outside
+// excluded, with its line left in row 0 of ctx.pv, and every searched
+// move's score and subtree size recorded in rootMoves. The root itself
+// is neither probed in nor, except for an unrestricted pass, stored to
+// the transposition table, since a restricted root score is not the
+// position's value.
+int SearchEngine::searchRoot(SearchContext& ctx, SparseBoard& board, int depth, Player player,
+                             std::vector<RootMove>& rootMoves, const std::vector<Move>& excluded) {
+    ctx.nodes++;
+    ctx.pv.clear(0);
+    bool followPv = ctx.followPv && previousPvLength_ > 0;
+    ctx.followPv = false;
+    
+    int alpha = -std::numeric_limits<int>::max();
+    int beta = std::numeric_limits<int>::max();
+    int bestScore = std::numeric_limits<int>::min();
+    
+    for (int i = 0; i < static_cast<int>(rootMoves.size()); ++i) {
+        RootMove& rootMove = rootMoves[i];
+        const Move& move = rootMove.move;
+        if (std::find(excluded.begin(), excluded.end(), move) != excluded.end()) {
+            continue;
+        }
+        
+        int before = ctx.nodes + helperNodes_.load(std::memory_order_relaxed);
+        ctx.followPv = followPv && move == previousPv_[0];
+        int score = searchMove(ctx, board, move, i, depth, alpha, beta, player, 0);
+        ctx.followPv = false;
+        if (isStopped(ctx)) {
+            break;
+        }
+        
+        rootMove.nodes += ctx.nodes + helperNodes_.load(std::memory_order_relaxed) - before;
+        rootMove.score = score;
+        rootMove.exact = score > alpha;
+        if (score > bestScore) {
+            bestScore = score;
+            ctx.pv.update(0, move, ctx.pv);
+        }
+        alpha = std::max(alpha, score);
+    }
+    
+    if (excluded.empty() && bestScore != std::numeric_limits<int>::min() && !isStopped(ctx)) {
+        tt_.store(board.getZobristHash(), bestScore, depth, TTFlag::EXACT, ctx.pv.moves[0][0]);
+    }
+    return bestScore;
+}
+
+void SearchEngine::setPreviousPv(const Move* line, int length) {
+    previousPvLength_ = std::min(length, MAX_PLY);
+    for (int i = 0; i < previousPvLength_; ++i) {
+        previousPv_[i] = line[i];
+    }
+}
+
+std::vector<AnalysisLine> SearchEngine::analyze(SparseBoard& board, Player player, int multiPv,
+                                                int timeMs, const AnalysisCallback& onInfo) {
+    adt::Arena::Binding arenaBinding(arena_);
+    startSearch(timeMs);
+    stats_.decision_type_ = DecisionType::NEGAMAX_SEARCH;
+    
+    SearchContext root;
+    startRoot(root, board);
+    auto rootMoves = makeRootMoves(board, player);
+    multiPv = std::max(1, multiPv);
+    std::vector<AnalysisLine> lines;
+    
+    for (int depth = 1; depth <= options_.maxDepth; ++depth) {
+        if (timeout_ || timer_.isTimeout(timeMs)) {
+            timeout_ = true;
+            break;
+        }
+        
+        for (auto& rootMove : rootMoves) {
+            rootMove.exact = false;
+            rootMove.nodes = 0;
+        }
+        std::vector<AnalysisLine> iteration;
+        std::vector<Move> excluded;
+        while (static_cast<int>(iteration.size()) < multiPv) {
+            // Each pass follows the best line of the last iteration that
+            // starts with a move it may still play.
+            setPreviousPv(nullptr, 0);
+            for (const auto& previous : lines) {
+                if (std::find(excluded.begin(), excluded.end(), previous.move) == excluded.end()) {
+                    setPreviousPv(previous.pv.data(), static_cast<int>(previous.pv.size()));
+                    break;
+                }
+            }
+            
+            int score;
+            {
+                ENGINE_PHASE(stats_.counters_.negamax_us);
+                root.followPv = true;
+                score = searchRoot(root, board, depth, player, rootMoves, excluded);
+            }
+            if (timeout_ || score == std::numeric_limits<int>::min()) {
+                break;
+            }
+            
+            const Move* pv = root.pv.moves[0];
+            AnalysisLine line;
+            line.move = pv[0];
+            line.move.score = score;
+            line.score = score;
+            line.depth = depth;
+            line.pv.assign(pv, pv + root.pv.length[0]);
+            iteration.push_back(line);
+            excluded.push_back(pv[0]);
+        }
+        stats_.nodes_searched_ = root.nodes + helperNodes_.load(std::memory_order_relaxed);
+        
+        if (timeout_ || iteration.empty()) {
+            break;
+        }
+        
+        // Later passes search with a fresh window, so a move found later
+        // can still outscore an earlier one.
+        std::stable_sort(iteration.begin(), iteration.end(),
+            [](const AnalysisLine& a, const AnalysisLine& b) { return a.score > b.score; });
+        lines = std::move(iteration);
+        sortRootMoves(rootMoves);
+        
+        const AnalysisLine& best = lines.front();
+        stats_.depth_reached_ = depth;
+        stats_.final_score_ = best.score;
+        stats_.pv_length_ = static_cast<int>(best.pv.size());
+        for (int i = 0; i < stats_.pv_length_; ++i) {
+            stats_.principal_variation_[i] = best.pv[i];
+        }
+        
+        if (onInfo) {
+            AnalysisInfo info;
+            info.depth = depth;
+            info.nodes = stats_.nodes_searched_;
+            info.timeMs = timer_.elapsedMs();
+            info.nodesPerSecond = static_cast<int>(
+                static_cast<int64_t>(info.nodes) * 1000 / std::max(1, info.timeMs));
+            info.lines = lines;
+            onInfo(info);
+        }
+        
+        tt_.incrementAge();
+    }
+    
+    finishSearch(root);
+    return lines;
+}
+
 } // namespace tictactoe
 
@@ -0,0 +1,89 @@
+#include "engine/solver_cache.h"
+
+namespace tictactoe {
+
+SolverCache::SolverCache(size_t sizeMB) {
+    size_t targetSize = (sizeMB * 1024 * 1024) / sizeof(Slot);
+    
+    size_ = 1;
+    while (size_ < targetSize && size_ < (1ULL << 30)) {
+        size_ <<= 1;
+    }
+    if (size_ > 1) {
+        size_ >>= 1;
+    }
+    
+    table_ = new Slot[size_];
+    clear();
+}
+
+SolverCache::~SolverCache() {
+    delete[] table_;
+}
+
+void SolverCache::clear() {
+    for (size_t i = 0; i < size_; ++i) {
+        table_[i].check.store(0, std::memory_order_relaxed);
+        table_[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool SolverCache::load(uint64_t key, uint64_t& data) const {
+    const Slot& slot = table_[key & (size_ - 1)];
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    data = slot.data.load(std::memory_order_relaxed);
+    return data != 0 && (check ^ data) == key;
+}
+
+SolverCache::ProbeResult SolverCache::probe(uint64_t hash, Player attacker, int remaining) const {
+    ProbeResult result;
+    uint64_t data;
+    if (!load(slotKey(hash, attacker), data)) {
+        return result;
+    }
+    
+    int stored = static_cast<int>((data >> REMAINING_SHIFT) & 0xff);
+    auto kind = static_cast<SolverResult>((data >> RESULT_SHIFT) & 3);
+    if ((kind == SolverResult::WIN && stored <= remaining) ||
+        (kind == SolverResult::NO_WIN && stored >= remaining)) {
+        result.result_ = kind;
+        result.remaining_ = stored;
+        result.hasThreat_ = (data & HAS_THREAT) != 0;
+        result.threat_ = PackedMove::fromRaw(static_cast<uint32_t>(data)).toMove();
+    }
+    return result;
+}
+
+void SolverCache::store(uint64_t hash, Player attacker, int remaining, bool win,
+                        const std::optional<Move>& threat) {
+    uint64_t key = slotKey(hash, attacker);
+    
+    // The same position keeps whichever answer covers more: any win beats
+    // a refutation, a shallower win a deeper one, a deeper refutation a
+    // shallower one.
+    uint64_t existing;
+    if (load(key, existing)) {
+        int stored = static_cast<int>((existing >> REMAINING_SHIFT) & 0xff);
+        auto kind = static_cast<SolverResult>((existing >> RESULT_SHIFT) & 3);
+        if (kind == SolverResult::WIN && (!win || stored <= remaining)) {
+            return;
+        }
+        if (kind == SolverResult::NO_WIN && !win && stored >= remaining) {
+            return;
+        }
+    }
+    
+    PackedMove packed = threat.has_value() ? PackedMove::fromMove(*threat) : PackedMove();
+    uint64_t data = packed.raw();
+    data |= static_cast<uint64_t>(remaining & 0xff) << REMAINING_SHIFT;
+    data |= static_cast<uint64_t>(win ? SolverResult::WIN : SolverResult::NO_WIN) << RESULT_SHIFT;
+    if (!packed.isNull()) {
+        data |= HAS_THREAT;
+    }
+    
+    Slot& slot = table_[key & (size_ - 1)];
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+} // namespace tictactoe
@@ -1,54 +1,38 @@
 #include "engine/threat_solver.h"
 #include "engine/evaluator.h"
 #include "board/sparse_board.h"
+#include "board/line_kernel.h"
 #include <algorithm>
+#include <memory>
 
 namespace tictactoe {
 
 ThreatSolver::ThreatSolver(int win_length) 
-    : moveGen_(win_length), win_length_(win_length) {
+    : moveGen_(win_length), win_length_(win_length), pool_(nullptr) {
 }
 
-bool ThreatSolver::isDirectThreat(const SparseBoard& board, int x, int y, Player player) {
-    SparseBoard testBoard = board;
-    if (!testBoard.makeMove(x, y, player)) {
+// Playing (x, y) leaves an open run of win length - 1 through it. The
+// cell is counted as the player's without being placed, so no board copy
+// is needed.
+template <int WinLength>
+bool ThreatSolver::isDirectThreat(const SparseBoard& board, int x, int y, Player player) const {
+    if (!board.isEmpty(x, y)) {
         return false;
     }
     
+    using Kernel = LineKernel<WinLength>;
+    const int winLength = Kernel::length(win_length_);
+    
     const Position directions[4] = {
         Position(1, 0), Position(0, 1), Position(1, 1), Position(1, -1)
     };
     
     for (int i = 0; i < 4; ++i) {
-        int count = 1;
-        
-        Position current(x, y);
-        current = current + directions[i];
-        int rightSpace = 0;
-        int maxIterations = 20;
-        int iterations = 0;
-        while (iterations < maxIterations && testBoard.at(current.x, current.y) == player) {
-            count++;
-            current = current + directions[i];
-            iterations++;
-        }
-        if (testBoard.at(current.x, current.y) == Player::None) {
-            rightSpace = 1;
-        }
-        
-        current = Position(x, y) - directions[i];
-        int leftSpace = 0;
-        iterations = 0;
-        while (iterations < maxIterations && testBoard.at(current.x, current.y) == player) {
-            count++;
-            current = current - directions[i];
-            iterations++;
-        }
-        if (testBoard.at(current.x, current.y) == Player::None) {
-            leftSpace = 1;
-        }
-        
-        if (count == win_length_ - 1 && leftSpace > 0 && rightSpace > 0) {
+        Position forward;
+        Position backward;
+        int count = Kernel::line(board, x, y, directions[i], player, winLength, forward, backward);
+        if (count == winLength - 1 && board.isEmpty(forward.x, forward.y) &&
+            board.isEmpty(backward.x, backward.y)) {
             return true;
         }
     }
@@ -56,28 +40,30 @@ bool ThreatSolver::isDirectThreat(const SparseBoard& board, int x, int y, Player
     return false;
 }
 
-adt::ArraySequence<Move> ThreatSolver::generateThreats(
+MoveList ThreatSolver::generateThreats(
     const SparseBoard& board, Player player) {
     
-    adt::ArraySequence<Move> threats;
+    MoveList threats;
     auto candidates = moveGen_.generateCandidates(board, player);
     
-    for (int i = 0; i < candidates.GetLength(); ++i) {
-        const auto& move = candidates.Get(i);
-        if (isDirectThreat(board, move.x, move.y, player)) {
-            threats.AppendInPlace(move);
+    dispatchWinLength(win_length_, [&](auto kernel) {
+        for (int i = 0; i < candidates.GetLength(); ++i) {
+            const auto& move = candidates.Get(i);
+            if (isDirectThreat<decltype(kernel)::value>(board, move.x, move.y, player)) {
+                threats.AppendInPlace(move);
+            }
         }
-    }
+    });
     
     return threats;
 }
 
-adt::ArraySequence<Move> ThreatSolver::findDefensiveMoves(
+MoveList ThreatSolver::findDefensiveMoves(
     const SparseBoard& board, Player player) {
     
     Player opponent = (player == Player::X) ? Player::O : Player::X;
     
-    adt::ArraySequence<Move> defenses;
+    MoveList defenses;
     auto opponentThreats = generateThreats(board, opponent);
     
     for (int i = 0; i < opponentThreats.GetLength(); ++i) {
@@ -93,10 +79,89 @@ adt::ArraySequence<Move> ThreatSolver::findDefensiveMoves(
     return defenses;
 }
 
+// Plays a threat and checks that no defence escapes a forced win searched
+// from the given depth on.
+bool ThreatSolver::threatWins(SparseBoard& board, Player player, const Move& threat,
+                              int depth, int maxDepth, const Abort* abort) {
+    board.makeMove(threat.x, threat.y, player);
+        
+    Player opponent = (player == Player::X) ? Player::O : Player::X;
+    auto defenses = findDefensiveMoves(board, opponent);
+        
+    bool allDefensesFail = true;
+    for (int j = 0; j < defenses.GetLength(); ++j) {
+        const auto& defense = defenses.Get(j);
+        board.makeMove(defense.x, defense.y, opponent);
+            
+        if (!searchForcedWin(board, player, depth, maxDepth, abort)) {
+            allDefensesFail = false;
+        }
+            
+        board.undoMove(defense.x, defense.y);
+            
+        if (!allDefensesFail) break;
+    }
+        
+    board.undoMove(threat.x, threat.y);
+    return allDefensesFail;
+}
+        
+// Tries the threats on the pool and returns the lowest index that wins, or
+// -1. A win stops the branches after it, or with anyWin all the others.
+int ThreatSolver::firstWinningThreat(const SparseBoard& board, Player player,
+                                     const MoveList& threats, int depth, int maxDepth,
+                                     bool anyWin, const Abort* abort) {
+    int count = threats.GetLength();
+    std::unique_ptr<Abort[]> aborts(new Abort[count]);
+    for (int i = 0; i < count; ++i) {
+        aborts[i].parent = abort;
+    }
+    std::atomic<int> best(count);
+    
+    std::optional<SparseBoard> snapshot;
+    {
+        adt::Arena::Binding heap(nullptr);
+        snapshot.emplace(board);
+    }
+    const SparseBoard& shared = *snapshot;
+    
+    TaskGroup branches(*pool_);
+    for (int i = 0; i < count; ++i) {
+        branches.run([&, i] {
+            if (aborts[i].isSet()) {
+                return;
+            }
+            adt::Arena::Binding heap(nullptr);
+            SparseBoard local = shared;
+            adt::Arena::Binding arenaBinding(adt::Arena::forThread());
+            
+            if (!threatWins(local, player, threats.Get(i), depth, maxDepth, &aborts[i]) ||
+                aborts[i].isSet()) {
+                return;
+            }
+            int current = best.load();
+            while (i < current && !best.compare_exchange_weak(current, i)) {
+            }
+            for (int j = 0; j < count; ++j) {
+                if (anyWin ? j != i : j > i) {
+                    aborts[j].flag.store(true, std::memory_order_relaxed);
+                }
+            }
+        }, TaskPriority::HIGH);
+    }
+    branches.wait();
+    
+    int winner = best.load();
+    return winner < count ? winner : -1;
+}
+
 bool ThreatSolver::searchForcedWin(
-    SparseBoard& board, Player player, int depth, int maxDepth) {
+    SparseBoard& board, Player player, int depth, int maxDepth, const Abort* abort) {
+    
+    adt::Arena::Scope scope;
+    ENGINE_STAT(nodes_searched_++);
     
-    if (depth >= maxDepth) {
+    if (depth >= maxDepth || isAborted(abort)) {
         return false;
     }
     
@@ -105,84 +170,79 @@ bool ThreatSolver::searchForcedWin(
         return true;
     }
     
+    int remaining = maxDepth - depth;
+    uint64_t hash = board.getZobristHash();
+    auto cached = cache_.probe(hash, player, remaining);
+    if (cached.getResult() != SolverResult::UNKNOWN) {
+        return cached.getResult() == SolverResult::WIN;
+    }
+    
     auto threats = generateThreats(board, player);
     
-    for (int i = 0; i < threats.GetLength(); ++i) {
-        const auto& threat = threats.Get(i);
-        board.makeMove(threat.x, threat.y, player);
-        
-        Player opponent = (player == Player::X) ? Player::O : Player::X;
-        auto defenses = findDefensiveMoves(board, opponent);
-        
-        if (defenses.Empty()) {
-            board.undoMove(threat.x, threat.y);
-            return true;
-        }
-        
-        bool allDefensesFail = true;
-        for (int j = 0; j < defenses.GetLength(); ++j) {
-            const auto& defense = defenses.Get(j);
-            board.makeMove(defense.x, defense.y, opponent);
-            
-            if (!searchForcedWin(board, player, depth + 1, maxDepth)) {
-                allDefensesFail = false;
+    // The winning threat is only recorded when it is the first one that
+    // wins, which is what the root relies on.
+    int winner = -1;
+    bool proven = false;
+    if (isParallel() && depth < PARALLEL_DEPTH && threats.GetLength() > 1) {
+        proven = firstWinningThreat(board, player, threats, depth + 1, maxDepth, true, abort) >= 0;
+    } else {
+        for (int i = 0; i < threats.GetLength() && !proven; ++i) {
+            proven = threatWins(board, player, threats.Get(i), depth + 1, maxDepth, abort);
+            if (proven) {
+                winner = i;
             }
-            
-            board.undoMove(defense.x, defense.y);
-            
-            if (!allDefensesFail) break;
-        }
-        
-        board.undoMove(threat.x, threat.y);
-        
-        if (allDefensesFail) {
-            return true;
         }
     }
     
-    return false;
+    // An aborted branch may report false without having refuted anything.
+    if (!isAborted(abort)) {
+        cache_.store(hash, player, remaining, proven,
+                     winner >= 0 ? std::optional<Move>(threats.Get(winner)) : std::nullopt);
+    }
+    
+    return proven;
 }
 
 std::optional<Move> ThreatSolver::findForcedWin(
     SparseBoard& board, Player player, int maxDepth) {
     
+    ENGINE_STAT(nodes_searched_ = 1);
+    
     auto winMove = moveGen_.checkImmediateWin(board, player);
     if (winMove.has_value()) {
         return *winMove;
     }
     
+    uint64_t hash = board.getZobristHash();
+    auto cached = cache_.probe(hash, player, maxDepth);
+    if (cached.getResult() == SolverResult::NO_WIN) {
+        return std::nullopt;
+    }
+    if (cached.getResult() == SolverResult::WIN && cached.hasThreat() &&
+        cached.getRemaining() == maxDepth) {
+        return cached.getThreat();
+    }
+    
     auto threats = generateThreats(board, player);
     
-    for (int i = 0; i < threats.GetLength(); ++i) {
-        const auto& threat = threats.Get(i);
-        board.makeMove(threat.x, threat.y, player);
-        
-        Player opponent = (player == Player::X) ? Player::O : Player::X;
-        auto defenses = findDefensiveMoves(board, opponent);
-        
-        bool allDefensesFail = true;
-        for (int j = 0; j < defenses.GetLength(); ++j) {
-            const auto& defense = defenses.Get(j);
-            board.makeMove(defense.x, defense.y, opponent);
-            
-            if (!searchForcedWin(board, player, 1, maxDepth)) {
-                allDefensesFail = false;
+    int winner = -1;
+    if (isParallel() && threats.GetLength() > 1) {
+        winner = firstWinningThreat(board, player, threats, 1, maxDepth, false, nullptr);
+    } else {
+        for (int i = 0; i < threats.GetLength() && winner < 0; ++i) {
+            if (threatWins(board, player, threats.Get(i), 1, maxDepth, nullptr)) {
+                winner = i;
             }
-            
-            board.undoMove(defense.x, defense.y);
-            
-            if (!allDefensesFail) break;
-        }
-        
-        board.undoMove(threat.x, threat.y);
-        
-        if (allDefensesFail) {
-            return threat;
         }
     }
     
-    return std::nullopt;
+    if (winner < 0) {
+        cache_.store(hash, player, maxDepth, false);
+        return std::nullopt;
+    }
+    Move threat = threats.Get(winner);
+    cache_.store(hash, player, maxDepth, true, threat);
+    return threat;
 }
 
 } // namespace tictactoe
-
@@ -6,7 +6,7 @@
 namespace tictactoe {
 
 TranspositionTable::TranspositionTable(size_t sizeMB) 
-    : entries_(0), age_(0) {
+    : entries_(0), age_(0), snapshot_(nullptr) {
     
     size_t targetSize = (sizeMB * 1024 * 1024) / sizeof(TTEntry);
     
@@ -16,7 +16,7 @@ TranspositionTable::TranspositionTable(size_t sizeMB)
     }
     size_ >>= 1;
     
-    table_ = new TTEntry[size_];
+    table_ = new TTSlot[size_];
     clear();
 }
 
@@ -26,37 +26,54 @@ TranspositionTable::~TranspositionTable() {
 
 void TranspositionTable::clear() {
     for (size_t i = 0; i < size_; ++i) {
-        table_[i] = TTEntry();
+        table_[i].check.store(0, std::memory_order_relaxed);
+        table_[i].data.store(0, std::memory_order_relaxed);
     }
     entries_ = 0;
     age_ = 0;
 }
 
+TTEntry TranspositionTable::load(size_t idx) const {
+    uint64_t check = table_[idx].check.load(std::memory_order_relaxed);
+    uint64_t data = table_[idx].data.load(std::memory_order_relaxed);
+    TTEntry entry;
+    std::memcpy(reinterpret_cast<char*>(&entry) + sizeof(uint64_t), &data, sizeof(data));
+    entry.zobristKey = check ^ data;
+    return entry;
+}
+
+void TranspositionTable::save(size_t idx, const TTEntry& entry) {
+    uint64_t data;
+    std::memcpy(&data, reinterpret_cast<const char*>(&entry) + sizeof(uint64_t), sizeof(data));
+    table_[idx].check.store(entry.zobristKey ^ data, std::memory_order_relaxed);
+    table_[idx].data.store(data, std::memory_order_relaxed);
+}
+
 TranspositionTable::ProbeResult TranspositionTable::probe(
     uint64_t key, int depth, int alpha, int beta) {
     
     size_t idx = index(key);
-    TTEntry& entry = table_[idx];
+    TTEntry entry = load(idx);
     
     ProbeResult result;
+    ENGINE_STAT(result.keyMatch_ = (entry.zobristKey == key));
+    ENGINE_STAT(result.collision_ = (entry.zobristKey != key && entry.zobristKey != 0));
     
     if (entry.zobristKey == key && entry.depth >= depth) {
-        result.found_ = true;
-        result.bestMove_ = entry.bestMove;
-        
-        if (entry.flag == static_cast<int8_t>(TTFlag::EXACT)) {
+        result.bestMove_ = entry.bestMove.toMove();
+        if (resolveBound(entry.score, entry.flag, alpha, beta)) {
+            result.found_ = true;
             result.score_ = entry.score;
-        } else if (entry.flag == static_cast<int8_t>(TTFlag::LOWER_BOUND)) {
-            if (entry.score >= beta) {
-                result.score_ = entry.score;
-            } else {
-                result.found_ = false;
-            }
-        } else if (entry.flag == static_cast<int8_t>(TTFlag::UPPER_BOUND)) {
-            if (entry.score <= alpha) {
-                result.score_ = entry.score;
-            } else {
-                result.found_ = false;
+        }
+    }
+    
+    if (!result.found_ && snapshot_ != nullptr) {
+        const TTSnapshotEntry* saved = snapshot_->find(key);
+        if (saved != nullptr && saved->depth >= depth) {
+            result.bestMove_ = Move(saved->moveX, saved->moveY);
+            if (resolveBound(saved->score, saved->flag, alpha, beta)) {
+                result.found_ = true;
+                result.score_ = saved->score;
             }
         }
     }
@@ -64,12 +81,25 @@ TranspositionTable::ProbeResult TranspositionTable::probe(
     return result;
 }
 
+bool TranspositionTable::resolveBound(int score, int8_t flag, int alpha, int beta) {
+    if (flag == static_cast<int8_t>(TTFlag::LOWER_BOUND)) {
+        return score >= beta;
+    }
+    if (flag == static_cast<int8_t>(TTFlag::UPPER_BOUND)) {
+        return score <= alpha;
+    }
+    return true;
+}
+
 void TranspositionTable::store(uint64_t key, int score, int depth, 
                                TTFlag flag, Move bestMove) {
     size_t idx = index(key);
-    TTEntry& entry = table_[idx];
+    TTEntry entry = load(idx);
     
     bool isEmpty = (entry.zobristKey == 0 && entry.depth == 0);
+    if (entry.zobristKey != key && flag != TTFlag::EXACT && isProtected(entry)) {
+        return;
+    }
     if (isEmpty || entry.depth <= depth) {
         bool wasEmpty = isEmpty;
         replaceEntry(idx, key, score, depth, flag, bestMove);
@@ -79,27 +109,75 @@ void TranspositionTable::store(uint64_t key, int score, int depth,
     }
 }
 
+bool TranspositionTable::isProtected(const TTEntry& entry) const {
+    return entry.pv && ((age_ - entry.age) & AGE_MASK) <= 1;
+}
+
 void TranspositionTable::replaceEntry(size_t idx, uint64_t key, int score, 
                                      int depth, TTFlag flag, Move bestMove) {
-    TTEntry& entry = table_[idx];
+    TTEntry entry;
     entry.zobristKey = key;
     entry.score = static_cast<int16_t>(score);
     entry.depth = static_cast<int8_t>(depth);
-    entry.flag = static_cast<int8_t>(flag);
-    entry.bestMove = bestMove;
-    entry.age = age_;
+    entry.flag = static_cast<uint8_t>(flag);
+    entry.pv = flag == TTFlag::EXACT;
+    entry.bestMove = PackedMove::fromMove(bestMove);
+    entry.age = static_cast<uint8_t>(age_ & AGE_MASK);
+    save(idx, entry);
 }
 
 std::optional<Move> TranspositionTable::getPVMove(uint64_t key) {
     size_t idx = index(key);
-    TTEntry& entry = table_[idx];
+    TTEntry entry = load(idx);
     
-    if (entry.zobristKey == key && entry.bestMove.x != 0 && entry.bestMove.y != 0) {
-        return entry.bestMove;
+    if (entry.zobristKey == key) {
+        Move move = entry.bestMove.toMove();
+        if (move.x != 0 || move.y != 0) {
+            return move;
+        }
+    }
+    
+    if (snapshot_ != nullptr) {
+        const TTSnapshotEntry* saved = snapshot_->find(key);
+        if (saved != nullptr && (saved->moveX != 0 || saved->moveY != 0)) {
+            return Move(saved->moveX, saved->moveY);
+        }
     }
     
     return std::nullopt;
 }
 
+void TranspositionTable::exportEntries(int minDepth, std::vector<TTSnapshotEntry>& out) const {
+    for (size_t i = 0; i < size_; ++i) {
+        TTEntry entry = load(i);
+        if (entry.zobristKey == 0 || entry.depth < minDepth) {
+            continue;
+        }
+        TTSnapshotEntry saved;
+        saved.key = entry.zobristKey;
+        Move move = entry.bestMove.toMove();
+        saved.moveX = move.x;
+        saved.moveY = move.y;
+        saved.score = entry.score;
+        saved.depth = entry.depth;
+        saved.flag = entry.flag;
+        saved.reserved = 0;
+        out.push_back(saved);
+    }
+}
+
+size_t TranspositionTable::warmStart(const TTSnapshot& snapshot, int minDepth) {
+    size_t loaded = 0;
+    for (const TTSnapshotEntry& saved : snapshot) {
+        if (saved.depth < minDepth) {
+            continue;
+        }
+        store(saved.key, saved.score, saved.depth, static_cast<TTFlag>(saved.flag),
+              Move(saved.moveX, saved.moveY));
+        loaded++;
+    }
+    return loaded;
+}
+
 } // namespace tictactoe
 
@@ -0,0 +1,90 @@
+#include "engine/tt_snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace tictactoe {
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'T', 'T', 'T', 'S', 'N', 'A', 'P', '\0'};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t winLength;
+    uint64_t entryCount;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(SnapshotHeader) == 32, "SnapshotHeader is stored verbatim on disk");
+
+} // namespace
+
+bool TTSnapshot::open(const std::string& path) {
+    close();
+    if (!file_.open(path) || file_.size() < sizeof(SnapshotHeader)) {
+        file_.close();
+        return false;
+    }
+    
+    SnapshotHeader header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    uint64_t available = (file_.size() - sizeof(SnapshotHeader)) / sizeof(TTSnapshotEntry);
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        header.version != FORMAT_VERSION || header.entryCount > available) {
+        file_.close();
+        return false;
+    }
+    
+    entries_ = reinterpret_cast<const TTSnapshotEntry*>(file_.data() + sizeof(SnapshotHeader));
+    count_ = static_cast<size_t>(header.entryCount);
+    winLength_ = static_cast<int>(header.winLength);
+    return true;
+}
+
+void TTSnapshot::close() {
+    file_.close();
+    entries_ = nullptr;
+    count_ = 0;
+    winLength_ = 0;
+}
+
+const TTSnapshotEntry* TTSnapshot::find(uint64_t key) const {
+    const TTSnapshotEntry* last = end();
+    const TTSnapshotEntry* it = std::lower_bound(begin(), last, key,
+        [](const TTSnapshotEntry& entry, uint64_t k) { return entry.key < k; });
+    if (it != last && it->key == key) {
+        return it;
+    }
+    return nullptr;
+}
+
+bool TTSnapshot::write(const std::string& path, int winLength,
+                       std::vector<TTSnapshotEntry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const TTSnapshotEntry& a, const TTSnapshotEntry& b) {
+        if (a.key != b.key) return a.key < b.key;
+        return a.depth > b.depth;
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+        [](const TTSnapshotEntry& a, const TTSnapshotEntry& b) { return a.key == b.key; }),
+        entries.end());
+    
+    SnapshotHeader header;
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = FORMAT_VERSION;
+    header.winLength = static_cast<uint32_t>(winLength);
+    header.entryCount = entries.size();
+    header.reserved = 0;
+    
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(TTSnapshotEntry)));
+    return static_cast<bool>(out);
+}
+
+} // namespace tictactoe
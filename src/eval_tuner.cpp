@@ -0,0 +1,126 @@
+#include "selfplay/texel_tuner.h"
+#include "engine/config.h"
+#include "engine/eval_weights.h"
+#include "utils/thread_pool.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace tictactoe;
+
+void printUsage() {
+    std::cerr << "Usage: eval_tuner --records FILE [--records FILE ...] --out FILE [options]\n"
+              << "Fits the evaluation weights to the results of recorded games.\n"
+              << "Options:\n"
+              << "  --win-length N      win condition (default " << Config::WIN_LENGTH << ")\n"
+              << "  --weights FILE      starting weights; other win lengths in it are kept\n"
+              << "  --iterations N      gradient descent steps (default 300)\n"
+              << "  --rate R            learning rate on log-weights (default 0.5)\n"
+              << "  --skip-plies N      ignore the first N plies of every game (default 4)\n"
+              << "  --threads N         worker threads (default: hardware concurrency - 1)\n";
+}
+
+int main(int argc, char* argv[]) {
+    TunerOptions options;
+    std::vector<std::string> recordPaths;
+    std::string weightsPath;
+    std::string outPath;
+    int threads = ThreadPool::defaultThreadCount();
+    
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            std::string value = argv[++i];
+            
+            if (arg == "--records") recordPaths.push_back(value);
+            else if (arg == "--out") outPath = value;
+            else if (arg == "--weights") weightsPath = value;
+            else if (arg == "--win-length") options.winLength = std::stoi(value);
+            else if (arg == "--iterations") options.iterations = std::stoi(value);
+            else if (arg == "--rate") options.learningRate = std::stod(value);
+            else if (arg == "--skip-plies") options.skipPlies = std::stoi(value);
+            else if (arg == "--threads") threads = std::stoi(value);
+            else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid option: " << e.what() << "\n";
+        return 1;
+    }
+    
+    if (recordPaths.empty() || outPath.empty()) {
+        printUsage();
+        return 1;
+    }
+    
+    std::vector<EvalWeights> sets;
+    if (!weightsPath.empty()) {
+        std::ifstream in(weightsPath);
+        if (!in || !EvalWeights::read(in, sets)) {
+            std::cerr << "Cannot read weights file: " << weightsPath << "\n";
+            return 1;
+        }
+    }
+    EvalWeights start = EvalWeights::defaults(options.winLength);
+    for (const auto& weights : sets) {
+        if (weights.winLength == options.winLength) {
+            start = weights;
+        }
+    }
+    
+    ThreadPool pool(threads);
+    TexelTuner tuner(options, pool);
+    int games = 0;
+    int skipped = 0;
+    for (const auto& path : recordPaths) {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "Cannot open records: " << path << "\n";
+            return 1;
+        }
+        GameRecord record;
+        try {
+            while (readGameRecord(in, record)) {
+                if (tuner.addGame(record, start)) {
+                    games++;
+                } else {
+                    skipped++;
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Bad record in " << path << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+    std::cerr << "Loaded " << games << " games (" << skipped << " skipped)\n";
+    if (tuner.sampleCount() == 0) {
+        std::cerr << "No positions to tune on\n";
+        return 1;
+    }
+    
+    EvalWeights tuned = tuner.tune(start, std::cerr);
+    
+    bool replaced = false;
+    for (auto& weights : sets) {
+        if (weights.winLength == tuned.winLength) {
+            weights = tuned;
+            replaced = true;
+        }
+    }
+    if (!replaced) {
+        sets.push_back(tuned);
+    }
+    if (!EvalWeights::save(outPath, sets)) {
+        std::cerr << "Cannot write weights file: " << outPath << "\n";
+        return 1;
+    }
+    std::cout << "Wrote weights for win length " << tuned.winLength << " to " << outPath << "\n";
+    return 0;
+}
@@ -46,6 +46,19 @@ bool parseMove(const std::string& input, int& x, int& y) {
     return !!(iss >> x >> y);
 }
 
+// "analyze" or "analyze K"; K is the number of lines, 3 by default.
+bool parseAnalyze(const std::string& input, int& lines) {
+    std::istringstream iss(input);
+    std::string word;
+    if (!(iss >> word) || word != "analyze") {
+        return false;
+    }
+    if (!(iss >> lines)) {
+        lines = 3;
+    }
+    return true;
+}
+
 std::string formatTime(int timeMs) {
     if (timeMs < 1000) {
         return std::to_string(timeMs) + " ms";
@@ -75,6 +88,9 @@ void printBriefReport(const SearchStats& stats) {
         case DecisionType::NEGAMAX_SEARCH:
             decisionType = "Negamax search";
             break;
+        case DecisionType::OPENING_BOOK:
+            decisionType = "Opening book";
+            break;
     }
     
     std::cout << "Time: " << formatTime(stats.getTimeMs()) << " | Method: " << decisionType;
@@ -84,6 +100,36 @@ void printBriefReport(const SearchStats& stats) {
     std::cout << "\n";
 }
 
+#ifdef ENGINE_INSTRUMENTATION
+void printCounters(const SearchCounters& counters) {
+    std::cout << "--- Instrumentation ---\n";
+    std::cout << "TT probes/hits/cutoffs/collisions: " << counters.tt_probes << " / "
+              << counters.tt_hits << " / " << counters.tt_cutoffs << " / "
+              << counters.tt_collisions << "\n";
+    std::cout << "Quiescence nodes: " << counters.quiescence_nodes << "\n";
+    std::cout << "LMR re-searches: " << counters.lmr_researches << "\n";
+    std::cout << "Threat solver nodes: " << counters.threat_solver_nodes << "\n";
+    
+    double avgCandidates = counters.candidate_lists > 0
+        ? static_cast<double>(counters.candidate_moves) / counters.candidate_lists : 0.0;
+    std::cout << "Candidate lists: " << counters.candidate_lists
+              << " (avg " << std::fixed << std::setprecision(1) << avgCandidates
+              << ", max " << counters.candidate_max << ")\n";
+    
+    std::cout << "Beta cutoff at move index:";
+    for (int i = 0; i < SearchCounters::CUTOFF_BUCKETS; ++i) {
+        std::cout << " [" << i << (i == SearchCounters::CUTOFF_BUCKETS - 1 ? "+" : "")
+                  << "]=" << counters.beta_cutoff_index[i];
+    }
+    std::cout << "\n";
+    
+    std::cout << "Phase time: immediate checks " << formatTime(counters.immediate_checks_us / 1000)
+              << ", hasThreats " << formatTime(counters.has_threats_us / 1000)
+              << ", threat solver " << formatTime(counters.threat_solver_us / 1000)
+              << ", negamax " << formatTime(counters.negamax_us / 1000) << "\n";
+}
+#endif
+
 void printDetailedStats(const SearchStats& stats) {
     std::cout << "\n=== Detailed Search Statistics ===\n";
     std::cout << "Decision method: ";
@@ -103,10 +149,17 @@ void printDetailedStats(const SearchStats& stats) {
         case DecisionType::NEGAMAX_SEARCH:
             std::cout << "Negamax Search (full alpha-beta search)\n";
             break;
+        case DecisionType::OPENING_BOOK:
+            std::cout << "Opening Book (stored move for a known position)\n";
+            break;
     }
     
     std::cout << "Time: " << formatTime(stats.getTimeMs()) << "\n";
     std::cout << "Nodes searched: " << stats.getNodesSearched() << "\n";
+    if (stats.getEvalCacheHits() + stats.getEvalCacheMisses() > 0) {
+        std::cout << "Eval cache: " << stats.getEvalCacheHits() << " hits, "
+                  << stats.getEvalCacheMisses() << " misses\n";
+    }
     
     if (stats.getDecisionType() == DecisionType::NEGAMAX_SEARCH) {
         std::cout << "Depth reached: " << stats.getDepthReached() << "\n";
@@ -123,9 +176,27 @@ void printDetailedStats(const SearchStats& stats) {
         }
     }
     
+#ifdef ENGINE_INSTRUMENTATION
+    printCounters(stats.getCounters());
+#endif
+    
     std::cout << "===================================\n\n";
 }
 
+void printAnalysisInfo(const AnalysisInfo& info) {
+    std::cout << "depth " << info.depth << "  nodes " << info.nodes
+              << "  nps " << info.nodesPerSecond << "  time " << formatTime(info.timeMs) << "\n";
+    for (size_t i = 0; i < info.lines.size(); ++i) {
+        const AnalysisLine& line = info.lines[i];
+        std::cout << "  " << (i + 1) << ". (" << line.move.x << "," << line.move.y << ")"
+                  << " score " << line.score << "  pv";
+        for (const auto& pvMove : line.pv) {
+            std::cout << " (" << pvMove.x << "," << pvMove.y << ")";
+        }
+        std::cout << "\n";
+    }
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "=== Infinite Tic-Tac-Toe Engine ===\n\n";
     
@@ -147,7 +218,7 @@ int main(int argc, char* argv[]) {
     }
     
     std::cout << "Win condition: " << winLength << " in a row\n";
-    std::cout << "Commands: 'x y' to make move, 'quit' to exit\n\n";
+    std::cout << "Commands: 'x y' to make move, 'analyze [K]' to show the best K moves, 'quit' to exit\n\n";
     
     std::cout << "Choose your player (X or O, default X): ";
     std::string playerChoice;
@@ -178,6 +249,15 @@ int main(int argc, char* argv[]) {
     
     SparseBoard board(winLength);
     SearchEngine engine(winLength);
+    OpeningBook book;
+    if (argc > 2) {
+        if (book.open(argv[2]) && book.getWinLength() == winLength) {
+            engine.setOpeningBook(&book);
+            std::cout << "Opening book: " << argv[2] << " (" << book.size() << " entries)\n";
+        } else {
+            std::cerr << "Cannot use opening book " << argv[2] << " for win length " << winLength << "\n";
+        }
+    }
     Player currentPlayer = Player::X;
     
     if (aiFirst) {
@@ -236,6 +316,13 @@ int main(int argc, char* argv[]) {
                 break;
             }
             
+            int lines;
+            if (parseAnalyze(input, lines)) {
+                engine.analyze(board, currentPlayer, lines, Config::DEFAULT_TIME_MS, printAnalysisInfo);
+                std::cout << "\n";
+                continue;
+            }
+            
             int x, y;
             if (!parseMove(input, x, y)) {
                 std::cout << "Invalid input. Please enter two numbers: x y\n";
@@ -282,6 +369,9 @@ int main(int argc, char* argv[]) {
                     case DecisionType::NEGAMAX_SEARCH:
                         std::cout << "Negamax Search (depth " << stats.getDepthReached() << ")\n";
                         break;
+                    case DecisionType::OPENING_BOOK:
+                        std::cout << "Opening Book\n";
+                        break;
                 }
                 std::cout << "  This should not happen - fallback logic failed!\n";
                 break;
@@ -0,0 +1,104 @@
+#include "selfplay/nnue_trainer.h"
+#include "engine/config.h"
+#include "engine/nnue.h"
+#include "utils/thread_pool.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace tictactoe;
+
+void printUsage() {
+    std::cerr << "Usage: nnue_trainer --records FILE [--records FILE ...] --out FILE [options]\n"
+              << "Trains an evaluation network on the results of recorded games.\n"
+              << "Options:\n"
+              << "  --win-length N      win condition (default " << Config::WIN_LENGTH << ")\n"
+              << "  --epochs N          passes over the positions (default 30)\n"
+              << "  --batch N           positions per gradient step (default 256)\n"
+              << "  --rate R            Adam learning rate (default 0.002)\n"
+              << "  --skip-plies N      ignore the first N plies of every game (default 4)\n"
+              << "  --augment 0|1       add rotated and reflected positions (default 1)\n"
+              << "  --seed N            initial weights and shuffling seed\n"
+              << "  --threads N         worker threads (default: hardware concurrency - 1)\n";
+}
+
+int main(int argc, char* argv[]) {
+    NnueTrainerOptions options;
+    std::vector<std::string> recordPaths;
+    std::string outPath;
+    int threads = ThreadPool::defaultThreadCount();
+    
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            std::string value = argv[++i];
+            
+            if (arg == "--records") recordPaths.push_back(value);
+            else if (arg == "--out") outPath = value;
+            else if (arg == "--win-length") options.winLength = std::stoi(value);
+            else if (arg == "--epochs") options.epochs = std::stoi(value);
+            else if (arg == "--batch") options.batchSize = std::stoi(value);
+            else if (arg == "--rate") options.learningRate = std::stod(value);
+            else if (arg == "--skip-plies") options.skipPlies = std::stoi(value);
+            else if (arg == "--augment") options.augment = std::stoi(value) != 0;
+            else if (arg == "--seed") options.seed = std::stoull(value);
+            else if (arg == "--threads") threads = std::stoi(value);
+            else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid option: " << e.what() << "\n";
+        return 1;
+    }
+    
+    if (recordPaths.empty() || outPath.empty()) {
+        printUsage();
+        return 1;
+    }
+    
+    ThreadPool pool(threads);
+    NnueTrainer trainer(options, pool);
+    int games = 0;
+    int skipped = 0;
+    for (const auto& path : recordPaths) {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "Cannot open records: " << path << "\n";
+            return 1;
+        }
+        GameRecord record;
+        try {
+            while (readGameRecord(in, record)) {
+                if (trainer.addGame(record)) {
+                    games++;
+                } else {
+                    skipped++;
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Bad record in " << path << ": " << e.what() << "\n";
+            return 1;
+        }
+    }
+    std::cerr << "Loaded " << games << " games (" << skipped << " skipped)\n";
+    if (trainer.sampleCount() == 0) {
+        std::cerr << "No positions to train on\n";
+        return 1;
+    }
+    
+    trainer.train(std::cerr);
+    
+    if (!trainer.network().write(outPath)) {
+        std::cerr << "Cannot write network file: " << outPath << "\n";
+        return 1;
+    }
+    std::cout << "Wrote network for win length " << options.winLength << " to " << outPath << "\n";
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "selfplay/book_builder.h"
+#include "selfplay/match.h"
+#include "engine/search_engine.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+
+namespace tictactoe {
+
+namespace {
+
+struct BookChoice {
+    int x;
+    int y;
+    int score;
+};
+
+struct BookTally {
+    uint32_t weight = 0;
+    int64_t scoreSum = 0;
+};
+
+} // namespace
+
+std::vector<BookEntry> buildOpeningBook(const BookBuildOptions& options, std::ostream& log,
+                                        std::vector<TTSnapshotEntry>* ttEntries) {
+    auto openings = generateOpenings(options.games, options.openingPlies,
+                                     options.openingRadius, options.seed);
+    
+    std::mutex mutex;
+    std::unordered_map<uint64_t, BookChoice> searched;
+    std::map<std::tuple<uint64_t, int, int>, BookTally> tallies;
+    std::atomic<int> nextGame(0);
+    int finishedGames = 0;
+    
+    auto worker = [&]() {
+        SearchEngine engine(options.winLength, options.search);
+        
+        for (int game = nextGame++; game < options.games; game = nextGame++) {
+            SparseBoard board(options.winLength);
+            Player player = Player::X;
+            int keep = game % (options.openingPlies + 1);
+            for (int i = 0; i < keep; ++i) {
+                const auto& stone = openings[game][i];
+                board.makeMove(stone.x, stone.y, player);
+                player = (player == Player::X) ? Player::O : Player::X;
+            }
+            
+            int searches = 0;
+            for (int ply = keep; ply < options.bookPlies && !board.isTerminal(); ++ply) {
+                CanonicalPosition canonical(board, player);
+                uint64_t key = canonical.getKey();
+                
+                BookChoice choice;
+                bool known;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto it = searched.find(key);
+                    known = it != searched.end();
+                    if (known) choice = it->second;
+                }
+                
+                if (!known) {
+                    Move best = engine.findBestMove(board, player, options.timeMs);
+                    Position p = canonical.toCanonical(best.x, best.y);
+                    choice = {p.x, p.y, engine.getStats().getFinalScore()};
+                    searches++;
+                    
+                    std::lock_guard<std::mutex> lock(mutex);
+                    choice = searched.emplace(key, choice).first->second;
+                }
+                
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    BookTally& tally = tallies[std::make_tuple(key, choice.x, choice.y)];
+                    tally.weight++;
+                    tally.scoreSum += choice.score;
+                }
+                
+                Position move = canonical.fromCanonical(choice.x, choice.y);
+                if (!board.makeMove(move.x, move.y, player)) {
+                    break;
+                }
+                player = (player == Player::X) ? Player::O : Player::X;
+            }
+            
+            std::lock_guard<std::mutex> lock(mutex);
+            finishedGames++;
+            log << "game " << finishedGames << "/" << options.games << ": opening " << keep
+                << " plies, " << searches << " searches, " << searched.size()
+                << " positions" << std::endl;
+        }
+        
+        if (ttEntries != nullptr) {
+            std::vector<TTSnapshotEntry> deep;
+            engine.exportTT(options.ttMinDepth, deep);
+            std::lock_guard<std::mutex> lock(mutex);
+            ttEntries->insert(ttEntries->end(), deep.begin(), deep.end());
+        }
+    };
+    
+    int threads = options.threads > 0 ? options.threads : 1;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    
+    std::vector<BookEntry> entries;
+    entries.reserve(tallies.size());
+    for (const auto& [position, tally] : tallies) {
+        if (tally.weight < static_cast<uint32_t>(options.minWeight)) {
+            continue;
+        }
+        BookEntry entry;
+        entry.key = std::get<0>(position);
+        entry.x = std::get<1>(position);
+        entry.y = std::get<2>(position);
+        entry.score = static_cast<int32_t>(tally.scoreSum / tally.weight);
+        entry.weight = tally.weight;
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+} // namespace tictactoe
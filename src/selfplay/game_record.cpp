@@ -0,0 +1,127 @@
+#include "selfplay/game_record.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace tictactoe {
+
+std::string resultToString(GameResult result) {
+    switch (result) {
+        case GameResult::X_WINS:
+            return "1-0";
+        case GameResult::O_WINS:
+            return "0-1";
+        case GameResult::DRAW:
+            break;
+    }
+    return "1/2-1/2";
+}
+
+std::string GameRecord::getTag(const std::string& name) const {
+    for (const auto& [key, value] : tags) {
+        if (key == name) {
+            return value;
+        }
+    }
+    return "";
+}
+
+void GameRecord::setTag(const std::string& name, const std::string& value) {
+    for (auto& tag : tags) {
+        if (tag.first == name) {
+            tag.second = value;
+            return;
+        }
+    }
+    tags.emplace_back(name, value);
+}
+
+void writeGameRecord(std::ostream& out, const GameRecord& record) {
+    for (const auto& [key, value] : record.tags) {
+        out << "[" << key << " \"" << value << "\"]\n";
+    }
+    out << "[Result \"" << resultToString(record.result) << "\"]\n\n";
+    
+    for (size_t i = 0; i < record.moves.size(); ++i) {
+        if (i % 2 == 0) {
+            if (i > 0) out << ((i % 16 == 0) ? "\n" : " ");
+            out << (i / 2 + 1) << ". ";
+        } else {
+            out << " ";
+        }
+        out << record.moves[i].x << "," << record.moves[i].y;
+    }
+    if (!record.moves.empty()) out << " ";
+    out << resultToString(record.result) << "\n\n";
+}
+
+bool readGameRecord(std::istream& in, GameRecord& record) {
+    record = GameRecord();
+    
+    std::string line;
+    bool inTags = false;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) {
+            if (inTags) break;
+            continue;
+        }
+        if (line[0] != '[') break;
+        inTags = true;
+        
+        size_t space = line.find(' ');
+        size_t quoteStart = line.find('"');
+        size_t quoteEnd = line.rfind('"');
+        if (space == std::string::npos || quoteStart == quoteEnd) {
+            throw std::runtime_error("Malformed tag line: " + line);
+        }
+        std::string key = line.substr(1, space - 1);
+        std::string value = line.substr(quoteStart + 1, quoteEnd - quoteStart - 1);
+        if (key == "Result") continue;
+        record.tags.emplace_back(key, value);
+    }
+    
+    if (!inTags) {
+        return false;
+    }
+    
+    Player player = Player::X;
+    bool finished = false;
+    while (!finished) {
+        if (line.empty() || line[0] == '[') {
+            if (!std::getline(in, line)) break;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            continue;
+        }
+        
+        std::istringstream iss(line);
+        std::string token;
+        while (iss >> token) {
+            if (token == "1-0" || token == "0-1" || token == "1/2-1/2") {
+                record.result = token == "1-0" ? GameResult::X_WINS
+                              : token == "0-1" ? GameResult::O_WINS
+                              : GameResult::DRAW;
+                finished = true;
+                break;
+            }
+            if (token.back() == '.') continue;
+            
+            size_t comma = token.find(',');
+            if (comma == std::string::npos) {
+                throw std::runtime_error("Malformed move token: " + token);
+            }
+            int x = std::stoi(token.substr(0, comma));
+            int y = std::stoi(token.substr(comma + 1));
+            record.moves.push_back({x, y, player});
+            player = (player == Player::X) ? Player::O : Player::X;
+        }
+        
+        if (!finished) {
+            if (!std::getline(in, line)) break;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+        }
+    }
+    
+    return true;
+}
+
+} // namespace tictactoe
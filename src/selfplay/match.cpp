@@ -0,0 +1,216 @@
+#include "selfplay/match.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <iomanip>
+
+namespace tictactoe {
+
+EngineSpec parseEngineSpec(const std::string& name, const std::string& text) {
+    EngineSpec spec;
+    spec.name = name;
+    
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        if (item.empty()) continue;
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("Expected key=value in engine spec: " + item);
+        }
+        std::string key = item.substr(0, eq);
+        int value = std::stoi(item.substr(eq + 1));
+        
+        if (key == "time") spec.timeMs = value;
+        else if (key == "depth") spec.options.maxDepth = value;
+        else if (key == "topk") spec.options.topKCandidates = value;
+        else if (key == "radius") spec.options.candidateRadius = value;
+        else if (key == "solver") spec.options.useThreatSolver = value != 0;
+        else if (key == "solver_depth") spec.options.threatSolverMaxDepth = value;
+        else if (key == "qsearch") spec.options.useQuiescence = value != 0;
+        else if (key == "lmr") spec.options.useLateMoveReductions = value != 0;
+        else if (key == "ybwc") spec.options.parallelSearch = value != 0;
+        else if (key == "split_depth") spec.options.splitMinDepth = value;
+        else if (key == "nnue") spec.options.useNnue = value != 0;
+        else throw std::invalid_argument("Unknown engine spec key: " + key);
+    }
+    
+    return spec;
+}
+
+std::string describeEngineSpec(const EngineSpec& spec) {
+    std::ostringstream oss;
+    oss << "time=" << spec.timeMs
+        << ",depth=" << spec.options.maxDepth
+        << ",topk=" << spec.options.topKCandidates
+        << ",radius=" << spec.options.candidateRadius
+        << ",solver=" << spec.options.useThreatSolver
+        << ",solver_depth=" << spec.options.threatSolverMaxDepth
+        << ",qsearch=" << spec.options.useQuiescence
+        << ",lmr=" << spec.options.useLateMoveReductions
+        << ",ybwc=" << spec.options.parallelSearch
+        << ",split_depth=" << spec.options.splitMinDepth
+        << ",nnue=" << spec.options.useNnue;
+    return oss.str();
+}
+
+std::vector<std::vector<Position>> generateOpenings(int count, int plies, int radius,
+                                                    uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> coord(-radius, radius);
+    
+    std::vector<std::vector<Position>> openings;
+    openings.reserve(count);
+    
+    for (int i = 0; i < count; ++i) {
+        SparseBoard board(Config::WIN_LENGTH);
+        std::vector<Position> opening;
+        Player player = Player::X;
+        
+        while (static_cast<int>(opening.size()) < plies) {
+            Position pos(coord(rng), coord(rng));
+            if (!board.makeMove(pos.x, pos.y, player)) continue;
+            opening.push_back(pos);
+            player = (player == Player::X) ? Player::O : Player::X;
+        }
+        openings.push_back(opening);
+    }
+    
+    return openings;
+}
+
+GameRecord playGame(SearchEngine& xEngine, int xTimeMs,
+                    SearchEngine& oEngine, int oTimeMs,
+                    const std::vector<Position>& opening,
+                    int winLength, int maxMoves) {
+    GameRecord record;
+    record.setTag("WinLength", std::to_string(winLength));
+    record.setTag("OpeningPlies", std::to_string(opening.size()));
+    
+    SparseBoard board(winLength);
+    Player player = Player::X;
+    
+    for (const auto& pos : opening) {
+        board.makeMove(pos.x, pos.y, player);
+        record.moves.push_back({pos.x, pos.y, player});
+        player = (player == Player::X) ? Player::O : Player::X;
+    }
+    
+    xEngine.clearTT();
+    oEngine.clearTT();
+    
+    while (static_cast<int>(record.moves.size()) < maxMoves) {
+        bool xToMove = player == Player::X;
+        SearchEngine& engine = xToMove ? xEngine : oEngine;
+        Move move = engine.findBestMove(board, player, xToMove ? xTimeMs : oTimeMs);
+        
+        if (!board.makeMove(move.x, move.y, player)) {
+            record.result = xToMove ? GameResult::O_WINS : GameResult::X_WINS;
+            record.setTag("Termination", "illegal move");
+            return record;
+        }
+        record.moves.push_back({move.x, move.y, player});
+        
+        if (board.isWin(move.x, move.y, player)) {
+            record.result = xToMove ? GameResult::X_WINS : GameResult::O_WINS;
+            record.setTag("Termination", "normal");
+            return record;
+        }
+        
+        player = (player == Player::X) ? Player::O : Player::X;
+    }
+    
+    record.result = GameResult::DRAW;
+    record.setTag("Termination", "move limit");
+    return record;
+}
+
+MatchRunner::MatchRunner(const EngineSpec& candidate, const EngineSpec& baseline,
+                         const MatchOptions& options)
+    : candidate_(candidate), baseline_(baseline), options_(options) {
+}
+
+MatchSummary MatchRunner::run(std::ostream* records, std::ostream& log) {
+    int openingCount = (options_.maxGames + 1) / 2;
+    auto openings = generateOpenings(openingCount, options_.openingPlies,
+                                     options_.openingRadius, options_.seed);
+    
+    Sprt sprt(options_.elo0, options_.elo1, options_.alpha, options_.beta);
+    std::mutex resultMutex;
+    std::atomic<int> nextGame(0);
+    std::atomic<bool> stop(false);
+    
+    auto worker = [&]() {
+        SearchEngine candidateEngine(options_.winLength, candidate_.options);
+        SearchEngine baselineEngine(options_.winLength, baseline_.options);
+        
+        while (!stop) {
+            int game = nextGame++;
+            if (game >= options_.maxGames) break;
+            
+            const auto& opening = openings[game / 2];
+            bool candidateIsX = (game % 2) == 0;
+            
+            GameRecord record = candidateIsX
+                ? playGame(candidateEngine, candidate_.timeMs, baselineEngine, baseline_.timeMs,
+                           opening, options_.winLength, options_.maxMoves)
+                : playGame(baselineEngine, baseline_.timeMs, candidateEngine, candidate_.timeMs,
+                           opening, options_.winLength, options_.maxMoves);
+            
+            record.tags.insert(record.tags.begin(), {
+                {"Event", "selfplay"},
+                {"Round", std::to_string(game + 1)},
+                {"X", candidateIsX ? candidate_.name : baseline_.name},
+                {"O", candidateIsX ? baseline_.name : candidate_.name}
+            });
+            
+            double score = 0.5;
+            if (record.result == GameResult::X_WINS) score = candidateIsX ? 1.0 : 0.0;
+            if (record.result == GameResult::O_WINS) score = candidateIsX ? 0.0 : 1.0;
+            
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (stop) break;
+            
+            sprt.addResult(score);
+            if (records != nullptr) {
+                writeGameRecord(*records, record);
+                records->flush();
+            }
+            
+            log << "Game " << std::setw(4) << (game + 1)
+                << "  " << resultToString(record.result)
+                << "  W/D/L " << sprt.getWins() << "/" << sprt.getDraws() << "/" << sprt.getLosses()
+                << "  LLR " << std::fixed << std::setprecision(2) << sprt.getLLR()
+                << " [" << sprt.getLowerBound() << ", " << sprt.getUpperBound() << "]\n";
+            log.flush();
+            
+            if (sprt.getStatus() != SprtStatus::CONTINUE) {
+                stop = true;
+            }
+        }
+    };
+    
+    int threads = std::max(1, options_.concurrency);
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    
+    MatchSummary summary;
+    summary.wins = sprt.getWins();
+    summary.draws = sprt.getDraws();
+    summary.losses = sprt.getLosses();
+    summary.llr = sprt.getLLR();
+    summary.elo = sprt.getEloEstimate();
+    summary.status = sprt.getStatus();
+    return summary;
+}
+
+} // namespace tictactoe
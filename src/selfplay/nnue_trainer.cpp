@@ -0,0 +1,279 @@
+#include "selfplay/nnue_trainer.h"
+#include "board/sparse_board.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <random>
+#include <string>
+
+namespace tictactoe {
+
+namespace {
+    // The same feature seen from the other side: own and opponent swap.
+    int mirror(int feature) {
+        return feature < NnueNetwork::CELLS ? feature + NnueNetwork::CELLS
+                                            : feature - NnueNetwork::CELLS;
+    }
+    
+    float clipped(float value) {
+        return std::min(std::max(value, 0.0f), 1.0f);
+    }
+    
+    void adamStep(std::vector<float>& params, const std::vector<float>& gradient,
+                  std::vector<float>& m, std::vector<float>& v, double rate, int step,
+                  float limit) {
+        const double beta1 = 0.9;
+        const double beta2 = 0.999;
+        double correction1 = 1.0 - std::pow(beta1, step);
+        double correction2 = 1.0 - std::pow(beta2, step);
+        for (size_t i = 0; i < params.size(); ++i) {
+            m[i] = static_cast<float>(beta1 * m[i] + (1.0 - beta1) * gradient[i]);
+            v[i] = static_cast<float>(beta2 * v[i] + (1.0 - beta2) * gradient[i] * gradient[i]);
+            double update = rate * (m[i] / correction1) / (std::sqrt(v[i] / correction2) + 1e-8);
+            params[i] = std::clamp(static_cast<float>(params[i] - update), -limit, limit);
+        }
+    }
+}
+
+NnueTrainer::NnueTrainer(const NnueTrainerOptions& options, ThreadPool& pool)
+    : options_(options), pool_(pool),
+      inputWeights_(static_cast<size_t>(FEATURES) * HIDDEN),
+      inputBias_(HIDDEN, 0.5f),
+      outputWeights_(HIDDEN) {
+    offsets_.push_back(0);
+    
+    std::mt19937_64 rng(options_.seed);
+    std::uniform_real_distribution<float> input(-0.05f, 0.05f);
+    std::uniform_real_distribution<float> output(-0.5f, 0.5f);
+    for (auto& weight : inputWeights_) weight = input(rng);
+    for (auto& weight : outputWeights_) weight = output(rng);
+}
+
+bool NnueTrainer::addGame(const GameRecord& record) {
+    std::string tag = record.getTag("WinLength");
+    if (!tag.empty() && std::stoi(tag) != options_.winLength) {
+        return false;
+    }
+    
+    float result = 0.5f;
+    if (record.result == GameResult::X_WINS) result = 1.0f;
+    if (record.result == GameResult::O_WINS) result = 0.0f;
+    
+    SparseBoard board(options_.winLength);
+    for (size_t ply = 0; ply < record.moves.size(); ++ply) {
+        const auto& move = record.moves[ply];
+        if (!board.makeMove(move.x, move.y, move.player)) {
+            return false;
+        }
+        // The final winning position is decided already.
+        if (static_cast<int>(ply) + 1 < options_.skipPlies || board.isWin(move.x, move.y, move.player)) {
+            continue;
+        }
+        addPosition(board, result);
+    }
+    
+    return true;
+}
+
+void NnueTrainer::addPosition(const SparseBoard& board, float result) {
+    auto occupied = board.getOccupiedPositions();
+    if (occupied.Empty()) {
+        return;
+    }
+    
+    // Centre of the stones, as SearchEngine places the network window.
+    int minX = occupied.Get(0).x, maxX = minX;
+    int minY = occupied.Get(0).y, maxY = minY;
+    for (int i = 1; i < occupied.GetLength(); ++i) {
+        const auto& pos = occupied.Get(i);
+        minX = std::min(minX, pos.x);
+        maxX = std::max(maxX, pos.x);
+        minY = std::min(minY, pos.y);
+        maxY = std::max(maxY, pos.y);
+    }
+    int originX = minX + (maxX - minX) / 2;
+    int originY = minY + (maxY - minY) / 2;
+    
+    // Symmetry t swaps the axes (bit 2) and negates x (bit 0) and y (bit 1).
+    int symmetries = options_.augment ? 8 : 1;
+    for (int t = 0; t < symmetries; ++t) {
+        for (int i = 0; i < occupied.GetLength(); ++i) {
+            const auto& pos = occupied.Get(i);
+            int dx = pos.x - originX;
+            int dy = pos.y - originY;
+            if (t & 4) std::swap(dx, dy);
+            if (t & 1) dx = -dx;
+            if (t & 2) dy = -dy;
+            int feature = NnueNetwork::featureIndex(dx, dy, board.at(pos.x, pos.y) == Player::X);
+            if (feature >= 0) {
+                features_.push_back(static_cast<int16_t>(feature));
+            }
+        }
+        offsets_.push_back(features_.size());
+        results_.push_back(result);
+    }
+}
+
+double NnueTrainer::forward(size_t sample, float* hiddenX, float* hiddenO) const {
+    std::copy(inputBias_.begin(), inputBias_.end(), hiddenX);
+    std::copy(inputBias_.begin(), inputBias_.end(), hiddenO);
+    for (size_t k = offsets_[sample]; k < offsets_[sample + 1]; ++k) {
+        const float* own = &inputWeights_[static_cast<size_t>(features_[k]) * HIDDEN];
+        const float* other = &inputWeights_[static_cast<size_t>(mirror(features_[k])) * HIDDEN];
+        for (int j = 0; j < HIDDEN; ++j) {
+            hiddenX[j] += own[j];
+            hiddenO[j] += other[j];
+        }
+    }
+    
+    double z = 0.0;
+    for (int j = 0; j < HIDDEN; ++j) {
+        z += outputWeights_[j] * (clipped(hiddenX[j]) - clipped(hiddenO[j]));
+    }
+    return z;
+}
+
+void NnueTrainer::backward(size_t sample, Gradient& gradient) const {
+    float hiddenX[HIDDEN];
+    float hiddenO[HIDDEN];
+    double z = forward(sample, hiddenX, hiddenO);
+    double r = results_[sample];
+    // log(1 + e^-|z|) + max(z, 0) - r z, stable for large |z|.
+    gradient.loss += std::log1p(std::exp(-std::fabs(z))) + std::max(z, 0.0) - r * z;
+    float delta = static_cast<float>(1.0 / (1.0 + std::exp(-z)) - r);
+    
+    float deltaX[HIDDEN];
+    float deltaO[HIDDEN];
+    for (int j = 0; j < HIDDEN; ++j) {
+        gradient.outputWeights[j] += delta * (clipped(hiddenX[j]) - clipped(hiddenO[j]));
+        bool activeX = hiddenX[j] > 0.0f && hiddenX[j] < 1.0f;
+        bool activeO = hiddenO[j] > 0.0f && hiddenO[j] < 1.0f;
+        deltaX[j] = activeX ? delta * outputWeights_[j] : 0.0f;
+        deltaO[j] = activeO ? -delta * outputWeights_[j] : 0.0f;
+        gradient.inputBias[j] += deltaX[j] + deltaO[j];
+    }
+    for (size_t k = offsets_[sample]; k < offsets_[sample + 1]; ++k) {
+        float* own = &gradient.inputWeights[static_cast<size_t>(features_[k]) * HIDDEN];
+        float* other = &gradient.inputWeights[static_cast<size_t>(mirror(features_[k])) * HIDDEN];
+        for (int j = 0; j < HIDDEN; ++j) {
+            own[j] += deltaX[j];
+            other[j] += deltaO[j];
+        }
+    }
+}
+
+double NnueTrainer::loss() const {
+    int count = static_cast<int>(results_.size());
+    if (count == 0) {
+        return 0.0;
+    }
+    
+    int grain = std::max(1, options_.grain);
+    std::vector<double> losses((count + grain - 1) / grain, 0.0);
+    pool_.parallelFor(count, grain, [&](int begin, int end) {
+        float hiddenX[HIDDEN];
+        float hiddenO[HIDDEN];
+        for (int i = begin; i < end; ++i) {
+            double z = forward(i, hiddenX, hiddenO);
+            losses[i / grain] += std::log1p(std::exp(-std::fabs(z))) + std::max(z, 0.0) - results_[i] * z;
+        }
+    });
+    
+    double total = 0.0;
+    for (double chunk : losses) total += chunk;
+    return total / count;
+}
+
+double NnueTrainer::train(std::ostream& log) {
+    int count = static_cast<int>(results_.size());
+    log << "Samples: " << count << ", initial loss " << std::setprecision(6) << loss() << "\n";
+    if (count == 0) {
+        return 0.0;
+    }
+    
+    int batchSize = std::max(1, options_.batchSize);
+    int grain = std::max(1, options_.grain);
+    int maxChunks = (batchSize + grain - 1) / grain;
+    std::vector<Gradient> partials(maxChunks);
+    for (auto& partial : partials) {
+        partial.inputWeights.resize(inputWeights_.size());
+        partial.inputBias.resize(HIDDEN);
+        partial.outputWeights.resize(HIDDEN);
+    }
+    Gradient total = partials[0];
+    
+    std::vector<float> mInput(inputWeights_.size()), vInput(inputWeights_.size());
+    std::vector<float> mBias(HIDDEN), vBias(HIDDEN);
+    std::vector<float> mOutput(HIDDEN), vOutput(HIDDEN);
+    
+    std::vector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937_64 rng(options_.seed);
+    int step = 0;
+    double current = 0.0;
+    
+    for (int epoch = 1; epoch <= options_.epochs; ++epoch) {
+        std::shuffle(order.begin(), order.end(), rng);
+        double epochLoss = 0.0;
+        
+        for (int start = 0; start < count; start += batchSize) {
+            int size = std::min(batchSize, count - start);
+            int chunks = (size + grain - 1) / grain;
+            for (int chunk = 0; chunk < chunks; ++chunk) {
+                Gradient& partial = partials[chunk];
+                std::fill(partial.inputWeights.begin(), partial.inputWeights.end(), 0.0f);
+                std::fill(partial.inputBias.begin(), partial.inputBias.end(), 0.0f);
+                std::fill(partial.outputWeights.begin(), partial.outputWeights.end(), 0.0f);
+                partial.loss = 0.0;
+            }
+            // The chunk comes from the index: a pool without workers runs
+            // the whole batch as one call.
+            pool_.parallelFor(size, grain, [&](int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    backward(order[start + i], partials[i / grain]);
+                }
+            });
+            
+            // Reduced in chunk order and averaged over the batch.
+            float scale = 1.0f / size;
+            std::fill(total.inputWeights.begin(), total.inputWeights.end(), 0.0f);
+            std::fill(total.inputBias.begin(), total.inputBias.end(), 0.0f);
+            std::fill(total.outputWeights.begin(), total.outputWeights.end(), 0.0f);
+            for (int chunk = 0; chunk < chunks; ++chunk) {
+                const Gradient& partial = partials[chunk];
+                for (size_t i = 0; i < total.inputWeights.size(); ++i) {
+                    total.inputWeights[i] += partial.inputWeights[i] * scale;
+                }
+                for (int j = 0; j < HIDDEN; ++j) {
+                    total.inputBias[j] += partial.inputBias[j] * scale;
+                    total.outputWeights[j] += partial.outputWeights[j] * scale;
+                }
+                epochLoss += partial.loss;
+            }
+            
+            step++;
+            adamStep(inputWeights_, total.inputWeights, mInput, vInput, options_.learningRate, step,
+                     NnueNetwork::MAX_INPUT_WEIGHT);
+            adamStep(inputBias_, total.inputBias, mBias, vBias, options_.learningRate, step,
+                     NnueNetwork::MAX_INPUT_WEIGHT);
+            adamStep(outputWeights_, total.outputWeights, mOutput, vOutput, options_.learningRate, step,
+                     NnueNetwork::MAX_OUTPUT_WEIGHT);
+        }
+        
+        current = epochLoss / count;
+        if (epoch % 5 == 0 || epoch == options_.epochs) {
+            log << "Epoch " << epoch << ": loss " << current << "\n";
+        }
+    }
+    
+    current = loss();
+    log << "Final loss " << current << "\n";
+    return current;
+}
+
+NnueNetwork NnueTrainer::network() const {
+    return NnueNetwork::fromFloat(options_.winLength, inputWeights_, inputBias_, outputWeights_);
+}
+
+} // namespace tictactoe
@@ -0,0 +1,72 @@
+#include "selfplay/sprt.h"
+#include <cmath>
+#include <limits>
+
+namespace tictactoe {
+
+Sprt::Sprt(double elo0, double elo1, double alpha, double beta)
+    : elo0_(elo0), elo1_(elo1),
+      lower_bound_(std::log(beta / (1.0 - alpha))),
+      upper_bound_(std::log((1.0 - beta) / alpha)),
+      wins_(0), draws_(0), losses_(0) {
+}
+
+double Sprt::eloToScore(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+void Sprt::addResult(double score) {
+    if (score > 0.75) {
+        wins_++;
+    } else if (score < 0.25) {
+        losses_++;
+    } else {
+        draws_++;
+    }
+}
+
+double Sprt::getLLR() const {
+    int games = getGames();
+    if (games == 0) {
+        return 0.0;
+    }
+    
+    // Half a win and half a loss of prior keep the variance positive
+    // while one side has not scored yet.
+    double n = games + 1.0;
+    double w = (wins_ + 0.5) / n;
+    double d = draws_ / n;
+    double score = w + d / 2.0;
+    double variance = w + d / 4.0 - score * score;
+    if (variance <= 0.0) {
+        return 0.0;
+    }
+    
+    double s0 = eloToScore(elo0_);
+    double s1 = eloToScore(elo1_);
+    return games * (s1 - s0) * (2.0 * score - s0 - s1) / (2.0 * variance);
+}
+
+SprtStatus Sprt::getStatus() const {
+    double llr = getLLR();
+    if (llr >= upper_bound_) {
+        return SprtStatus::ACCEPT_H1;
+    }
+    if (llr <= lower_bound_) {
+        return SprtStatus::ACCEPT_H0;
+    }
+    return SprtStatus::CONTINUE;
+}
+
+double Sprt::getEloEstimate() const {
+    int games = getGames();
+    if (games == 0) {
+        return 0.0;
+    }
+    double score = (wins_ + draws_ / 2.0) / games;
+    if (score <= 0.0) return -std::numeric_limits<double>::infinity();
+    if (score >= 1.0) return std::numeric_limits<double>::infinity();
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+} // namespace tictactoe
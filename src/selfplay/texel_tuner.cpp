@@ -0,0 +1,195 @@
+#include "selfplay/texel_tuner.h"
+#include "board/sparse_board.h"
+#include "engine/evaluator.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <string>
+
+namespace tictactoe {
+
+TexelTuner::TexelTuner(const TunerOptions& options, ThreadPool& pool)
+    : options_(options), pool_(pool) {
+}
+
+bool TexelTuner::addGame(const GameRecord& record, const EvalWeights& weights) {
+    std::string tag = record.getTag("WinLength");
+    if (!tag.empty() && std::stoi(tag) != options_.winLength) {
+        return false;
+    }
+    
+    double result = 0.5;
+    if (record.result == GameResult::X_WINS) result = 1.0;
+    if (record.result == GameResult::O_WINS) result = 0.0;
+    
+    EvalWeights extraction = weights;
+    extraction.winLength = options_.winLength;
+    Evaluator evaluator(extraction);
+    SparseBoard board(options_.winLength);
+    std::vector<double> features;
+    
+    for (size_t ply = 0; ply < record.moves.size(); ++ply) {
+        const auto& move = record.moves[ply];
+        if (!board.makeMove(move.x, move.y, move.player)) {
+            return false;
+        }
+        // The final winning position is decided already; the evaluation
+        // has nothing to say about it.
+        if (static_cast<int>(ply) + 1 < options_.skipPlies || board.isWin(move.x, move.y, move.player)) {
+            continue;
+        }
+        
+        evaluator.patternFeatures(board, Player::X, features);
+        features_.insert(features_.end(), features.begin(), features.end());
+        results_.push_back(result);
+    }
+    
+    return true;
+}
+
+double TexelTuner::score(size_t sample, const double* weights) const {
+    const double* features = &features_[sample * FEATURES];
+    double total = 0.0;
+    for (int j = 0; j < FEATURES; ++j) {
+        total += features[j] * weights[j];
+    }
+    return total;
+}
+
+// Mean logistic loss over all samples, and its gradient in the weights
+// when asked for. Chunks are reduced in index order.
+double TexelTuner::evaluate(const double* weights, double scale,
+                            std::vector<double>* gradient) const {
+    int count = static_cast<int>(results_.size());
+    if (count == 0) {
+        if (gradient) gradient->assign(FEATURES, 0.0);
+        return 0.0;
+    }
+    
+    int grain = std::max(1, options_.grain);
+    int chunks = (count + grain - 1) / grain;
+    std::vector<double> losses(chunks, 0.0);
+    std::vector<double> gradients(gradient ? static_cast<size_t>(chunks) * FEATURES : 0, 0.0);
+    
+    // A pool without workers runs the whole range as one call, so the
+    // chunk is taken from the sample index.
+    pool_.parallelFor(count, grain, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            int chunk = i / grain;
+            double* partial = gradient ? &gradients[static_cast<size_t>(chunk) * FEATURES] : nullptr;
+            double z = scale * score(i, weights);
+            double r = results_[i];
+            // log(1 + e^-|z|) + max(z, 0) - r z, stable for large |z|.
+            losses[chunk] += std::log1p(std::exp(-std::fabs(z))) + std::max(z, 0.0) - r * z;
+            if (partial) {
+                double p = 1.0 / (1.0 + std::exp(-z));
+                const double* features = &features_[static_cast<size_t>(i) * FEATURES];
+                for (int j = 0; j < FEATURES; ++j) {
+                    partial[j] += (p - r) * scale * features[j];
+                }
+            }
+        }
+    });
+    
+    double total = 0.0;
+    for (double loss : losses) total += loss;
+    if (gradient) {
+        gradient->assign(FEATURES, 0.0);
+        for (int chunk = 0; chunk < chunks; ++chunk) {
+            for (int j = 0; j < FEATURES; ++j) {
+                (*gradient)[j] += gradients[static_cast<size_t>(chunk) * FEATURES + j] / count;
+            }
+        }
+    }
+    return total / count;
+}
+
+namespace {
+    void toVector(const EvalWeights& weights, double* out) {
+        for (int k = 0; k < EvalWeights::MAX_LENGTH; ++k) {
+            out[k] = weights.open[k];
+            out[EvalWeights::MAX_LENGTH + k] = weights.closed[k];
+        }
+    }
+}
+
+double TexelTuner::loss(const EvalWeights& weights, double scale) const {
+    double w[FEATURES];
+    toVector(weights, w);
+    return evaluate(w, scale, nullptr);
+}
+
+double TexelTuner::fitScale(const EvalWeights& weights) const {
+    // Golden-section search on log10(K).
+    const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+    double low = -9.0;
+    double high = 0.0;
+    double a = high - ratio * (high - low);
+    double b = low + ratio * (high - low);
+    double lossA = loss(weights, std::pow(10.0, a));
+    double lossB = loss(weights, std::pow(10.0, b));
+    for (int i = 0; i < 60; ++i) {
+        if (lossA < lossB) {
+            high = b;
+            b = a;
+            lossB = lossA;
+            a = high - ratio * (high - low);
+            lossA = loss(weights, std::pow(10.0, a));
+        } else {
+            low = a;
+            a = b;
+            lossA = lossB;
+            b = low + ratio * (high - low);
+            lossB = loss(weights, std::pow(10.0, b));
+        }
+    }
+    return std::pow(10.0, (low + high) / 2.0);
+}
+
+EvalWeights TexelTuner::tune(const EvalWeights& start, std::ostream& log) const {
+    double scale = fitScale(start);
+    log << "Samples: " << results_.size() << ", K = " << scale
+        << ", initial loss " << std::setprecision(6) << loss(start, scale) << "\n";
+    
+    // Descend on log-weights: the weights span many orders of magnitude and
+    // must stay positive.
+    double w[FEATURES];
+    double theta[FEATURES];
+    toVector(start, w);
+    bool tunable[FEATURES] = {};
+    for (int k = 1; k < options_.winLength && k < EvalWeights::MAX_LENGTH; ++k) {
+        tunable[k] = true;
+        tunable[EvalWeights::MAX_LENGTH + k] = true;
+    }
+    for (int j = 0; j < FEATURES; ++j) {
+        theta[j] = std::log(std::max(1.0, w[j]));
+    }
+    
+    std::vector<double> gradient;
+    for (int iteration = 1; iteration <= options_.iterations; ++iteration) {
+        for (int j = 0; j < FEATURES; ++j) {
+            w[j] = tunable[j] ? std::exp(theta[j]) : w[j];
+        }
+        double current = evaluate(w, scale, &gradient);
+        for (int j = 0; j < FEATURES; ++j) {
+            if (tunable[j]) {
+                theta[j] -= options_.learningRate * gradient[j] * w[j];
+                theta[j] = std::clamp(theta[j], 0.0, std::log(static_cast<double>(MAX_WEIGHT)));
+            }
+        }
+        if (iteration % 50 == 0 || iteration == options_.iterations) {
+            log << "Iteration " << iteration << ": loss " << current << "\n";
+        }
+    }
+    
+    EvalWeights tuned = start;
+    tuned.winLength = options_.winLength;
+    for (int k = 1; k < options_.winLength && k < EvalWeights::MAX_LENGTH; ++k) {
+        tuned.open[k] = static_cast<int>(std::lround(std::exp(theta[k])));
+        tuned.closed[k] = static_cast<int>(std::lround(std::exp(theta[EvalWeights::MAX_LENGTH + k])));
+    }
+    log << "Final loss " << loss(tuned, scale) << "\n";
+    return tuned;
+}
+
+} // namespace tictactoe
@@ -0,0 +1,129 @@
+#include "selfplay/match.h"
+#include "engine/config.h"
+#include "engine/eval_weights.h"
+#include "engine/nnue.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <iomanip>
+
+using namespace tictactoe;
+
+void printUsage() {
+    std::cerr << "Usage: selfplay_match --candidate SPEC --baseline SPEC [options]\n"
+              << "SPEC is a comma-separated list of key=value pairs:\n"
+              << "  time, depth, topk, radius, solver, solver_depth, qsearch, lmr,\n"
+              << "  ybwc, split_depth, nnue\n"
+              << "Options:\n"
+              << "  --win-length N      win condition (default " << Config::WIN_LENGTH << ")\n"
+              << "  --concurrency N     games played in parallel (default: all cores)\n"
+              << "  --games N           maximum number of games\n"
+              << "  --max-moves N       adjudicate a draw after N plies\n"
+              << "  --opening-plies N   random stones in each opening\n"
+              << "  --opening-radius N  opening stones are placed within this radius\n"
+              << "  --seed N            opening suite seed\n"
+              << "  --elo0 E --elo1 E   SPRT hypotheses (default 0 and 10)\n"
+              << "  --alpha A --beta B  SPRT error rates (default 0.05)\n"
+              << "  --tt-mb N           transposition table size per engine\n"
+              << "  --weights FILE      evaluation weights for both engines\n"
+              << "  --nnue FILE         evaluation network (engines with nnue=0 ignore it)\n"
+              << "  --records FILE      write game records to FILE\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string candidateSpec;
+    std::string baselineSpec;
+    std::string recordsPath;
+    std::string weightsPath;
+    std::string networkPath;
+    MatchOptions options;
+    options.concurrency = static_cast<int>(std::thread::hardware_concurrency());
+    Config::TT_SIZE_MB = 16;
+    
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            std::string value = argv[++i];
+            
+            if (arg == "--candidate") candidateSpec = value;
+            else if (arg == "--baseline") baselineSpec = value;
+            else if (arg == "--win-length") options.winLength = std::stoi(value);
+            else if (arg == "--concurrency") options.concurrency = std::stoi(value);
+            else if (arg == "--games") options.maxGames = std::stoi(value);
+            else if (arg == "--max-moves") options.maxMoves = std::stoi(value);
+            else if (arg == "--opening-plies") options.openingPlies = std::stoi(value);
+            else if (arg == "--opening-radius") options.openingRadius = std::stoi(value);
+            else if (arg == "--seed") options.seed = std::stoull(value);
+            else if (arg == "--elo0") options.elo0 = std::stod(value);
+            else if (arg == "--elo1") options.elo1 = std::stod(value);
+            else if (arg == "--alpha") options.alpha = std::stod(value);
+            else if (arg == "--beta") options.beta = std::stod(value);
+            else if (arg == "--tt-mb") Config::TT_SIZE_MB = std::stoi(value);
+            else if (arg == "--weights") weightsPath = value;
+            else if (arg == "--nnue") networkPath = value;
+            else if (arg == "--records") recordsPath = value;
+            else {
+                printUsage();
+                return 1;
+            }
+        }
+        
+        if (!weightsPath.empty() && !EvalWeights::load(weightsPath)) {
+            std::cerr << "Cannot load evaluation weights: " << weightsPath << "\n";
+            return 1;
+        }
+        if (!networkPath.empty() && !NnueNetwork::load(networkPath)) {
+            std::cerr << "Cannot load evaluation network: " << networkPath << "\n";
+            return 1;
+        }
+        
+        EngineSpec candidate = parseEngineSpec("candidate", candidateSpec);
+        EngineSpec baseline = parseEngineSpec("baseline", baselineSpec);
+        
+        std::ofstream records;
+        if (!recordsPath.empty()) {
+            records.open(recordsPath);
+            if (!records) {
+                std::cerr << "Cannot open records file: " << recordsPath << "\n";
+                return 1;
+            }
+        }
+        
+        std::cout << "Candidate: " << describeEngineSpec(candidate) << "\n";
+        std::cout << "Baseline:  " << describeEngineSpec(baseline) << "\n";
+        std::cout << "SPRT: elo0=" << options.elo0 << " elo1=" << options.elo1
+                  << " alpha=" << options.alpha << " beta=" << options.beta << "\n\n";
+        
+        MatchRunner runner(candidate, baseline, options);
+        MatchSummary summary = runner.run(recordsPath.empty() ? nullptr : &records, std::cout);
+        
+        std::cout << "\n=== Match Summary ===\n";
+        std::cout << "W/D/L: " << summary.wins << "/" << summary.draws << "/" << summary.losses << "\n";
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Elo estimate: " << summary.elo << "\n";
+        std::cout << std::setprecision(2) << "LLR: " << summary.llr << "\n";
+        std::cout << "Result: ";
+        switch (summary.status) {
+            case SprtStatus::ACCEPT_H1:
+                std::cout << "H1 accepted (candidate is stronger)\n";
+                break;
+            case SprtStatus::ACCEPT_H0:
+                std::cout << "H0 accepted (no improvement)\n";
+                break;
+            case SprtStatus::CONTINUE:
+                std::cout << "inconclusive (game limit reached)\n";
+                break;
+        }
+        
+        return 0;
+    
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,238 @@
+#include "utils/thread_pool.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace tictactoe {
+
+ThreadPool::ThreadPool(int threads)
+    : queued_(0), sleeping_(0), nextQueue_(0), stopping_(false) {
+    options_.threads = threads;
+    start();
+}
+
+ThreadPool::ThreadPool(const Options& options)
+    : options_(options), queued_(0), sleeping_(0), nextQueue_(0), stopping_(false) {
+    start();
+}
+
+void ThreadPool::start() {
+    int threads = std::max(0, options_.threads);
+    for (int i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (int i = 0; i < threads; ++i) {
+        workers_[i]->thread = std::thread([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+int ThreadPool::defaultThreadCount() {
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(0, hardware - 1);
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(sharedOptions());
+    return pool;
+}
+
+void ThreadPool::submit(Task task, TaskPriority priority) {
+    if (workers_.empty()) {
+        task();
+        return;
+    }
+    
+    size_t target = currentPool_ == this
+        ? static_cast<size_t>(currentWorker_)
+        : nextQueue_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    {
+        std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+        workers_[target]->tasks[static_cast<int>(priority)].push_back(std::move(task));
+    }
+    queued_.fetch_add(1, std::memory_order_seq_cst);
+    
+    // Spinning workers pick the task up on their own.
+    if (sleeping_.load(std::memory_order_seq_cst) > 0) {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+        }
+        wake_.notify_one();
+    }
+}
+
+bool ThreadPool::runOne() {
+    if (workers_.empty() || queued_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    
+    size_t count = workers_.size();
+    bool isWorker = currentPool_ == this;
+    size_t self = isWorker ? static_cast<size_t>(currentWorker_) : 0;
+    for (int priority = 0; priority < PRIORITIES; ++priority) {
+        for (size_t i = 0; i < count; ++i) {
+            size_t victim = (self + i) % count;
+            Worker& worker = *workers_[victim];
+            Task task;
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                std::deque<Task>& tasks = worker.tasks[priority];
+                if (tasks.empty()) {
+                    continue;
+                }
+                // Own work is taken LIFO for locality, stolen work FIFO.
+                if (isWorker && victim == self) {
+                    task = std::move(tasks.back());
+                    tasks.pop_back();
+                } else {
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+            }
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int index) {
+    currentPool_ = this;
+    currentWorker_ = index;
+    if (options_.pinThreads) {
+        pinCurrentThread(index);
+    }
+    
+    for (;;) {
+        if (runOne()) {
+            continue;
+        }
+        
+        bool found = false;
+        for (int spin = 0; spin < options_.spinIterations && !found; ++spin) {
+            if (queued_.load(std::memory_order_acquire) > 0) {
+                found = true;
+            } else if ((spin & 63) == 63) {
+                std::this_thread::yield();
+            }
+        }
+        if (found) {
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleeping_.fetch_add(1, std::memory_order_seq_cst);
+        wake_.wait(lock, [this] {
+            return stopping_ || queued_.load(std::memory_order_seq_cst) > 0;
+        });
+        sleeping_.fetch_sub(1, std::memory_order_relaxed);
+        if (stopping_ && queued_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::pinCurrentThread(int index) const {
+    int hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int cpu = (options_.firstCpu + index) % hardware;
+#ifdef _WIN32
+    if (cpu < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+        SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu);
+    }
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+void ThreadPool::parallelFor(int count, int grain, const std::function<void(int, int)>& body,
+                             TaskPriority priority) {
+    if (count <= 0) {
+        return;
+    }
+    grain = std::max(1, grain);
+    int chunks = (count + grain - 1) / grain;
+    if (workers_.empty() || chunks == 1) {
+        body(0, count);
+        return;
+    }
+    
+    TaskGroup group(*this);
+    for (int chunk = 1; chunk < chunks; ++chunk) {
+        int begin = chunk * grain;
+        int end = std::min(count, begin + grain);
+        group.run([&body, begin, end] { body(begin, end); }, priority);
+    }
+    // The first chunk is kept for the calling thread.
+    group.run([&body, grain, count] { body(0, std::min(count, grain)); }, priority);
+    group.wait();
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool, CancellationToken token)
+    : pool_(pool), token_(std::move(token)), state_(std::make_shared<State>()) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::run(std::function<void()> task, TaskPriority priority) {
+    state_->pending.fetch_add(1, std::memory_order_acq_rel);
+    auto state = state_;
+    CancellationToken token = token_;
+    pool_.submit([state, token, task = std::move(task)] {
+        if (!token.isCancelled()) {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+            }
+        }
+        state->pending.fetch_sub(1, std::memory_order_acq_rel);
+    }, priority);
+}
+    
+void TaskGroup::waitFor(int maxPending) {
+    while (state_->pending.load(std::memory_order_acquire) > maxPending) {
+        if (!pool_.runOne()) {
+            std::this_thread::yield();
+        }
+    }
+    
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        std::swap(error, state_->error);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace tictactoe
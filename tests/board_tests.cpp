@@ -1,4 +1,7 @@
 #include "board/sparse_board.h"
+#include "board/line_kernel.h"
+#include "adt/arena.h"
+#include "adt/small_array.h"
 #include <cassert>
 #include <iostream>
 #include <cstdint>
@@ -40,6 +43,43 @@ void testWinDetection() {
     std::cout << "  ✓ Win detection passed\n";
 }
 
+void testWinLengthKernels() {
+    std::cout << "Testing win length kernels...\n";
+    
+    // Specialised and generic kernels agree on the same line.
+    SparseBoard board(5);
+    for (int i = 0; i < 7; ++i) {
+        board.makeMove(i, 0, Player::X);
+    }
+    Position specialised(1, 0);
+    Position generic(1, 0);
+    assert(LineKernel<5>::run(board, specialised, Position(1, 0), Player::X, 5) == 5);
+    assert(LineKernel<0>::run(board, generic, Position(1, 0), Player::X, 5) == 5);
+    assert(specialised == generic && specialised == Position(6, 0));
+    
+    Position forward;
+    Position backward;
+    assert(LineKernel<5>::line(board, 3, 1, Position(1, 0), Player::X, 5, forward, backward) == 1);
+    assert(forward == Position(4, 1) && backward == Position(2, 1));
+    
+    int dispatched = dispatchWinLength(7, [](auto kernel) { return decltype(kernel)::value; });
+    assert(dispatched == 0);
+    assert(dispatchWinLength(5, [](auto kernel) { return decltype(kernel)::value; }) == 5);
+    
+    // Win lengths without a specialisation go through the generic kernel.
+    SparseBoard wide(7);
+    for (int i = 0; i < 6; ++i) {
+        wide.makeMove(i, i, Player::O);
+    }
+    assert(!wide.isWin(5, 5, Player::O));
+    wide.makeMove(6, 6, Player::O);
+    assert(wide.isWin(6, 6, Player::O));
+    assert(wide.isWin(0, 0, Player::O));
+    assert(!wide.isWin(0, 0, Player::X));
+    
+    std::cout << "  ✓ Win length kernels passed\n";
+}
+
 void testZobristHash() {
     std::cout << "Testing Zobrist hash...\n";
     
@@ -76,6 +116,37 @@ void testBoundingBox() {
     std::cout << "  ✓ Bounding box passed\n";
 }
 
+void testOccupiedOrder() {
+    std::cout << "Testing occupied positions order...\n";
+    
+    // Growing the board's hash map and shrinking it back must not change
+    // the order the stones come out in.
+    SparseBoard board(5);
+    board.makeMove(3, 1, Player::X);
+    board.makeMove(-2, 0, Player::O);
+    board.makeMove(0, 5, Player::X);
+    for (int i = 0; i < 200; ++i) {
+        board.makeMove(100 + i, 0, Player::O);
+    }
+    for (int i = 199; i >= 0; --i) {
+        board.undoMove(100 + i, 0);
+    }
+    auto positions = board.getOccupiedPositions();
+    assert(positions.GetLength() == 3);
+    assert(positions.Get(0) == Position(3, 1));
+    assert(positions.Get(1) == Position(-2, 0));
+    assert(positions.Get(2) == Position(0, 5));
+    
+    // A stone taken back out of order leaves the history too.
+    board.undoMove(-2, 0);
+    positions = board.getOccupiedPositions();
+    assert(positions.GetLength() == 2);
+    assert(positions.Get(1) == Position(0, 5));
+    assert(board.getMoveHistory().GetLength() == 2);
+    
+    std::cout << "  ✓ Occupied positions order passed\n";
+}
+
 void testCopyConstructor() {
     std::cout << "Testing copy constructor...\n";
     
@@ -91,14 +162,114 @@ void testCopyConstructor() {
     std::cout << "  ✓ Copy constructor passed\n";
 }
 
+void testArenaScopes() {
+    std::cout << "Testing arena scopes...\n";
+    
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    
+    adt::Arena arena(1024);
+    {
+        adt::Arena::Binding binding(arena);
+        adt::Arena::Mark start = arena.mark();
+        
+        {
+            adt::Arena::Scope ply;
+            adt::ArraySequence<Position> positions;
+            for (int i = 0; i < 1000; ++i) {
+                positions.AppendInPlace(Position(i, -i));
+            }
+            assert(positions.GetLength() == 1000);
+            assert(positions.Get(999).x == 999 && positions.Get(999).y == -999);
+            
+            SparseBoard copy = board;
+            copy.makeMove(1, 1, Player::O);
+            assert(copy.at(0, 0) == Player::X && copy.at(1, 1) == Player::O);
+            assert(copy.getMoveHistory().GetLength() == 2);
+            
+            // Heap-bound containers created outside the binding stay on the heap
+            board.makeMove(2, 2, Player::O);
+            board.undoMove(2, 2);
+        }
+        
+        adt::Arena::Mark end = arena.mark();
+        assert(end.block == start.block && end.offset == start.offset);
+        
+        size_t reserved = arena.reservedBytes();
+        {
+            adt::Arena::Scope ply;
+            adt::ArraySequence<Position> positions;
+            for (int i = 0; i < 1000; ++i) {
+                positions.AppendInPlace(Position(i, i));
+            }
+        }
+        assert(arena.reservedBytes() == reserved);
+    }
+    assert(adt::Arena::current() == nullptr);
+    assert(board.at(0, 0) == Player::X && board.isEmpty(2, 2));
+    assert(board.getMoveHistory().GetLength() == 1);
+    
+    std::cout << "  ✓ Arena scopes passed\n";
+}
+
+void testSmallArraySequence() {
+    std::cout << "Testing small array sequence...\n";
+    
+    adt::SmallArraySequence<Position, 4> small;
+    for (int i = 0; i < 4; ++i) {
+        small.Emplace(i, -i);
+    }
+    adt::SmallArraySequence<Position, 4> moved(std::move(small));
+    assert(small.Empty() && moved.GetLength() == 4);
+    assert(moved[3].x == 3 && moved[3].y == -3);
+    
+    for (int i = 4; i < 100; ++i) {
+        moved.AppendInPlace(Position(i, -i));
+    }
+    adt::SmallArraySequence<Position, 4> copy = moved;
+    adt::SmallArraySequence<Position, 4> stolen;
+    stolen = std::move(moved);
+    assert(stolen.GetLength() == 100 && copy.GetLength() == 100);
+    
+    int sum = 0;
+    for (const auto& pos : stolen) {
+        sum += pos.x;
+    }
+    assert(sum == 99 * 100 / 2);
+    
+    // Sorting must permute ties exactly like ArraySequence does
+    adt::SmallArraySequence<Position, 8> fast;
+    adt::ArraySequence<Position> slow;
+    for (int i = 0; i < 20; ++i) {
+        fast.AppendInPlace(Position((i * 7) % 5, i));
+        slow.AppendInPlace(Position((i * 7) % 5, i));
+    }
+    auto byX = [](const Position& a, const Position& b) { return a.x > b.x; };
+    fast.SortInPlace(byX);
+    slow.SortInPlace(byX);
+    for (int i = 0; i < 20; ++i) {
+        assert(fast[i] == slow[i]);
+    }
+    
+    fast.Resize(3);
+    fast.RemoveAt(0);
+    assert(fast.GetLength() == 2 && fast[0] == slow[1]);
+    
+    std::cout << "  ✓ Small array sequence passed\n";
+}
+
 int main() {
     std::cout << "=== Board Tests ===\n\n";
     
     testBasicOperations();
     testWinDetection();
+    testWinLengthKernels();
     testZobristHash();
     testBoundingBox();
+    testOccupiedOrder();
     testCopyConstructor();
+    testArenaScopes();
+    testSmallArraySequence();
     
     std::cout << "\nAll board tests passed!\n";
     return 0;
@@ -1,7 +1,16 @@
 #include "engine/search_engine.h"
 #include "board/sparse_board.h"
+#include "engine/opening_book.h"
+#include "board/zobrist.h"
+#include "engine/threat_solver.h"
+#include "engine/nnue.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
 #include <cassert>
 #include <iostream>
+#include <vector>
 
 using namespace tictactoe;
 
@@ -45,6 +54,71 @@ void testImmediateBlock() {
     std::cout << "  ✓ Immediate block detection passed\n";
 }
 
+void testTacticalMoves() {
+    std::cout << "Testing tactical move generation...\n";
+    
+    MoveGenerator generator(5);
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    board.makeMove(5, 5, Player::O);
+    assert(generator.generateTactical(board, Player::X).Empty());
+    
+    // An open three of X: X can make an open four, O must cut it.
+    board.makeMove(1, 0, Player::X);
+    board.makeMove(2, 0, Player::X);
+    auto attack = generator.generateTactical(board, Player::X);
+    assert(!attack.Empty());
+    assert(MoveGenerator::threatClass(attack.Get(0)) == ThreatClass::OPEN_FOUR);
+    assert(generator.classifyThreat(board, 3, 0, Player::X) == ThreatClass::OPEN_FOUR);
+    assert(generator.classifyThreat(board, 3, 0, Player::O) == ThreatClass::BLOCK_THREE);
+    
+    // Once X has four, winning comes first for X and blocking for O.
+    board.makeMove(3, 0, Player::X);
+    attack = generator.generateTactical(board, Player::X);
+    assert(MoveGenerator::threatClass(attack.Get(0)) == ThreatClass::WIN);
+    auto defence = generator.generateTactical(board, Player::O);
+    assert(defence.GetLength() >= 2);
+    assert(MoveGenerator::threatClass(defence.Get(0)) == ThreatClass::BLOCK_WIN);
+    assert(MoveGenerator::threatClass(defence.Get(1)) == ThreatClass::BLOCK_WIN);
+    for (int i = 1; i < defence.GetLength(); ++i) {
+        assert(defence.getScore(i - 1) >= defence.getScore(i));
+    }
+    
+    std::cout << "  ✓ Tactical move generation passed\n";
+}
+
+void testCandidateScoreCache() {
+    std::cout << "Testing candidate score cache...\n";
+    
+    // One generator follows a game move by move, with an undo; its scores
+    // must match a fresh generator's at every step.
+    MoveGenerator incremental(5);
+    SparseBoard board(5);
+    const int moves[8][2] = {{0, 0}, {1, 1}, {1, 0}, {2, 2}, {-1, 0}, {0, 2}, {3, 3}, {-2, 0}};
+    Player player = Player::X;
+    for (int i = 0; i < 8; ++i) {
+        board.makeMove(moves[i][0], moves[i][1], player);
+        player = (player == Player::X) ? Player::O : Player::X;
+        if (i == 5) {
+            board.undoMove(moves[i][0], moves[i][1]);
+            board.makeMove(0, -1, Player::O);
+        }
+        
+        for (Player side : {Player::X, Player::O}) {
+            MoveGenerator fresh(5);
+            auto expected = fresh.generateCandidates(board, side);
+            auto actual = incremental.generateCandidates(board, side);
+            assert(expected.GetLength() == actual.GetLength());
+            for (int j = 0; j < expected.GetLength(); ++j) {
+                assert(expected.Get(j) == actual.Get(j));
+                assert(expected.getScore(j) == actual.getScore(j));
+            }
+        }
+    }
+    
+    std::cout << "  ✓ Candidate score cache passed\n";
+}
+
 void testBasicSearch() {
     std::cout << "Testing basic search...\n";
     
@@ -90,14 +164,693 @@ void testTranspositionTable() {
     std::cout << "  ✓ Transposition table passed\n";
 }
 
+void testTranspositionSnapshot() {
+    std::cout << "Testing transposition table snapshot...\n";
+    
+    ZobristHasher first;
+    ZobristHasher second;
+    assert(first.getKey(3, -7, Player::O) == second.getKey(3, -7, Player::O));
+    
+    TranspositionTable live(1);
+    live.store(0x1234, 77, 6, TTFlag::EXACT, Move(2, 3));
+    live.store(0x5678, -40, 2, TTFlag::LOWER_BOUND, Move(4, 5));
+    live.store(0x9abc, 15, 5, TTFlag::UPPER_BOUND, Move(-1, 6));
+    
+    std::vector<TTSnapshotEntry> entries;
+    live.exportEntries(4, entries);
+    assert(entries.size() == 2);
+    
+    const std::string path = "engine_tests_tt.bin";
+    assert(TTSnapshot::write(path, 5, entries));
+    TTSnapshot snapshot;
+    assert(snapshot.open(path));
+    assert(snapshot.size() == 2 && snapshot.getWinLength() == 5);
+    assert(snapshot.find(0x5678) == nullptr);
+    
+    TranspositionTable tiered(1);
+    tiered.setSnapshot(&snapshot);
+    auto exact = tiered.probe(0x1234, 6, -1000, 1000);
+    assert(exact.isFound() && exact.getScore() == 77);
+    assert(exact.getBestMove().x == 2 && exact.getBestMove().y == 3);
+    assert(!tiered.probe(0x1234, 7, -1000, 1000).isFound());
+    assert(!tiered.probe(0x9abc, 4, 0, 1000).isFound());
+    assert(tiered.probe(0x9abc, 4, 20, 1000).isFound());
+    
+    TranspositionTable warm(1);
+    assert(warm.warmStart(snapshot, 6) == 1);
+    assert(warm.probe(0x1234, 6, -1000, 1000).isFound());
+    assert(!warm.probe(0x9abc, 1, 20, 1000).isFound());
+    
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    SearchEngine engine(5);
+    engine.setTranspositionSnapshot(&snapshot);
+    Move move = engine.findBestMove(board, Player::O, 500);
+    assert(board.isEmpty(move.x, move.y));
+    
+    snapshot.close();
+    std::remove(path.c_str());
+    
+    std::cout << "  ✓ Transposition table snapshot passed\n";
+}
+
+void testEvalCache() {
+    std::cout << "Testing eval cache...\n";
+    
+    EvalCache cache(1);
+    int score = 0;
+    assert(!cache.probe(0x1234567890abcdefULL, Player::X, score));
+    cache.store(0x1234567890abcdefULL, Player::X, -750);
+    assert(cache.probe(0x1234567890abcdefULL, Player::X, score) && score == -750);
+    assert(cache.probe(0x1234567890abcdefULL, Player::O, score) && score == 750);
+    // Same slot, different key.
+    assert(!cache.probe(0x9234567890abcdefULL, Player::X, score));
+    cache.clear();
+    assert(!cache.probe(0x1234567890abcdefULL, Player::X, score));
+    
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    board.makeMove(1, 1, Player::O);
+    board.makeMove(1, 0, Player::X);
+    board.makeMove(2, 2, Player::O);
+    SearchOptions options;
+    options.maxDepth = 2;
+    SearchEngine engine(5, options);
+    engine.findBestMove(board, Player::X, 5000);
+    SearchStats stats = engine.getStats();
+    assert(stats.getEvalCacheMisses() > 0);
+    assert(stats.getEvalCacheHits() > 0);
+    
+    std::cout << "  ✓ Eval cache passed\n";
+}
+
+void testPackedMoves() {
+    std::cout << "Testing packed moves...\n";
+    
+    PackedMove packed(-5, 17);
+    assert(!packed.isNull());
+    assert(packed.dx() == -5 && packed.dy() == 17);
+    assert(packed.flags() == PackedMove::VALID);
+    assert(PackedMove(0, 0).raw() != PackedMove().raw());
+    assert(PackedMove(PackedMove::COORD_MIN, PackedMove::COORD_MAX).dx() == PackedMove::COORD_MIN);
+    assert(!PackedMove::fits(PackedMove::COORD_MAX + 1, 0));
+    assert(PackedMove::fromMove(Move(1 << 20, 0)).isNull());
+    assert(sizeof(TTEntry) == 16);
+    
+    MoveList moves;
+    moves.AppendInPlace(Move(100, -50, 3));
+    moves.AppendInPlace(Move(98, -47, 9));
+    moves.AppendInPlace(Move(103, -52, 3));
+    moves.AppendInPlace(Move(101, -51, 7));
+    moves.SortInPlace();
+    assert(moves.Get(0) == Move(98, -47) && moves.getScore(0) == 9);
+    assert(moves.Get(1) == Move(101, -51));
+    // Equal scores keep their insertion order
+    assert(moves.Get(2) == Move(100, -50) && moves.Get(3) == Move(103, -52));
+    
+    moves.Swap(0, 3);
+    moves.SortInPlace(1);
+    assert(moves.Get(0) == Move(103, -52));
+    assert(moves.scores()[1] == 9 && moves.scores()[2] == 7);
+    
+    bool threw = false;
+    try {
+        moves.AppendInPlace(Move(100 + PackedMove::COORD_MAX + 1, 0));
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    TranspositionTable tt(1);
+    tt.store(42, 10, 3, TTFlag::EXACT, Move(-7, 12));
+    auto pvMove = tt.getPVMove(42);
+    assert(pvMove.has_value() && pvMove->x == -7 && pvMove->y == 12);
+    
+    std::cout << "  ✓ Packed moves passed\n";
+}
+
+void testParallelScoring() {
+    std::cout << "Testing parallel candidate scoring...\n";
+    
+    ThreadPool pool(3);
+    std::vector<int> squares(1000);
+    pool.parallelFor(1000, 7, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            squares[i] = i * i;
+        }
+    });
+    for (int i = 0; i < 1000; ++i) {
+        assert(squares[i] == i * i);
+    }
+    
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    board.makeMove(1, 1, Player::O);
+    board.makeMove(3, -2, Player::X);
+    board.makeMove(-2, 2, Player::O);
+    board.makeMove(2, 0, Player::X);
+    
+    int minCells = Config::PARALLEL_SCORING_MIN_CELLS;
+    Config::PARALLEL_SCORING_MIN_CELLS = 1;
+    MoveGenerator serial(5);
+    MoveGenerator parallel(5);
+    parallel.setScoringPool(&pool);
+    MoveList expected = serial.generateCandidates(board, Player::O);
+    MoveList actual = parallel.generateCandidates(board, Player::O, true);
+    Config::PARALLEL_SCORING_MIN_CELLS = minCells;
+    assert(expected.GetLength() == actual.GetLength());
+    for (int i = 0; i < expected.GetLength(); ++i) {
+        assert(expected.Get(i) == actual.Get(i));
+        assert(expected.getScore(i) == actual.getScore(i));
+    }
+    
+    std::cout << "  ✓ Parallel candidate scoring passed\n";
+}
+
+void testTaskGroups() {
+    std::cout << "Testing task groups...\n";
+    
+    ThreadPool::Options options;
+    options.threads = 2;
+    options.spinIterations = 0;
+    ThreadPool pool(options);
+    
+    std::atomic<int> sum(0);
+    {
+        TaskGroup group(pool);
+        for (int i = 1; i <= 100; ++i) {
+            group.run([&sum, i] { sum += i; }, i % 2 ? TaskPriority::LOW : TaskPriority::HIGH);
+        }
+        group.waitFor(10);
+        assert(group.pending() <= 10);
+        group.wait();
+    }
+    assert(sum == 5050);
+    
+    TaskGroup failing(pool);
+    failing.run([] { throw std::runtime_error("task failed"); });
+    bool threw = false;
+    try {
+        failing.wait();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    CancellationToken token;
+    TaskGroup cancelled(pool, token);
+    token.cancel();
+    std::atomic<int> ran(0);
+    for (int i = 0; i < 10; ++i) {
+        cancelled.run([&ran] { ran++; });
+    }
+    cancelled.wait();
+    assert(ran == 0 && cancelled.isCancelled());
+    
+    // Nested parallel sections complete even when every worker waits
+    std::atomic<int> inner(0);
+    pool.parallelFor(4, 1, [&](int, int) {
+        pool.parallelFor(8, 1, [&](int begin, int end) { inner += end - begin; });
+    });
+    assert(inner == 32);
+    
+    std::cout << "  ✓ Task groups passed\n";
+}
+
+void testSplitPointSearch() {
+    std::cout << "Testing split point search...\n";
+    
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    board.makeMove(1, 1, Player::O);
+    board.makeMove(1, 0, Player::X);
+    board.makeMove(2, 2, Player::O);
+    
+    SearchOptions serialOptions;
+    serialOptions.maxDepth = 3;
+    serialOptions.useQuiescence = false;
+    serialOptions.useThreatSolver = false;
+    SearchOptions splitOptions = serialOptions;
+    splitOptions.parallelSearch = true;
+    splitOptions.splitMinDepth = 2;
+    splitOptions.reproducibleSplits = true;
+    
+    SearchEngine serial(5, serialOptions);
+    Move expected = serial.findBestMove(board, Player::X, 100000);
+    int expectedNodes = serial.getStats().getNodesSearched();
+    
+    for (int run = 0; run < 2; ++run) {
+        SearchEngine reproducible(5, splitOptions);
+        Move move = reproducible.findBestMove(board, Player::X, 100000);
+        assert(move == expected);
+        assert(reproducible.getStats().getNodesSearched() == expectedNodes);
+    }
+    
+    ThreadPool pool(3);
+    splitOptions.reproducibleSplits = false;
+    SearchEngine parallel(5, splitOptions);
+    parallel.setThreadPool(&pool);
+    Move move = parallel.findBestMove(board, Player::X, 100000);
+    SearchStats stats = parallel.getStats();
+    assert(board.isEmpty(move.x, move.y));
+    assert(stats.getNodesSearched() > 0 && stats.getDepthReached() == 3);
+    assert(stats.getPvLength() > 0 && stats.getPrincipalVariation(0) == move);
+    
+    std::cout << "  ✓ Split point search passed\n";
+}
+
+void testParallelThreatSolver() {
+    std::cout << "Testing parallel threat solver...\n";
+    
+    ThreadPool pool(3);
+    const int xs[3][5][2] = {
+        {{0, 0}, {1, 0}, {2, 0}, {0, 1}, {0, 2}},
+        {{0, 0}, {1, 1}, {2, 2}, {0, 2}, {2, 0}},
+        {{0, 0}, {1, 0}, {0, 1}, {5, 5}, {-9, 9}}
+    };
+    
+    for (int position = 0; position < 3; ++position) {
+        SparseBoard board(5);
+        for (const auto& cell : xs[position]) {
+            board.makeMove(cell[0], cell[1], Player::X);
+        }
+        board.makeMove(9, 9, Player::O);
+        board.makeMove(9, -9, Player::O);
+        board.makeMove(-9, -9, Player::O);
+        
+        ThreatSolver serial(5);
+        ThreatSolver parallel(5);
+        parallel.setThreadPool(&pool);
+        auto expected = serial.findForcedWin(board, Player::X, 4);
+        auto actual = parallel.findForcedWin(board, Player::X, 4);
+        assert(expected.has_value() == actual.has_value());
+        if (expected.has_value()) {
+            assert(*expected == *actual);
+        }
+        assert(expected.has_value() == (position < 2));
+    }
+    
+    std::cout << "  ✓ Parallel threat solver passed\n";
+}
+
+void testSolverCache() {
+    std::cout << "Testing solver cache...\n";
+    
+    SolverCache cache(1);
+    cache.store(42, Player::X, 3, true, Move(1, -2));
+    assert(cache.probe(42, Player::X, 3).getResult() == SolverResult::WIN);
+    assert(cache.probe(42, Player::X, 5).getResult() == SolverResult::WIN);
+    assert(cache.probe(42, Player::X, 2).getResult() == SolverResult::UNKNOWN);
+    assert(cache.probe(42, Player::O, 3).getResult() == SolverResult::UNKNOWN);
+    auto hit = cache.probe(42, Player::X, 4);
+    assert(hit.hasThreat() && hit.getThreat() == Move(1, -2) && hit.getRemaining() == 3);
+    
+    // A refutation never overwrites a proof of the same position.
+    cache.store(42, Player::X, 2, false);
+    assert(cache.probe(42, Player::X, 3).getResult() == SolverResult::WIN);
+    
+    cache.store(7, Player::O, 4, false);
+    assert(cache.probe(7, Player::O, 4).getResult() == SolverResult::NO_WIN);
+    assert(cache.probe(7, Player::O, 1).getResult() == SolverResult::NO_WIN);
+    assert(cache.probe(7, Player::O, 5).getResult() == SolverResult::UNKNOWN);
+    
+    cache.clear();
+    assert(cache.probe(42, Player::X, 3).getResult() == SolverResult::UNKNOWN);
+    
+    // Repeated queries are answered from the cache with the same move.
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    board.makeMove(1, 0, Player::X);
+    board.makeMove(2, 0, Player::X);
+    board.makeMove(0, 1, Player::X);
+    board.makeMove(0, 2, Player::X);
+    board.makeMove(9, 9, Player::O);
+    board.makeMove(9, -9, Player::O);
+    board.makeMove(-9, -9, Player::O);
+    
+    ThreatSolver solver(5);
+    auto first = solver.findForcedWin(board, Player::X, 4);
+    auto second = solver.findForcedWin(board, Player::X, 4);
+    assert(first.has_value() && second.has_value() && *first == *second);
+#ifdef ENGINE_INSTRUMENTATION
+    assert(solver.getNodesSearched() == 1);
+#endif
+
+    std::cout << "  ✓ Solver cache passed\n";
+}
+
+void testSearchCounters() {
+#ifdef ENGINE_INSTRUMENTATION
+    std::cout << "Testing search counters...\n";
+    
+    SparseBoard board(5);
+    SearchEngine engine(5);
+    
+    board.makeMove(0, 0, Player::X);
+    board.makeMove(1, 1, Player::O);
+    
+    engine.findBestMove(board, Player::X, 500);
+    SearchStats stats = engine.getStats();
+    const SearchCounters& counters = stats.getCounters();
+    
+    assert(counters.tt_probes > 0);
+    assert(counters.tt_hits <= counters.tt_probes);
+    assert(counters.tt_cutoffs <= counters.tt_hits);
+    assert(counters.candidate_lists > 0);
+    assert(counters.candidate_max <= static_cast<uint64_t>(Config::TOP_K_CANDIDATES));
+    
+    std::cout << "  ✓ Search counters passed\n";
+#endif
+}
+
+void testCanonicalPosition() {
+    std::cout << "Testing canonical position...\n";
+    
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    board.makeMove(1, 0, Player::O);
+    board.makeMove(0, 2, Player::X);
+    
+    // Rotated by 90 degrees, mirrored and shifted by (7, -3)
+    SparseBoard transformed(5);
+    transformed.makeMove(7, -3, Player::X);
+    transformed.makeMove(7, -2, Player::O);
+    transformed.makeMove(9, -3, Player::X);
+    
+    CanonicalPosition a(board, Player::O);
+    CanonicalPosition b(transformed, Player::O);
+    assert(a.getKey() == b.getKey());
+    assert(a.getKey() != CanonicalPosition(board, Player::X).getKey());
+    
+    Position canonical = a.toCanonical(1, 1);
+    Position back = a.fromCanonical(canonical.x, canonical.y);
+    assert(back.x == 1 && back.y == 1);
+    Position mapped = b.fromCanonical(canonical.x, canonical.y);
+    assert(mapped.x == 8 && mapped.y == -2);
+    
+    std::cout << "  ✓ Canonical position passed\n";
+}
+
+void testOpeningBook() {
+    std::cout << "Testing opening book...\n";
+    
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    CanonicalPosition canonical(board, Player::O);
+    Position strong = canonical.toCanonical(1, 1);
+    Position weak = canonical.toCanonical(3, 0);
+    
+    std::vector<BookEntry> entries;
+    entries.push_back({canonical.getKey(), weak.x, weak.y, 50, 1});
+    entries.push_back({canonical.getKey(), strong.x, strong.y, 10, 4});
+    entries.push_back({canonical.getKey() ^ 1, 0, 0, 0, 9});
+    
+    const std::string path = "engine_tests_book.bin";
+    assert(OpeningBook::write(path, 5, 4, entries));
+    
+    OpeningBook book;
+    assert(book.open(path));
+    assert(book.size() == 3 && book.getMaxPly() == 4);
+    
+    // Same position shifted elsewhere on the infinite board
+    SparseBoard shifted(5);
+    shifted.makeMove(-20, 11, Player::X);
+    SearchEngine engine(5);
+    engine.setOpeningBook(&book);
+    Move move = engine.findBestMove(shifted, Player::O, 1000);
+    assert(engine.getStats().getDecisionType() == DecisionType::OPENING_BOOK);
+    assert(move.x == -19 && move.y == 12);
+    
+    SparseBoard otherLength(4);
+    otherLength.makeMove(0, 0, Player::X);
+    assert(!book.probe(otherLength, Player::O).has_value());
+    
+    book.close();
+    std::remove(path.c_str());
+    
+    std::cout << "  ✓ Opening book passed\n";
+}
+
+// Small deterministic weights so the float and quantized networks can be
+// compared directly.
+static NnueNetwork makeTestNetwork(std::vector<float>& inputWeights, std::vector<float>& inputBias,
+                                   std::vector<float>& outputWeights) {
+    inputWeights.resize(static_cast<size_t>(NnueNetwork::FEATURES) * NnueNetwork::HIDDEN);
+    inputBias.resize(NnueNetwork::HIDDEN);
+    outputWeights.resize(NnueNetwork::HIDDEN);
+    uint32_t state = 12345;
+    auto next = [&state] {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / static_cast<float>(1u << 24) - 0.5f;
+    };
+    for (auto& weight : inputWeights) weight = 0.2f * next();
+    for (auto& weight : inputBias) weight = 0.5f + 0.2f * next();
+    for (auto& weight : outputWeights) weight = 2.0f * next();
+    return NnueNetwork::fromFloat(5, inputWeights, inputBias, outputWeights);
+}
+
+void testNnueEvaluation() {
+    std::cout << "Testing NNUE evaluation...\n";
+    
+    std::vector<float> inputWeights, inputBias, outputWeights;
+    NnueNetwork network = makeTestNetwork(inputWeights, inputBias, outputWeights);
+    
+    SparseBoard board(5);
+    const int stones[][2] = {{0, 0}, {1, 1}, {1, 0}, {-2, 3}, {2, -1}, {9, 0}, {3, 3}, {-1, -4}};
+    NnueAccumulator incremental;
+    incremental.refresh(network, board, 0, 0);
+    for (int i = 0; i < 8; ++i) {
+        Player player = (i % 2 == 0) ? Player::X : Player::O;
+        board.makeMove(stones[i][0], stones[i][1], player);
+        incremental.add(network, stones[i][0], stones[i][1], player);
+    }
+    
+    // Incremental updates match a full refresh, including a stone outside
+    // the window.
+    NnueAccumulator full;
+    full.refresh(network, board, 0, 0);
+    for (Player side : {Player::X, Player::O}) {
+        assert(std::equal(full.values(side), full.values(side) + NnueNetwork::HIDDEN,
+                          incremental.values(side)));
+    }
+    int score = network.evaluate(full, Player::X);
+    assert(network.evaluate(full, Player::O) == -score);
+    
+    board.makeMove(4, 4, Player::X);
+    incremental.add(network, 4, 4, Player::X);
+    assert(network.evaluate(incremental, Player::X) != score);
+    board.undoMove(4, 4);
+    incremental.remove(network, 4, 4, Player::X);
+    assert(network.evaluate(incremental, Player::X) == score);
+    
+    // Quantization stays close to the float network.
+    float hidden[2][NnueNetwork::HIDDEN];
+    for (int side = 0; side < 2; ++side) {
+        std::copy(inputBias.begin(), inputBias.end(), hidden[side]);
+    }
+    for (int i = 0; i < 8; ++i) {
+        bool xStone = i % 2 == 0;
+        for (int side = 0; side < 2; ++side) {
+            int feature = NnueNetwork::featureIndex(stones[i][0], stones[i][1], xStone == (side == 0));
+            for (int j = 0; feature >= 0 && j < NnueNetwork::HIDDEN; ++j) {
+                hidden[side][j] += inputWeights[static_cast<size_t>(feature) * NnueNetwork::HIDDEN + j];
+            }
+        }
+    }
+    double logit = 0.0;
+    for (int j = 0; j < NnueNetwork::HIDDEN; ++j) {
+        float x = std::min(std::max(hidden[0][j], 0.0f), 1.0f);
+        float o = std::min(std::max(hidden[1][j], 0.0f), 1.0f);
+        logit += outputWeights[j] * (x - o);
+    }
+    assert(std::abs(score - logit * NnueNetwork::SCORE_SCALE) < 0.05 * NnueNetwork::SCORE_SCALE);
+    
+    const std::string path = "engine_tests_nnue.bin";
+    assert(network.write(path));
+    NnueNetwork loaded;
+    assert(loaded.read(path));
+    assert(loaded.getWinLength() == 5);
+    assert(loaded.evaluate(full, Player::X) == score);
+    
+    // Engines built after install search with it, unless told otherwise.
+    assert(NnueNetwork::load(path));
+    std::remove(path.c_str());
+    assert(NnueNetwork::forWinLength(5) != nullptr);
+    assert(NnueNetwork::forWinLength(4) == nullptr);
+    
+    SparseBoard position(5);
+    position.makeMove(0, 0, Player::X);
+    position.makeMove(1, 1, Player::O);
+    position.makeMove(1, 0, Player::X);
+    position.makeMove(2, 2, Player::O);
+    SearchOptions options;
+    options.maxDepth = 3;
+    options.useThreatSolver = false;
+    SearchEngine first(5, options);
+    SearchEngine second(5, options);
+    Move move = first.findBestMove(position, Player::X, 100000);
+    assert(position.isEmpty(move.x, move.y));
+    assert(second.findBestMove(position, Player::X, 100000) == move);
+    assert(second.getStats().getNodesSearched() == first.getStats().getNodesSearched());
+    
+    ThreadPool pool(3);
+    options.parallelSearch = true;
+    options.splitMinDepth = 2;
+    SearchEngine parallel(5, options);
+    parallel.setThreadPool(&pool);
+    Move parallelMove = parallel.findBestMove(position, Player::X, 100000);
+    assert(position.isEmpty(parallelMove.x, parallelMove.y));
+    assert(parallel.getStats().getDepthReached() > 0);
+    
+    NnueNetwork::clearInstalled();
+    assert(NnueNetwork::forWinLength(5) == nullptr);
+    
+    std::cout << "  ✓ NNUE evaluation passed\n";
+}
+
+void testAnalysis() {
+    std::cout << "Testing MultiPV analysis...\n";
+    
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    board.makeMove(1, 1, Player::O);
+    board.makeMove(1, 0, Player::X);
+    board.makeMove(2, 2, Player::O);
+    int stones = board.getOccupiedPositions().GetLength();
+    
+    SearchOptions options;
+    options.maxDepth = 3;
+    options.useThreatSolver = false;
+    SearchEngine engine(5, options);
+    std::vector<int> depths;
+    auto lines = engine.analyze(board, Player::X, 3, 100000, [&](const AnalysisInfo& info) {
+        assert(!info.lines.empty() && info.nodes > 0);
+        depths.push_back(info.depth);
+    });
+    
+    assert(lines.size() == 3);
+    assert(board.getOccupiedPositions().GetLength() == stones);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        assert(board.isEmpty(lines[i].move.x, lines[i].move.y));
+        assert(!lines[i].pv.empty() && lines[i].pv[0] == lines[i].move);
+        for (size_t j = 0; j < i; ++j) {
+            assert(!(lines[j].move == lines[i].move));
+            assert(lines[j].score >= lines[i].score);
+        }
+    }
+    assert(!depths.empty() && depths.front() == 1);
+    for (size_t i = 1; i < depths.size(); ++i) {
+        assert(depths[i] == depths[i - 1] + 1);
+    }
+    assert(engine.getStats().getDepthReached() == depths.back());
+    assert(engine.getStats().getFinalScore() == lines[0].score);
+    
+    // A win leaves the generator a single candidate, so fewer lines come back.
+    SparseBoard four(5);
+    for (int x = 0; x < 4; ++x) {
+        four.makeMove(x, 0, Player::X);
+        four.makeMove(x, 5, Player::O);
+    }
+    auto winning = engine.analyze(four, Player::X, 2, 100000);
+    assert(winning.size() == 1);
+    assert(winning[0].move.y == 0 && (winning[0].move.x == 4 || winning[0].move.x == -1));
+    
+    std::cout << "  ✓ MultiPV analysis passed\n";
+}
+
+// Plays line from board, alternating from player; false on an occupied cell.
+static bool replaysLegally(SparseBoard board, Player player, const std::vector<Move>& line) {
+    for (const auto& move : line) {
+        if (!board.makeMove(move.x, move.y, player)) {
+            return false;
+        }
+        player = (player == Player::X) ? Player::O : Player::X;
+    }
+    return true;
+}
+
+void testPrincipalVariation() {
+    std::cout << "Testing principal variation...\n";
+    
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    board.makeMove(1, 1, Player::O);
+    board.makeMove(1, 0, Player::X);
+    board.makeMove(2, 2, Player::O);
+    
+    SearchOptions options;
+    options.maxDepth = 4;
+    options.useQuiescence = false;
+    options.useThreatSolver = false;
+    SearchEngine serial(5, options);
+    Move move = serial.findBestMove(board, Player::X, 100000);
+    SearchStats stats = serial.getStats();
+    std::vector<Move> line;
+    for (int i = 0; i < stats.getPvLength(); ++i) {
+        line.push_back(stats.getPrincipalVariation(i));
+    }
+    assert(!line.empty() && line[0] == move);
+    assert(replaysLegally(board, Player::X, line));
+    
+    // Lines built by split-point siblings come out the same.
+    options.parallelSearch = true;
+    options.splitMinDepth = 2;
+    options.reproducibleSplits = true;
+    SearchEngine split(5, options);
+    assert(split.findBestMove(board, Player::X, 100000) == move);
+    assert(split.getStats().getPvLength() == stats.getPvLength());
+    for (int i = 0; i < stats.getPvLength(); ++i) {
+        assert(split.getStats().getPrincipalVariation(i) == line[i]);
+    }
+    
+    for (const auto& analysis : split.analyze(board, Player::X, 3, 100000)) {
+        assert(replaysLegally(board, Player::X, analysis.pv));
+    }
+    
+    // An exact entry keeps its slot against a bound for another position
+    // that hashes there, but not against another exact entry.
+    TranspositionTable tt(1);
+    const uint64_t first = 5;
+    const uint64_t second = 5 + (1ULL << 40);
+    tt.store(first, 10, 2, TTFlag::EXACT, Move(3, 4));
+    tt.store(second, 20, 6, TTFlag::LOWER_BOUND, Move(-1, 2));
+    assert(tt.getPVMove(first).has_value() && tt.getPVMove(first)->x == 3);
+    assert(!tt.probe(second, 6, 0, 1).isFound());
+    tt.store(second, 20, 6, TTFlag::EXACT, Move(-1, 2));
+    assert(tt.probe(second, 6, 0, 1).isFound());
+    assert(!tt.getPVMove(first).has_value());
+    
+    // Moves on an axis are hash moves like any other.
+    tt.store(77, 0, 1, TTFlag::EXACT, Move(0, 7));
+    assert(tt.getPVMove(77).has_value() && tt.getPVMove(77)->y == 7);
+    
+    std::cout << "  ✓ Principal variation passed\n";
+}
+
 int main() {
     std::cout << "=== Engine Tests ===\n\n";
     
     testImmediateWin();
     testImmediateBlock();
+    testTacticalMoves();
+    testCandidateScoreCache();
     testBasicSearch();
     testSearchStats();
     testTranspositionTable();
+    testTranspositionSnapshot();
+    testEvalCache();
+    testPackedMoves();
+    testParallelScoring();
+    testTaskGroups();
+    testSplitPointSearch();
+    testParallelThreatSolver();
+    testSolverCache();
+    testSearchCounters();
+    testCanonicalPosition();
+    testOpeningBook();
+    testNnueEvaluation();
+    testAnalysis();
+    testPrincipalVariation();
     
     std::cout << "\nAll engine tests passed!\n";
     return 0;
@@ -1,7 +1,11 @@
 #include "engine/evaluator.h"
+#include "engine/eval_weights.h"
 #include "board/sparse_board.h"
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <sstream>
+#include <vector>
 
 using namespace tictactoe;
 
@@ -108,6 +112,79 @@ void testWinMove() {
     std::cout << "  ✓ Win move evaluation passed\n";
 }
 
+void testWeightsRoundTrip() {
+    std::cout << "Testing evaluation weights round trip...\n";
+    
+    EvalWeights tuned = EvalWeights::defaults(5);
+    tuned.open[3] = 123456;
+    tuned.closed[2] = 789;
+    tuned.brokenPercent = 40;
+    tuned.forkBonus = 4321;
+    
+    std::vector<EvalWeights> sets = {EvalWeights::defaults(3), tuned};
+    std::stringstream stream;
+    EvalWeights::write(stream, sets);
+    
+    std::vector<EvalWeights> loaded;
+    assert(EvalWeights::read(stream, loaded));
+    assert(loaded.size() == 2);
+    assert(loaded[0].winLength == 3);
+    assert(loaded[1].winLength == 5);
+    assert(loaded[1].open == tuned.open);
+    assert(loaded[1].closed == tuned.closed);
+    assert(loaded[1].brokenPercent == 40);
+    assert(loaded[1].forkBonus == 4321);
+    
+    std::stringstream bad("win_length 5\nopen 1 2\n");
+    std::vector<EvalWeights> rejected;
+    assert(!EvalWeights::read(bad, rejected));
+    
+    // Installed sets reach evaluators built afterwards, and only for
+    // their own win length.
+    EvalWeights::install(tuned);
+    assert(Evaluator(5).getPatternScore(3, true) == 123456);
+    assert(Evaluator(4).getPatternScore(3, true) == EvalWeights::defaults(4).open[3]);
+    EvalWeights::clearInstalled();
+    assert(Evaluator(5).getPatternScore(3, true) == EvalWeights::defaults(5).open[3]);
+    
+    std::cout << "  ✓ Evaluation weights round trip passed\n";
+}
+
+void testPatternFeatures() {
+    std::cout << "Testing pattern features...\n";
+    
+    SparseBoard board(5);
+    board.makeMove(0, 0, Player::X);
+    board.makeMove(1, 0, Player::X);
+    board.makeMove(2, 0, Player::X);
+    board.makeMove(0, 2, Player::O);
+    board.makeMove(1, 3, Player::O);
+    board.makeMove(5, 5, Player::X);
+    
+    // Without broken patterns the evaluation is the features dotted with
+    // the weights.
+    Evaluator evaluator(5);
+    std::vector<double> features;
+    evaluator.patternFeatures(board, Player::X, features);
+    assert(features.size() == 2 * EvalWeights::MAX_LENGTH);
+    
+    const EvalWeights& weights = evaluator.getWeights();
+    double dot = 0.0;
+    for (int k = 1; k < 5; ++k) {
+        dot += features[k] * weights.open[k];
+        dot += features[EvalWeights::MAX_LENGTH + k] * weights.closed[k];
+    }
+    assert(std::lround(dot) == evaluator.evaluatePosition(board, Player::X));
+    
+    std::vector<double> mirrored;
+    evaluator.patternFeatures(board, Player::O, mirrored);
+    for (size_t i = 0; i < features.size(); ++i) {
+        assert(mirrored[i] == -features[i]);
+    }
+    
+    std::cout << "  ✓ Pattern features passed\n";
+}
+
 int main() {
     std::cout << "=== Evaluator Tests ===\n\n";
     
@@ -116,6 +193,8 @@ int main() {
     testEvaluation();
     testWinMove();
     testScalingForDifferentN();
+    testWeightsRoundTrip();
+    testPatternFeatures();
     
     std::cout << "\nAll evaluator tests passed!\n";
     return 0;
@@ -0,0 +1,328 @@
+#include "cli/request_handler.h"
+#include "cli/json_reader.h"
+#include "cli/binary_protocol.h"
+#include "cli/batch_runner.h"
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+using namespace tictactoe;
+
+void testJsonRequestParsing() {
+    std::cout << "Testing JSON request parsing...\n";
+    
+    Request request = parseJsonRequest(
+        "{\"command\": \"make_move\", \"win_length\": 4, \"meta\": {\"a\": [1, {\"b\": \"]\"}]},"
+        " \"moves\": [{\"x\": -3, \"y\": 12, \"player\": \"X\"}, {\"player\": \"O\", \"y\": 0, \"x\": 5},"
+        " {\"x\": 1}], \"current_player\": \"X\", \"time_ms\": 250, \"x\": 7, \"y\": -8, \"id\": 42}");
+    
+    assert(request.command == "make_move");
+    assert(request.winLength == 4);
+    assert(request.timeMs == 250);
+    assert(request.currentPlayer == "X");
+    assert(request.id == "42");
+    assert(request.moves.size() == 2);
+    assert(request.moves[0].x == -3 && request.moves[0].y == 12);
+    assert(request.moves[1].x == 5 && request.moves[1].player == Player::O);
+    assert(request.hasMove && request.moveX == 7 && request.moveY == -8);
+    
+    Request nullPlayer = parseJsonRequest("{\"command\": \"get_state\", \"current_player\": null}");
+    assert(nullPlayer.currentPlayer.empty());
+    
+    bool threw = false;
+    try {
+        parseJsonRequest("{\"command\": \"get_state\", \"moves\": [");
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    std::cout << "  ✓ JSON request parsing passed\n";
+}
+
+void testJsonResponseFormat() {
+    std::cout << "Testing JSON response format...\n";
+    
+    EngineCache engines;
+    std::ostringstream out;
+    int status = handleRequest(
+        "{\"command\": \"make_move\", \"win_length\": 3, \"current_player\": \"X\","
+        " \"moves\": [{\"x\": 0, \"y\": 0, \"player\": \"X\"}, {\"x\": 0, \"y\": 1, \"player\": \"O\"},"
+        " {\"x\": 1, \"y\": 0, \"player\": \"X\"}, {\"x\": 1, \"y\": 1, \"player\": \"O\"}],"
+        " \"x\": 2, \"y\": 0}", out, engines);
+    
+    assert(status == 0);
+    std::string json = out.str();
+    assert(json.find("\"success\": true") != std::string::npos);
+    assert(json.find("\"move\": {\"x\": 2, \"y\": 0, \"player\": \"X\"}") != std::string::npos);
+    assert(json.find("\"game_over\": true") != std::string::npos);
+    assert(json.find("\"winner\": \"X\"") != std::string::npos);
+    
+    std::ostringstream error;
+    assert(handleRequest("{\"command\": \"make_move\", \"x\": 0, \"y\": 0,"
+                         " \"moves\": [{\"x\": 0, \"y\": 0, \"player\": \"X\"}]}", error, engines) == 1);
+    assert(error.str() == "{\n  \"success\": false,\n  \"error\": \"Invalid move: (0, 0)\"\n}\n");
+    
+    std::cout << "  ✓ JSON response format passed\n";
+}
+
+void testBinaryRequestRoundTrip() {
+    std::cout << "Testing binary request round trip...\n";
+    
+    Request request;
+    request.command = "ai_move";
+    request.id = "game-7";
+    request.winLength = 5;
+    request.timeMs = 1500;
+    request.currentPlayer = "O";
+    for (int i = 0; i < 300; ++i) {
+        Player player = (i % 2 == 0) ? Player::X : Player::O;
+        request.moves.push_back({(i * 7) % 41 - 20, (i * 13) % 37 - 18, player});
+    }
+    request.hasMove = true;
+    request.moveX = -100000;
+    request.moveY = 2147483647;
+    
+    std::string payload;
+    binary::encodeRequest(request, payload);
+    assert(payload.size() < request.moves.size() * 4);
+    
+    std::stringstream stream;
+    binary::writeFrame(stream, payload);
+    binary::writeFrame(stream, payload);
+    
+    std::string frame;
+    int frames = 0;
+    while (binary::readFrame(stream, frame)) {
+        Request decoded = binary::decodeRequest(frame);
+        assert(decoded.command == request.command);
+        assert(decoded.id == request.id);
+        assert(decoded.winLength == request.winLength);
+        assert(decoded.timeMs == request.timeMs);
+        assert(decoded.currentPlayer == request.currentPlayer);
+        assert(decoded.moves.size() == request.moves.size());
+        for (size_t i = 0; i < request.moves.size(); ++i) {
+            assert(decoded.moves[i].x == request.moves[i].x);
+            assert(decoded.moves[i].y == request.moves[i].y);
+            assert(decoded.moves[i].player == request.moves[i].player);
+        }
+        assert(decoded.hasMove && decoded.moveX == request.moveX && decoded.moveY == request.moveY);
+        assert(decoded.gameId.empty());
+        frames++;
+    }
+    assert(frames == 2);
+    
+    bool threw = false;
+    try {
+        binary::decodeRequest(payload.substr(0, payload.size() / 2));
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    request.gameId = "session-1";
+    request.basePly = 299;
+    request.baseHash = 0xfedcba9876543210ULL;
+    payload.clear();
+    binary::encodeRequest(request, payload);
+    Request withSession = binary::decodeRequest(payload);
+    assert(withSession.gameId == request.gameId);
+    assert(withSession.basePly == request.basePly);
+    assert(withSession.baseHash == request.baseHash);
+    
+    std::cout << "  ✓ Binary request round trip passed\n";
+}
+
+void testBinaryResponse() {
+    std::cout << "Testing binary response encoding...\n";
+    
+    Request request;
+    request.command = "make_move";
+    request.winLength = 3;
+    request.currentPlayer = "O";
+    request.moves.push_back({4, 4, Player::X});
+    request.moves.push_back({-2, 3, Player::O});
+    request.moves.push_back({5, -1, Player::X});
+    request.hasMove = true;
+    request.moveX = 0;
+    request.moveY = 0;
+    
+    EngineCache engines;
+    Response response = executeRequest(request, engines);
+    assert(response.success);
+    
+    std::string payload;
+    binary::encodeResponse(response, payload);
+    
+    binary::Decoder decoder(payload);
+    assert(decoder.readByte() == binary::PROTOCOL_VERSION);
+    assert(decoder.readByte() == 0);
+    uint8_t flags = decoder.readByte();
+    assert(flags & binary::HAS_MOVE);
+    assert(!(flags & binary::HAS_STATS));
+    assert(!(flags & binary::GAME_OVER));
+    assert(decoder.readByte() == 0);
+    assert(decoder.readInt() == 0 && decoder.readInt() == 0);
+    assert(decoder.readByte() == static_cast<uint8_t>(Player::O));
+    for (int i = 0; i < 4; ++i) {
+        decoder.readInt();
+    }
+    assert(decoder.readVarint() == 4);
+    int firstPacked = static_cast<int>(decoder.readVarint());
+    assert((firstPacked & 3) == static_cast<int>(Player::X));
+    assert(decoder.readInt() == -1);
+    
+    std::string errorPayload;
+    binary::encodeResponse(makeError("Invalid move: (0, 0)"), errorPayload);
+    binary::Decoder errorDecoder(errorPayload);
+    errorDecoder.readByte();
+    assert(errorDecoder.readByte() == 1);
+    assert(errorDecoder.readBytes() == "Invalid move: (0, 0)");
+    assert(errorDecoder.atEnd());
+    
+    std::cout << "  ✓ Binary response encoding passed\n";
+}
+
+void testSessionDeltas() {
+    std::cout << "Testing session deltas...\n";
+    
+    EngineCache engines;
+    SessionStore sessions(2);
+    
+    Request full;
+    full.command = "get_state";
+    full.gameId = "g1";
+    full.winLength = 3;
+    full.moves.push_back({0, 0, Player::X});
+    full.moves.push_back({5, 5, Player::O});
+    Response first = executeRequest(full, engines, sessions);
+    assert(first.success && first.hasPosition && first.ply == 2);
+    
+    SparseBoard replay(3);
+    replay.makeMove(0, 0, Player::X);
+    replay.makeMove(5, 5, Player::O);
+    assert(first.hash == replay.getZobristHash());
+    
+    Request delta;
+    delta.command = "make_move";
+    delta.gameId = "g1";
+    delta.winLength = 3;
+    delta.basePly = 2;
+    delta.baseHash = first.hash;
+    delta.moves.push_back({1, 0, Player::X});
+    delta.moves.push_back({5, 6, Player::O});
+    delta.currentPlayer = "X";
+    delta.hasMove = true;
+    delta.moveX = 2;
+    delta.moveY = 0;
+    Response won = executeRequest(delta, engines, sessions);
+    assert(won.success && won.ply == 5);
+    assert(won.gameOver && won.winner == Player::X);
+    assert(won.cells.size() == 5);
+    replay.makeMove(1, 0, Player::X);
+    replay.makeMove(5, 6, Player::O);
+    replay.makeMove(2, 0, Player::X);
+    assert(won.hash == replay.getZobristHash());
+    assert(won.bbox.getMinX() == replay.getBoundingBox().getMinX());
+    assert(won.bbox.getMaxY() == replay.getBoundingBox().getMaxY());
+    
+    Request stale = delta;
+    stale.baseHash ^= 1;
+    Response mismatch = executeRequest(stale, engines, sessions);
+    assert(!mismatch.success && mismatch.resync && mismatch.ply == 5);
+    
+    Request rewind;
+    rewind.command = "get_state";
+    rewind.gameId = "g1";
+    rewind.winLength = 3;
+    rewind.basePly = 2;
+    rewind.baseHash = first.hash;
+    Response back = executeRequest(rewind, engines, sessions);
+    assert(back.success && back.ply == 2 && back.hash == first.hash && !back.isTerminal);
+    
+    Request bad = rewind;
+    bad.moves.push_back({0, 0, Player::O});
+    assert(!executeRequest(bad, engines, sessions).success);
+    assert(executeRequest(rewind, engines, sessions).ply == 2);
+    
+    Request other = rewind;
+    other.gameId = "g2";
+    other.basePly = 0;
+    other.baseHash = 0;
+    executeRequest(other, engines, sessions);
+    other.gameId = "g3";
+    executeRequest(other, engines, sessions);
+    assert(sessions.size() == 2);
+    assert(executeRequest(rewind, engines, sessions).resync);
+    
+    std::string json;
+    writeJsonResponse(back, json);
+    Request parsed = parseJsonRequest("{\"command\": \"get_state\", \"game_id\": \"g1\", \"base_ply\": 2,"
+                                      " \"base_hash\": \"" + formatHash(back.hash) + "\"}");
+    assert(parsed.gameId == "g1" && parsed.basePly == 2 && parsed.baseHash == back.hash);
+    assert(json.find("\"ply\": 2") != std::string::npos);
+    
+    std::cout << "  ✓ Session deltas passed\n";
+}
+
+void testCompactBatchLine() {
+    std::cout << "Testing compact batch line...\n";
+    
+    BatchOptions options;
+    Request request = compactToRequest("#p1 w=4 t=20 0,0 1,1 2,2", options);
+    assert(request.id == "p1");
+    assert(request.winLength == 4);
+    assert(request.timeMs == 20);
+    assert(request.moves.size() == 3);
+    assert(request.moves[1].player == Player::O);
+    assert(request.currentPlayer == "O");
+    
+    std::cout << "  ✓ Compact batch line passed\n";
+}
+
+void testAnalyzeRequest() {
+    std::cout << "Testing analyze request...\n";
+    
+    Request parsed = parseJsonRequest("{\"command\": \"analyze\", \"multi_pv\": 2}");
+    assert(parsed.command == "analyze" && parsed.multiPv == 2);
+    
+    EngineCache engines;
+    std::ostringstream out;
+    int status = handleRequest(
+        "{\"command\": \"analyze\", \"win_length\": 4, \"current_player\": \"O\", \"multi_pv\": 2,"
+        " \"time_ms\": 1500, \"moves\": [{\"x\": 0, \"y\": 0, \"player\": \"X\"}]}", out, engines);
+    assert(status == 0);
+    
+    // Progress lines come first, one per completed depth, then the response.
+    std::istringstream lines(out.str());
+    std::string line;
+    int infos = 0;
+    while (std::getline(lines, line) && line.rfind("{\"info\": {\"depth\": ", 0) == 0) {
+        assert(line.find("\"nps\": ") != std::string::npos);
+        infos++;
+    }
+    assert(infos > 0);
+    assert(line == "{");
+    
+    std::string json = out.str();
+    assert(json.find("\"analysis\": [{\"x\": ") != std::string::npos);
+    assert(json.find("\"cells\": [{\"x\": 0, \"y\": 0, \"player\": \"X\"}]") != std::string::npos);
+    assert(json.find("\"move\":") == std::string::npos);
+    
+    std::cout << "  ✓ Analyze request passed\n";
+}
+
+int main() {
+    std::cout << "=== Protocol Tests ===\n\n";
+    
+    testJsonRequestParsing();
+    testJsonResponseFormat();
+    testBinaryRequestRoundTrip();
+    testBinaryResponse();
+    testSessionDeltas();
+    testCompactBatchLine();
+    testAnalyzeRequest();
+    
+    std::cout << "\nAll protocol tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include "selfplay/game_record.h"
+#include "selfplay/sprt.h"
+#include "selfplay/match.h"
+#include "selfplay/texel_tuner.h"
+#include "selfplay/nnue_trainer.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+using namespace tictactoe;
+
+void testGameRecordRoundTrip() {
+    std::cout << "Testing game record round trip...\n";
+    
+    GameRecord record;
+    record.setTag("Event", "selfplay");
+    record.setTag("WinLength", "5");
+    for (int i = 0; i < 20; ++i) {
+        Player player = (i % 2 == 0) ? Player::X : Player::O;
+        record.moves.push_back({i, -i, player});
+    }
+    record.result = GameResult::O_WINS;
+    
+    std::stringstream stream;
+    writeGameRecord(stream, record);
+    writeGameRecord(stream, record);
+    
+    GameRecord parsed;
+    int count = 0;
+    while (readGameRecord(stream, parsed)) {
+        assert(parsed.getTag("Event") == "selfplay");
+        assert(parsed.getTag("WinLength") == "5");
+        assert(parsed.result == GameResult::O_WINS);
+        assert(parsed.moves.size() == record.moves.size());
+        assert(parsed.moves[7].x == 7 && parsed.moves[7].y == -7);
+        assert(parsed.moves[7].player == Player::O);
+        count++;
+    }
+    assert(count == 2);
+    
+    std::cout << "  ✓ Game record round trip passed\n";
+}
+
+void testSprt() {
+    std::cout << "Testing SPRT...\n";
+    
+    Sprt strong(0.0, 10.0);
+    for (int i = 0; i < 2000 && strong.getStatus() == SprtStatus::CONTINUE; ++i) {
+        strong.addResult(i % 3 == 0 ? 0.0 : 1.0);
+    }
+    assert(strong.getStatus() == SprtStatus::ACCEPT_H1);
+    assert(strong.getEloEstimate() > 0.0);
+    
+    Sprt weak(0.0, 10.0);
+    for (int i = 0; i < 2000 && weak.getStatus() == SprtStatus::CONTINUE; ++i) {
+        weak.addResult(i % 3 == 0 ? 1.0 : 0.0);
+    }
+    assert(weak.getStatus() == SprtStatus::ACCEPT_H0);
+    
+    std::cout << "  ✓ SPRT passed\n";
+}
+
+void testPlayGame() {
+    std::cout << "Testing self-play game...\n";
+    
+    SearchOptions options;
+    options.maxDepth = 2;
+    SearchEngine xEngine(4, options);
+    SearchEngine oEngine(4, options);
+    
+    auto openings = generateOpenings(2, 2, 2, 7);
+    assert(openings.size() == 2);
+    assert(openings[0].size() == 2);
+    
+    GameRecord record = playGame(xEngine, 50, oEngine, 50, openings[0], 4, 40);
+    assert(record.moves.size() >= 2);
+    assert(record.moves.size() <= 40);
+    
+    SparseBoard board(4);
+    for (const auto& move : record.moves) {
+        assert(board.makeMove(move.x, move.y, move.player));
+    }
+    if (record.result != GameResult::DRAW) {
+        const auto& last = record.moves.back();
+        assert(board.isWin(last.x, last.y, last.player));
+    }
+    
+    std::cout << "  ✓ Self-play game passed\n";
+}
+
+// X builds a row on y = 0 while O answers far away; the row is cut short
+// of the win length when O is meant to come back and win.
+static GameRecord makeTunerGame(int offset, GameResult result) {
+    GameRecord record;
+    record.setTag("WinLength", "4");
+    int xLength = result == GameResult::X_WINS ? 4 : 2;
+    int oLength = result == GameResult::O_WINS ? 4 : 3;
+    for (int i = 0; i < std::max(xLength, oLength); ++i) {
+        if (i < xLength) record.moves.push_back({offset + i, 0, Player::X});
+        if (i < oLength) record.moves.push_back({offset + i, 10, Player::O});
+    }
+    record.result = result;
+    return record;
+}
+
+void testTexelTuner() {
+    std::cout << "Testing Texel tuner...\n";
+    
+    TunerOptions options;
+    options.winLength = 4;
+    options.iterations = 40;
+    options.skipPlies = 0;
+    options.grain = 3;
+    
+    std::vector<GameRecord> games;
+    for (int i = 0; i < 4; ++i) {
+        games.push_back(makeTunerGame(3 * i, GameResult::X_WINS));
+        games.push_back(makeTunerGame(3 * i, GameResult::O_WINS));
+    }
+    GameRecord otherLength = games[0];
+    otherLength.setTag("WinLength", "5");
+    
+    EvalWeights start = EvalWeights::defaults(4);
+    ThreadPool serial(0);
+    ThreadPool parallel(2);
+    TexelTuner serialTuner(options, serial);
+    TexelTuner parallelTuner(options, parallel);
+    for (const auto& game : games) {
+        assert(serialTuner.addGame(game, start));
+        assert(parallelTuner.addGame(game, start));
+    }
+    assert(!serialTuner.addGame(otherLength, start));
+    assert(serialTuner.sampleCount() > 0);
+    
+    double scale = serialTuner.fitScale(start);
+    assert(scale > 0.0);
+    double before = serialTuner.loss(start, scale);
+    
+    std::stringstream log;
+    EvalWeights tuned = serialTuner.tune(start, log);
+    EvalWeights tunedInParallel = parallelTuner.tune(start, log);
+    assert(tuned.open == tunedInParallel.open);
+    assert(tuned.closed == tunedInParallel.closed);
+    assert(serialTuner.loss(tuned, serialTuner.fitScale(tuned)) <= before);
+    
+    std::cout << "  ✓ Texel tuner passed\n";
+}
+
+void testNnueTrainer() {
+    std::cout << "Testing NNUE trainer...\n";
+    
+    NnueTrainerOptions options;
+    options.winLength = 4;
+    options.epochs = 10;
+    options.batchSize = 16;
+    options.skipPlies = 0;
+    options.grain = 5;
+    
+    ThreadPool serial(0);
+    ThreadPool parallel(2);
+    NnueTrainer serialTrainer(options, serial);
+    NnueTrainer parallelTrainer(options, parallel);
+    for (int i = 0; i < 4; ++i) {
+        for (GameResult result : {GameResult::X_WINS, GameResult::O_WINS}) {
+            GameRecord game = makeTunerGame(3 * i, result);
+            assert(serialTrainer.addGame(game));
+            assert(parallelTrainer.addGame(game));
+        }
+    }
+    GameRecord otherLength = makeTunerGame(0, GameResult::X_WINS);
+    otherLength.setTag("WinLength", "5");
+    assert(!serialTrainer.addGame(otherLength));
+    // Every position is added in all eight orientations.
+    assert(serialTrainer.sampleCount() > 0 && serialTrainer.sampleCount() % 8 == 0);
+    
+    double before = serialTrainer.loss();
+    std::stringstream log;
+    double after = serialTrainer.train(log);
+    assert(after < before);
+    assert(parallelTrainer.train(log) == after);
+    
+    // The quantized network ranks an X win above an O win.
+    NnueNetwork network = serialTrainer.network();
+    assert(network.getWinLength() == 4);
+    SparseBoard board(4);
+    board.makeMove(0, 0, Player::X);
+    board.makeMove(0, 10, Player::O);
+    board.makeMove(1, 0, Player::X);
+    board.makeMove(1, 10, Player::O);
+    board.makeMove(2, 0, Player::X);
+    NnueAccumulator accumulator;
+    accumulator.refresh(network, board, 1, 5);
+    assert(network.evaluate(accumulator, Player::X) > 0);
+    
+    std::cout << "  ✓ NNUE trainer passed\n";
+}
+
+int main() {
+    std::cout << "=== Self-Play Tests ===\n\n";
+    
+    testGameRecordRoundTrip();
+    testSprt();
+    testPlayGame();
+    testTexelTuner();
+    testNnueTrainer();
+    
+    std::cout << "\nAll self-play tests passed!\n";
+    return 0;
+}
@@ -1,13 +1,16 @@
-from flask import Flask, render_template, request, jsonify
+from flask import Flask, Response, render_template, request, jsonify
 import secrets
 import json
-import subprocess
+import queue
 import os
+import threading
 import sys
 import logging
 from datetime import datetime
 from logging.handlers import RotatingFileHandler
 
+from engine_pool import EnginePool, EngineBusy, EngineUnavailable
+
 app = Flask(__name__)
 app.secret_key = secrets.token_hex(16)
 
@@ -41,9 +44,34 @@ else:
     WEB_CLI_PATH = os.path.join(BASE_DIR, '..', 'build', 'web_cli')
 
 
-def call_cpp_engine(command, win_length, moves, current_player, time_ms=5000, move_x=None, move_y=None):
-    logger.info(f"[C++ CALL] command={command}, win_length={win_length}, current_player={current_player}, "
-                f"moves_count={len(moves)}, time_ms={time_ms}, move=({move_x}, {move_y})")
+ENGINE_WORKERS = int(os.environ.get('ENGINE_WORKERS', os.cpu_count() or 1))
+ENGINE_MAX_QUEUED = int(os.environ.get('ENGINE_MAX_QUEUED', 16))
+ENGINE_DEADLINE_S = float(os.environ.get('ENGINE_DEADLINE_S', 30))
+
+engine_pool = None
+engine_pool_lock = threading.Lock()
+
+# game_id -> (ply, hash) of the position the engine worker last reported.
+# Requests send only the moves after that ply; a mismatch falls back to a
+# full replay.
+engine_sync = {}
+
+
+def get_engine_pool():
+    global engine_pool
+    with engine_pool_lock:
+        if engine_pool is None:
+            logger.info(f"[POOL] starting {ENGINE_WORKERS} engine workers, max_queued={ENGINE_MAX_QUEUED}")
+            engine_pool = EnginePool([WEB_CLI_PATH, '--serve'], ENGINE_WORKERS,
+                                     max_queued=ENGINE_MAX_QUEUED)
+        return engine_pool
+
+
+def call_cpp_engine(game_id, command, win_length, moves, current_player, time_ms=5000, move_x=None, move_y=None,
+                    multi_pv=None, on_info=None):
+    logger.info(f"[C++ CALL] game_id={game_id}, command={command}, win_length={win_length}, "
+                f"current_player={current_player}, moves_count={len(moves)}, time_ms={time_ms}, "
+                f"move=({move_x}, {move_y})")
     
     try:
         input_data = {
@@ -58,51 +86,52 @@ def call_cpp_engine(command, win_length, moves, current_player, time_ms=5000, mo
             input_data['x'] = move_x
             input_data['y'] = move_y
         
-        input_json = json.dumps(input_data)
-        logger.debug(f"[C++ INPUT] {input_json[:500]}")
+        if multi_pv is not None:
+            input_data['multi_pv'] = multi_pv
         
-        process = subprocess.Popen(
-            [WEB_CLI_PATH],
-            stdin=subprocess.PIPE,
-            stdout=subprocess.PIPE,
-            stderr=subprocess.PIPE,
-            text=True
-        )
+        base_ply, base_hash = engine_sync.get(game_id, (0, None))
+        if base_ply > len(moves):
+            base_ply, base_hash = 0, None
         
-        stdout, stderr = process.communicate(input=input_json, timeout=30)
+        input_data['game_id'] = game_id
+        input_data['base_ply'] = base_ply
+        input_data['moves'] = moves[base_ply:]
+        if base_hash is not None:
+            input_data['base_hash'] = base_hash
         
-        logger.debug(f"[C++ STDOUT] {stdout[:500] if stdout else '(empty)'}")
-        if stderr:
-            logger.warning(f"[C++ STDERR] {stderr[:500]}")
+        result = get_engine_pool().request(game_id, input_data, ENGINE_DEADLINE_S, on_info)
         
-        if process.returncode != 0:
-            error_msg = stderr.strip() if stderr else "Unknown error"
-            try:
-                error_json = json.loads(stdout)
-                if 'error' in error_json:
-                    error_msg = error_json['error']
-            except:
-                if stdout.strip():
-                    error_msg += f" | stdout: {stdout.strip()[:200]}"
-            logger.error(f"[C++ ERROR] returncode={process.returncode}, error={error_msg}")
+        if not result.get('success') and result.get('resync'):
+            logger.info(f"[C++ RESYNC] game_id={game_id}, base_ply={base_ply}, engine_ply={result.get('ply')}")
+            input_data['base_ply'] = 0
+            input_data['moves'] = moves
+            input_data.pop('base_hash', None)
+            result = get_engine_pool().request(game_id, input_data, ENGINE_DEADLINE_S, on_info)
+        
+        if result.get('success') and 'ply' in result:
+            engine_sync[game_id] = (result['ply'], result['hash'])
+        else:
+            engine_sync.pop(game_id, None)
+        
+        if not result.get('success'):
+            error_msg = result.get('error', 'Unknown error')
+            logger.error(f"[C++ ERROR] error={error_msg}")
             return {'success': False, 'error': f'Engine failed: {error_msg}'}
         
-        try:
-            result = json.loads(stdout)
-            logger.info(f"[C++ SUCCESS] command={command}, result_keys={list(result.keys())}")
-            if 'stats' in result:
-                stats = result['stats']
-                logger.debug(f"[C++ STATS] time_ms={stats.get('time_ms')}, "
-                           f"decision_type={stats.get('decision_type')}, "
-                           f"depth={stats.get('depth_reached')}")
-            return result
-        except json.JSONDecodeError as e:
-            logger.error(f"[C++ PARSE ERROR] {str(e)}, stdout={stdout[:200]}")
-            return {'success': False, 'error': f'Failed to parse engine output: {str(e)}. Output: {stdout[:200]}'}
+        logger.info(f"[C++ SUCCESS] command={command}, result_keys={list(result.keys())}")
+        if 'stats' in result:
+            stats = result['stats']
+            logger.debug(f"[C++ STATS] time_ms={stats.get('time_ms')}, "
+                       f"decision_type={stats.get('decision_type')}, "
+                       f"depth={stats.get('depth_reached')}")
+        return result
         
-    except subprocess.TimeoutExpired:
-        logger.error(f"[C++ TIMEOUT] command={command}")
-        return {'success': False, 'error': 'Engine timeout (30 seconds)'}
+    except EngineBusy as e:
+        logger.error(f"[C++ BUSY] command={command}, error={str(e)}")
+        return {'success': False, 'error': f'Engine busy: {str(e)}', 'busy': True}
+    except EngineUnavailable as e:
+        logger.error(f"[C++ UNAVAILABLE] command={command}, error={str(e)}")
+        return {'success': False, 'error': f'Engine failed: {str(e)}'}
     except FileNotFoundError:
         logger.error(f"[C++ NOT FOUND] path={WEB_CLI_PATH}")
         return {'success': False, 'error': f'Engine not found at {WEB_CLI_PATH}. Please build the C++ project first.'}
@@ -111,6 +140,10 @@ def call_cpp_engine(command, win_length, moves, current_player, time_ms=5000, mo
         return {'success': False, 'error': f'Unexpected error: {str(e)}'}
 
 
+def engine_error_status(result):
+    return 503 if result.get('busy') else 500
+
+
 @app.route('/')
 def index():
     logger.debug("[API] GET /")
@@ -160,6 +193,7 @@ def new_game():
     if first_player == 'ai':
         logger.info(f"[GAME] AI makes first move for game_id={game_id}")
         ai_result = call_cpp_engine(
+            game_id,
             'ai_move',
             win_length,
             [],
@@ -194,11 +228,11 @@ def new_game():
         else:
             logger.error(f"[GAME] AI first move failed: {ai_result.get('error')}")
     
-    state_result = call_cpp_engine('get_state', win_length, [], 'X')
+    state_result = call_cpp_engine(game_id, 'get_state', win_length, [], 'X')
     
     if not state_result.get('success'):
         logger.error(f"[API] new_game: Failed to get initial state: {state_result.get('error')}")
-        return jsonify(state_result), 500
+        return jsonify(state_result), engine_error_status(state_result)
     
     logger.info(f"[API] new_game: Successfully created game_id={game_id}")
     
@@ -249,6 +283,7 @@ def make_move():
         return jsonify({'error': 'Not your turn'}), 400
     
     result = call_cpp_engine(
+        game_id,
         'make_move',
         game['win_length'],
         game['moves'],
@@ -260,7 +295,7 @@ def make_move():
     
     if not result.get('success'):
         logger.error(f"[API] make_move failed: {result.get('error')}")
-        return jsonify(result), 500
+        return jsonify(result), engine_error_status(result)
     
     game['moves'].append({
         'x': x,
@@ -316,6 +351,7 @@ def ai_move():
         return jsonify({'error': 'Not AI turn'}), 400
     
     result = call_cpp_engine(
+        game_id,
         'ai_move',
         game['win_length'],
         game['moves'],
@@ -325,7 +361,7 @@ def ai_move():
     
     if not result.get('success'):
         logger.error(f"[API] ai_move failed: {result.get('error')}")
-        return jsonify(result), 500
+        return jsonify(result), engine_error_status(result)
     
     ai_move_x = result['move']['x']
     ai_move_y = result['move']['y']
@@ -363,6 +399,7 @@ def game_state(game_id):
     game = games[game_id]
     
     result = call_cpp_engine(
+        game_id,
         'get_state',
         game['win_length'],
         game['moves'],
@@ -371,7 +408,7 @@ def game_state(game_id):
     
     if not result.get('success'):
         logger.error(f"[API] game_state failed: {result.get('error')}")
-        return jsonify(result), 500
+        return jsonify(result), engine_error_status(result)
     
     logger.debug(f"[API] game_state: returning state for game_id={game_id}")
     
@@ -402,11 +439,11 @@ def reset_game(game_id):
     game['game_over'] = False
     game['winner'] = None
     
-    state_result = call_cpp_engine('get_state', game['win_length'], [], 'X')
+    state_result = call_cpp_engine(game_id, 'get_state', game['win_length'], [], 'X')
     
     if not state_result.get('success'):
         logger.error(f"[API] reset_game failed: {state_result.get('error')}")
-        return jsonify(state_result), 500
+        return jsonify(state_result), engine_error_status(state_result)
     
     logger.info(f"[GAME] Game reset complete, game_id={game_id}")
     
@@ -419,6 +456,49 @@ def reset_game(game_id):
     })
 
 
+@app.route('/api/analyze/<game_id>', methods=['POST'])
+def analyze(game_id):
+    """Streams newline-delimited JSON: one {"info": ...} per completed depth,
+    then {"result": ...} with the final lines."""
+    logger.info(f"[API] POST /api/analyze/{game_id}")
+    
+    if game_id not in games:
+        logger.warning(f"[API] analyze: Game not found, game_id={game_id}")
+        return jsonify({'error': 'Game not found'}), 404
+    
+    game = games[game_id]
+    if game['game_over']:
+        return jsonify({'error': 'Game is over'}), 400
+    
+    data = request.get_json(silent=True) or {}
+    multi_pv = max(1, min(int(data.get('multi_pv', 3)), 10))
+    time_ms = int(data.get('time_ms', 3000))
+    
+    events = queue.Queue()
+    
+    def run():
+        result = call_cpp_engine(game_id, 'analyze', game['win_length'], list(game['moves']),
+                                 game['current_player'], time_ms, multi_pv=multi_pv,
+                                 on_info=lambda info: events.put({'info': info}))
+        events.put({'result': result})
+    
+    threading.Thread(target=run, daemon=True).start()
+    
+    def stream():
+        while True:
+            event = events.get()
+            yield json.dumps(event) + '\n'
+            if 'result' in event:
+                return
+    
+    return Response(stream(), mimetype='application/x-ndjson')
+
+
+@app.route('/api/engine_status', methods=['GET'])
+def engine_status():
+    return jsonify({'workers': get_engine_pool().stats()})
+
+
 if __name__ == '__main__':
     print("=" * 50)
     print("Infinite Tic-Tac-Toe Web Interface")
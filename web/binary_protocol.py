@@ -0,0 +1,191 @@
+import struct
+
+PROTOCOL_VERSION = 1
+
+COMMANDS = {'make_move': 1, 'ai_move': 2, 'get_state': 3}
+PLAYERS = {None: 0, 'X': 1, 'O': 2}
+PLAYER_NAMES = {0: None, 1: 'X', 2: 'O'}
+DECISION_TYPES = ['IMMEDIATE_WIN', 'IMMEDIATE_BLOCK', 'DANGEROUS_THREAT',
+                  'THREAT_SOLVER', 'NEGAMAX_SEARCH', 'OPENING_BOOK']
+
+HAS_MOVE = 1
+HAS_STATS = 2
+GAME_OVER = 4
+IS_TERMINAL = 8
+HAS_POSITION = 16
+
+STATUS_OK = 0
+STATUS_ERROR = 1
+STATUS_RESYNC = 2
+
+
+def _zigzag(value):
+    return (value << 1) ^ (value >> 63)
+
+
+def _unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def _write_varint(out, value):
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+
+
+class _Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise ValueError('Truncated binary payload')
+        value = self.data[self.pos]
+        self.pos += 1
+        return value
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            byte = self.byte()
+            value |= (byte & 0x7F) << shift
+            if not byte & 0x80:
+                return value
+            shift += 7
+
+    def signed(self):
+        return _unzigzag(self.varint())
+
+    def fixed64(self):
+        value = int.from_bytes(self.data[self.pos:self.pos + 8], 'little')
+        self.pos += 8
+        return value
+
+    def text(self):
+        length = self.varint()
+        value = self.data[self.pos:self.pos + length]
+        self.pos += length
+        return value.decode('utf-8', errors='replace')
+
+
+def encode_request(command, win_length, moves, current_player, time_ms=0,
+                   move_x=None, move_y=None, request_id='', game_id=None,
+                   base_ply=0, base_hash=0):
+    out = bytearray([PROTOCOL_VERSION, COMMANDS[command]])
+    _write_varint(out, max(0, win_length))
+    out.append(PLAYERS.get(current_player, 0))
+    _write_varint(out, max(0, time_ms))
+
+    _write_varint(out, len(moves))
+    prev_x = prev_y = 0
+    for move in moves:
+        player = PLAYERS.get(move.get('player', 'X'), 0)
+        _write_varint(out, (_zigzag(move['x'] - prev_x) << 2) | player)
+        _write_varint(out, _zigzag(move['y'] - prev_y))
+        prev_x, prev_y = move['x'], move['y']
+
+    if move_x is not None and move_y is not None:
+        out.append(1)
+        _write_varint(out, _zigzag(move_x))
+        _write_varint(out, _zigzag(move_y))
+    else:
+        out.append(0)
+
+    encoded_id = request_id.encode('utf-8')
+    _write_varint(out, len(encoded_id))
+    out += encoded_id
+
+    if game_id:
+        encoded_game = game_id.encode('utf-8')
+        _write_varint(out, len(encoded_game))
+        out += encoded_game
+        _write_varint(out, base_ply)
+        if isinstance(base_hash, str):
+            base_hash = int(base_hash, 16)
+        out += base_hash.to_bytes(8, 'little')
+    return bytes(out)
+
+
+def decode_response(payload):
+    """Decodes a binary response into the same dict shape as the JSON output."""
+    reader = _Reader(payload)
+    version = reader.byte()
+    if version != PROTOCOL_VERSION:
+        raise ValueError(f'Unsupported protocol version: {version}')
+    status = reader.byte()
+    if status != STATUS_OK:
+        result = {'success': False, 'error': reader.text()}
+        if status == STATUS_RESYNC:
+            result['resync'] = True
+            result['ply'] = reader.varint()
+        return result
+
+    flags = reader.byte()
+    winner = PLAYER_NAMES.get(reader.byte())
+    result = {'success': True}
+
+    if flags & HAS_MOVE:
+        x = reader.signed()
+        y = reader.signed()
+        result['move'] = {'x': x, 'y': y, 'player': PLAYER_NAMES.get(reader.byte())}
+
+    if flags & HAS_STATS:
+        stats = {
+            'time_ms': reader.varint(),
+            'decision_type': DECISION_TYPES[reader.byte()],
+            'depth_reached': reader.varint(),
+            'nodes_searched': reader.varint(),
+            'final_score': reader.signed(),
+        }
+        pv = []
+        x = y = 0
+        for _ in range(reader.varint()):
+            x += reader.signed()
+            y += reader.signed()
+            pv.append({'x': x, 'y': y})
+        stats['principal_variation'] = pv
+        result['stats'] = stats
+
+    bbox = {
+        'min_x': reader.signed(),
+        'max_x': reader.signed(),
+        'min_y': reader.signed(),
+        'max_y': reader.signed(),
+    }
+
+    cells = []
+    x = y = 0
+    for _ in range(reader.varint()):
+        packed = reader.varint()
+        x += _unzigzag(packed >> 2)
+        y += reader.signed()
+        cells.append({'x': x, 'y': y, 'player': PLAYER_NAMES.get(packed & 3)})
+
+    result['board'] = {'cells': cells, 'bbox': bbox}
+    result['game_over'] = bool(flags & GAME_OVER)
+    result['winner'] = winner if result['game_over'] else None
+    result['is_terminal'] = bool(flags & IS_TERMINAL)
+    if flags & HAS_POSITION:
+        result['ply'] = reader.varint()
+        result['hash'] = f'{reader.fixed64():016x}'
+    return result
+
+
+def write_frame(stream, payload):
+    stream.write(struct.pack('<I', len(payload)))
+    stream.write(payload)
+    stream.flush()
+
+
+def read_frame(stream):
+    header = stream.read(4)
+    if len(header) < 4:
+        return None
+    (length,) = struct.unpack('<I', header)
+    payload = stream.read(length)
+    if len(payload) < length:
+        raise ValueError('Truncated frame payload')
+    return payload
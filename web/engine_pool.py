@@ -0,0 +1,262 @@
+import json
+import logging
+import subprocess
+import threading
+import time
+import zlib
+
+logger = logging.getLogger(__name__)
+
+
+class EngineBusy(Exception):
+    pass
+
+
+class EngineUnavailable(Exception):
+    pass
+
+
+class _Pending:
+    def __init__(self, request_id, on_info=None):
+        self.request_id = request_id
+        self.on_info = on_info
+        self.event = threading.Event()
+        self.result = None
+        self.error = None
+
+    def resolve(self, result):
+        self.result = result
+        self.event.set()
+
+    def fail(self, error):
+        self.error = error
+        self.event.set()
+
+
+class _Process:
+    def __init__(self, command):
+        self.popen = subprocess.Popen(
+            command,
+            stdin=subprocess.PIPE,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+            text=True,
+            bufsize=1
+        )
+        self.lock = threading.Lock()
+        self.pending = None
+        self.exited = False
+
+    def peek_pending(self):
+        with self.lock:
+            return self.pending
+
+    def take_pending(self):
+        with self.lock:
+            pending, self.pending = self.pending, None
+            return pending
+
+
+class EngineWorker:
+    """One long-lived `web_cli --serve` process with one search in flight.
+
+    Callers queue on a semaphore rather than in the engine's stdin, so the
+    search budget can be clamped to the caller's deadline at the moment the
+    request is actually written.
+    """
+
+    def __init__(self, index, command, max_queued, min_search_ms):
+        self.index = index
+        self.command = command
+        self.max_queued = max_queued
+        self.min_search_ms = min_search_ms
+        self.slot = threading.Lock()
+        self.queue_lock = threading.Lock()
+        self.queued = 0
+        self.next_id = 0
+        self.restarts = 0
+        self.process = None
+        self.start()
+
+    def start(self):
+        process = _Process(self.command)
+        self.process = process
+        threading.Thread(target=self._read_loop, args=(process,), daemon=True).start()
+        threading.Thread(target=self._drain_stderr, args=(process,), daemon=True).start()
+        logger.info(f"[POOL] worker {self.index} started, pid={process.popen.pid}")
+
+    def is_alive(self):
+        return self.process.popen.poll() is None
+
+    def restart(self, reason):
+        logger.warning(f"[POOL] restarting worker {self.index}: {reason}")
+        old = self.process
+        if old.popen.poll() is None:
+            old.popen.kill()
+        pending = old.take_pending()
+        if pending is not None:
+            pending.fail(EngineUnavailable(f'Engine worker restarted: {reason}'))
+        self.restarts += 1
+        self.start()
+
+    def submit(self, payload, deadline, overhead_ms, on_info=None):
+        with self.queue_lock:
+            if self.queued >= self.max_queued:
+                raise EngineBusy(f'Engine worker {self.index} queue is full')
+            self.queued += 1
+        try:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0 or not self.slot.acquire(timeout=remaining):
+                raise EngineBusy(f'Engine worker {self.index} is saturated')
+        finally:
+            with self.queue_lock:
+                self.queued -= 1
+
+        try:
+            if not self.is_alive():
+                self.restart(f'exited with code {self.process.popen.returncode}')
+
+            if payload.get('command') in ('ai_move', 'analyze'):
+                budget_ms = int((deadline - time.monotonic()) * 1000) - overhead_ms
+                if budget_ms < self.min_search_ms:
+                    raise EngineBusy('Not enough time left before the deadline to search')
+                payload = dict(payload, time_ms=min(payload.get('time_ms') or budget_ms, budget_ms))
+
+            self.next_id += 1
+            pending = _Pending(f'{self.index}-{self.next_id}', on_info)
+            process = self.process
+            with process.lock:
+                process.pending = pending
+            try:
+                process.popen.stdin.write(json.dumps(dict(payload, id=pending.request_id)) + '\n')
+                process.popen.stdin.flush()
+            except (BrokenPipeError, OSError) as e:
+                process.take_pending()
+                raise EngineUnavailable(f'Engine worker {self.index} pipe closed: {e}')
+
+            if not pending.event.wait(max(0.0, deadline - time.monotonic())):
+                self.restart(f'request {pending.request_id} missed its deadline')
+            if pending.error is not None:
+                raise pending.error
+            return pending.result
+        finally:
+            self.slot.release()
+
+    def _read_loop(self, process):
+        for line in process.popen.stdout:
+            line = line.strip()
+            if not line:
+                continue
+            try:
+                message = json.loads(line)
+            except json.JSONDecodeError as e:
+                message = None
+                error = e
+            # Analysis progress precedes the result of the same request.
+            if isinstance(message, dict) and 'info' in message:
+                pending = process.peek_pending()
+                if pending is not None and pending.on_info is not None:
+                    try:
+                        pending.on_info(message['info'])
+                    except Exception:
+                        logger.exception(f"[POOL] worker {self.index} info callback failed")
+                continue
+            pending = process.take_pending()
+            if pending is None:
+                logger.warning(f"[POOL] worker {self.index} sent unexpected output: {line[:200]}")
+                continue
+            if message is None:
+                pending.fail(EngineUnavailable(f'Failed to parse engine output: {error}'))
+                continue
+            if message.get('id') not in ('', pending.request_id):
+                logger.warning(f"[POOL] worker {self.index} id mismatch: "
+                               f"expected={pending.request_id}, got={message.get('id')}")
+            pending.resolve(message.get('result', {}))
+
+        process.exited = True
+        pending = process.take_pending()
+        if pending is not None:
+            pending.fail(EngineUnavailable(f'Engine worker {self.index} exited'))
+
+    def _drain_stderr(self, process):
+        for line in process.popen.stderr:
+            logger.warning(f"[C++ STDERR worker {self.index}] {line.rstrip()[:500]}")
+
+    def stop(self):
+        popen = self.process.popen
+        if popen.poll() is None:
+            popen.stdin.close()
+            try:
+                popen.wait(timeout=2)
+            except subprocess.TimeoutExpired:
+                popen.kill()
+
+
+class EnginePool:
+    """Routes every game to a fixed worker so its transposition table stays warm.
+
+    Back-pressure: at most `max_queued` callers wait on a worker; the next one
+    gets EngineBusy immediately, and a waiter whose deadline passes gets it too.
+    Deadlines: an ai_move's or analyze's time_ms is clamped to what is left of the caller's
+    deadline minus `overhead_ms`, so the search never outlives the request.
+    A worker that misses a deadline or dies is killed and restarted; a health
+    thread pings idle workers and revives crashed ones.
+    """
+
+    def __init__(self, command, size, max_queued=16, overhead_ms=250, min_search_ms=50,
+                 health_interval=5.0, ping_timeout=5.0):
+        self.overhead_ms = overhead_ms
+        self.ping_timeout = ping_timeout
+        self.workers = [EngineWorker(i, command, max_queued, min_search_ms) for i in range(size)]
+        self._stopped = threading.Event()
+        threading.Thread(target=self._health_loop, args=(health_interval,), daemon=True).start()
+
+    def worker_for(self, game_id):
+        key = (game_id or '').encode('utf-8')
+        return self.workers[zlib.crc32(key) % len(self.workers)]
+
+    def request(self, game_id, payload, deadline_s, on_info=None):
+        """on_info is called on the reader thread with every progress report."""
+        deadline = time.monotonic() + deadline_s
+        worker = self.worker_for(game_id)
+        try:
+            return worker.submit(payload, deadline, self.overhead_ms, on_info)
+        except EngineUnavailable:
+            if time.monotonic() >= deadline:
+                raise
+            logger.info(f"[POOL] retrying on worker {worker.index} after failure")
+            return worker.submit(payload, deadline, self.overhead_ms, on_info)
+
+    def _health_loop(self, interval):
+        while not self._stopped.wait(interval):
+            for worker in self.workers:
+                if not worker.slot.acquire(blocking=False):
+                    continue
+                try:
+                    if not worker.is_alive():
+                        worker.restart(f'exited with code {worker.process.popen.returncode}')
+                finally:
+                    worker.slot.release()
+                self._ping(worker)
+
+    def _ping(self, worker):
+        if worker.queued > 0:
+            return
+        try:
+            result = worker.submit({'command': 'ping'}, time.monotonic() + self.ping_timeout,
+                                   self.overhead_ms)
+            if not result.get('pong'):
+                logger.warning(f"[POOL] worker {worker.index} answered ping with {result}")
+        except EngineBusy:
+            pass
+        except EngineUnavailable as e:
+            logger.warning(f"[POOL] worker {worker.index} failed health check: {e}")
+
+    def stats(self):
+        return [{'worker': w.index, 'alive': w.is_alive(), 'restarts': w.restarts,
+                 'queued': w.queued} for w in self.workers]
+
+    def shutdown(self):
+        self._stopped.set()
+        for worker in self.workers:
+            worker.stop()